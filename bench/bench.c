@@ -0,0 +1,213 @@
+/**
+ * @file bench.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Times init_elf() and every dump on its own, warm and cold.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../src/all.h"
+#include <time.h>
+
+#define BENCH_RUNS 5
+#define BENCH_MAX_RUNS 64
+#define BENCH_MAX_THREADS 16 /* entries of the -T sweep */
+
+typedef struct phase {
+  const char *name;
+  void (*func)(batch_file_t *); /* NULL times init_elf_backend() itself */
+  bool threaded; /* swept over the -T thread counts */
+} phase_t;
+
+static const phase_t phases[] = {
+  {"init_elf", NULL, false},
+  {"dump_elf_header", dump_elf_header, false},
+  {"dump_program_headers", dump_program_headers, false},
+  {"dump_section_headers", dump_section_headers, false},
+  {"dump_symbol_table", dump_symbol_table, true},
+  {"dump_compressed_sections", dump_compressed_sections, false}
+};
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief Runs one phase once.
+ * 
+ * For cold runs the file's pages are dropped from the page cache first
+ * (POSIX_FADV_DONTNEED, no root needed). Only the phase itself is timed,
+ * the output goes to /dev/null.
+ * 
+ * @return uint64_t Nanoseconds.
+ */
+
+static uint64_t bench_once(const char *path, const phase_t *phase, elf_backend_t backend,
+                           out_format_t format, unsigned int threads, bool cold, int null, uint64_t *bytes) {
+  int fd = open(path, O_RDONLY);
+  out_t out;
+
+  if (fd == -1 || !out_init(&out, null)) {
+    fprintf(stderr, "%s: Failed to open the file.\n", path);
+    exit(EXIT_FAILURE);
+  }
+
+  if (cold)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+
+  uint64_t start = now_ns();
+  elf_t *elf = init_elf_backend(fd, backend);
+
+  if (phase->func) {
+    batch_file_t file = {.elf = elf, .out = &out, .format = format, .path = path, .render_threads = threads,
+                         .err = stderr};
+
+    start = now_ns();
+    phase->func(&file);
+    out_flush(&out);
+  }
+
+  uint64_t elapsed = now_ns() - start;
+
+  *bytes = out.bytes;
+  destroy_parser(fd, elf);
+  out_destroy(&out);
+  return elapsed;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-r runs] [-m mmap|pread] [-f text|json|ndjson] [-T 1,2,4,...] [-p phase] <file> ...\n",
+          name);
+  exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Parses the comma separated thread counts of -T.
+ * 
+ * @return unsigned int How many there are, 0 if the list is bad.
+ */
+
+static unsigned int parse_threads(const char *list, unsigned int *threads) {
+  unsigned int count = 0;
+
+  for (const char *p = list; *p; ) {
+    char *end;
+    unsigned long n = strtoul(p, &end, 10);
+
+    if (end == p || !n || n > UINT32_MAX || count == BENCH_MAX_THREADS || (*end && *end != ','))
+      return 0;
+    threads[count++] = n;
+    p = *end ? end + 1 : end;
+  }
+  return count;
+}
+
+int main(int argc, char *argv[]) {
+  elf_backend_t backend = ELF_BACKEND_MMAP;
+  out_format_t format = OUT_TEXT;
+  unsigned int runs = BENCH_RUNS, threads[BENCH_MAX_THREADS] = {1}, nthreads = 1;
+  const char *only = NULL;
+  int null = open("/dev/null", O_WRONLY), i = 1;
+  out_t out;
+  json_t json;
+
+  for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+    if (!strcmp(argv[i], "-r"))
+      runs = strtoul(argv[i + 1], NULL, 10);
+    else if (!strcmp(argv[i], "-m"))
+      backend = strcmp(argv[i + 1], "pread") ? ELF_BACKEND_MMAP : ELF_BACKEND_PREAD;
+    else if (!strcmp(argv[i], "-f"))
+      format = !strcmp(argv[i + 1], "json") ? OUT_JSON : !strcmp(argv[i + 1], "ndjson") ? OUT_NDJSON : OUT_TEXT;
+    else if (!strcmp(argv[i], "-T"))
+      nthreads = parse_threads(argv[i + 1], threads);
+    else if (!strcmp(argv[i], "-p"))
+      only = argv[i + 1];
+    else
+      usage(argv[0]);
+  }
+
+  /* structured output is rendered on one thread, a -T curve of it would be flat */
+  if (i == argc || null == -1 || !runs || runs > BENCH_MAX_RUNS || !nthreads
+      || (format != OUT_TEXT && (nthreads > 1 || threads[0] > 1)))
+    usage(argv[0]);
+
+  out_init(&out, STDOUT_FILENO);
+  json_init(&json, &out);
+
+  for (; i < argc; ++i) {
+    struct stat st;
+
+    if (stat(argv[i], &st) == -1)
+      usage(argv[0]);
+
+    for (size_t p = 0; p < sizeof(phases) / sizeof(phases[0]); ++p) {
+      if (only && strcmp(only, phases[p].name))
+        continue;
+
+      /* only the symbol table is rendered by several threads, the rest runs once */
+      for (unsigned int t = 0; t < (phases[p].threaded ? nthreads : 1); ++t) {
+        unsigned int n = phases[p].threaded ? threads[t] : 1;
+
+        for (int cold = 0; cold < 2; ++cold) {
+          uint64_t ns[BENCH_MAX_RUNS], bytes = 0, total = 0;
+
+          /* a warm run needs the file in the page cache, and the code paged in */
+          if (!cold)
+            bench_once(argv[i], &phases[p], backend, format, n, false, null, &bytes);
+
+          for (unsigned int r = 0; r < runs; ++r) {
+            ns[r] = bench_once(argv[i], &phases[p], backend, format, n, cold, null, &bytes);
+            total += ns[r];
+          }
+          qsort(ns, runs, sizeof(uint64_t), cmp_u64);
+
+          json_open(&json, NULL, '{');
+          json_str(&json, "file", argv[i]);
+          json_uint(&json, "file_size", st.st_size);
+          json_str(&json, "phase", phases[p].name);
+          json_str(&json, "backend", backend == ELF_BACKEND_PREAD ? "pread" : "mmap");
+          json_str(&json, "format", format == OUT_JSON ? "json" : format == OUT_NDJSON ? "ndjson" : "text");
+          json_str(&json, "cache", cold ? "cold" : "warm");
+          json_uint(&json, "threads", n);
+          json_uint(&json, "runs", runs);
+          json_uint(&json, "min_ns", ns[0]);
+          json_uint(&json, "median_ns", ns[runs / 2]);
+          json_uint(&json, "mean_ns", total / runs);
+          json_uint(&json, "max_ns", ns[runs - 1]);
+          json_uint(&json, "output_bytes", bytes);
+          json_uint(&json, "time", (uint64_t)time(NULL));
+          json_close(&json, '}');
+          out_char(&out, '\n');
+          out_flush(&out);
+        }
+      }
+    }
+  }
+
+  out_destroy(&out);
+  close(null);
+  return EXIT_SUCCESS;
+}
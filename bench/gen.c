@@ -0,0 +1,282 @@
+/**
+ * @file gen.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Writes synthetic ELF64 files for the benchmarks.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <elf.h>
+#include <zlib.h>
+
+#define GEN_TEXT 4096
+#define GEN_ZSIZE (1 << 20) /* uncompressed size of each compressed section */
+
+typedef struct gen {
+  FILE *out;
+  uint64_t offset;
+  uint64_t sections;    /* plain PROGBITS sections */
+  uint64_t compressed;  /* SHF_COMPRESSED sections */
+  uint64_t symbols;
+  uint64_t name_len;    /* every symbol name is exactly this long */
+} gen_t;
+
+/**
+ * @brief Writes bytes, keeping track of the offset.
+ * 
+ */
+
+static void gen_write(gen_t *gen, const void *data, size_t len) {
+  if (fwrite(data, 1, len, gen->out) != len) {
+    perror("fwrite");
+    exit(EXIT_FAILURE);
+  }
+  gen->offset += len;
+}
+
+/**
+ * @brief Pads with zeroes up to the next multiple of `align`.
+ * 
+ */
+
+static void gen_align(gen_t *gen, uint64_t align) {
+  static const char zero[64] = {0};
+
+  while (gen->offset % align) {
+    uint64_t pad = align - gen->offset % align;
+
+    gen_write(gen, zero, pad < sizeof(zero) ? pad : sizeof(zero));
+  }
+}
+
+/**
+ * @brief Writes the name of symbol `index`, padded with '_' to name_len.
+ * 
+ */
+
+static void gen_name(gen_t *gen, uint64_t index, char *buf) {
+  int len = snprintf(buf, gen->name_len + 1, "sym_%lu", (unsigned long)index);
+
+  memset(buf + len, '_', gen->name_len - len);
+  buf[gen->name_len] = '\0';
+  gen_write(gen, buf, gen->name_len + 1);
+}
+
+/**
+ * @brief Appends a section name to .shstrtab.
+ * 
+ * @return uint32_t Its offset, for sh_name.
+ */
+
+static uint32_t gen_section_name(char *shstrtab, size_t *len, const char *fmt, ...) {
+  uint32_t offset = *len;
+  va_list ap;
+
+  va_start(ap, fmt);
+  *len += vsnprintf(shstrtab + offset, 32, fmt, ap) + 1;
+  va_end(ap);
+  return offset;
+}
+
+/**
+ * @brief Compressible filler for the compressed sections, roughly as redundant as DWARF.
+ * 
+ */
+
+static unsigned char *gen_filler(size_t len) {
+  unsigned char *buf = malloc(len);
+
+  for (size_t i = 0; buf && i < len; ++i)
+    buf[i] = (i % 7 == 0) ? (unsigned char)(i * 2654435761u >> 24) : "debug_info"[i % 10];
+  return buf;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "Usage: %s <out> [-s sections] [-n symbols] [-t strtab bytes] [-z compressed sections]\n", name);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[]) {
+  gen_t gen = {.sections = 16, .symbols = 100000, .name_len = 0};
+  uint64_t strtab_size = 0;
+
+  if (argc < 2)
+    usage(argv[0]);
+
+  for (int i = 2; i + 1 < argc; i += 2) {
+    uint64_t value = strtoull(argv[i + 1], NULL, 10);
+
+    if (!strcmp(argv[i], "-s"))
+      gen.sections = value;
+    else if (!strcmp(argv[i], "-n"))
+      gen.symbols = value;
+    else if (!strcmp(argv[i], "-t"))
+      strtab_size = value;
+    else if (!strcmp(argv[i], "-z"))
+      gen.compressed = value;
+    else
+      usage(argv[0]);
+  }
+
+  /* names long enough for the biggest index, and for the requested string table */
+  gen.name_len = 24;
+  if (gen.symbols && strtab_size / gen.symbols > gen.name_len + 1)
+    gen.name_len = strtab_size / gen.symbols - 1;
+  if (gen.name_len > 4096)
+    gen.name_len = 4096;
+  if (1 + gen.symbols * (gen.name_len + 1) > UINT32_MAX) {
+    fprintf(stderr, "The string table would not fit st_name.\n");
+    return EXIT_FAILURE;
+  }
+
+  if (!(gen.out = fopen(argv[1], "wb")))
+    usage(argv[0]);
+  setvbuf(gen.out, NULL, _IOFBF, 1 << 20);
+
+  /* [null] [.text] [.sec.N]... [.zdebug.N]... [.strtab] [.symtab] [.shstrtab] */
+  uint64_t shnum = 1 + 1 + gen.sections + gen.compressed + 3;
+
+  if (shnum >= SHN_LORESERVE) {
+    fprintf(stderr, "Too many sections, at most %d.\n", SHN_LORESERVE - 6);
+    return EXIT_FAILURE;
+  }
+  Elf64_Shdr *shdrs = calloc(shnum, sizeof(Elf64_Shdr));
+  char *shstrtab = calloc(shnum, 32);
+  size_t shstrtab_len = 1;
+  char *name = malloc(gen.name_len + 1);
+  uLong zbound = compressBound(GEN_ZSIZE);
+  unsigned char *filler = gen_filler(GEN_ZSIZE), *zbuf = malloc(zbound), text[GEN_TEXT];
+
+  if (!shdrs || !shstrtab || !name || !filler || !zbuf) {
+    fprintf(stderr, "Out of memory.\n");
+    return EXIT_FAILURE;
+  }
+
+  Elf64_Ehdr ehdr = {
+    .e_ident = {ELFMAG0, ELFMAG1, ELFMAG2, ELFMAG3, ELFCLASS64, ELFDATA2LSB, EV_CURRENT},
+    .e_type = ET_DYN,
+    .e_machine = EM_X86_64,
+    .e_version = EV_CURRENT,
+    .e_entry = 0x1000,
+    .e_phoff = sizeof(Elf64_Ehdr),
+    .e_ehsize = sizeof(Elf64_Ehdr),
+    .e_phentsize = sizeof(Elf64_Phdr),
+    .e_phnum = 1,
+    .e_shentsize = sizeof(Elf64_Shdr),
+    .e_shnum = shnum,
+    .e_shstrndx = shnum - 1
+  };
+  Elf64_Phdr phdr = {
+    .p_type = PT_LOAD, .p_flags = PF_R | PF_X,
+    .p_offset = 0x1000, .p_vaddr = 0x1000, .p_paddr = 0x1000,
+    .p_filesz = GEN_TEXT, .p_memsz = GEN_TEXT, .p_align = 0x1000
+  };
+
+  gen_write(&gen, &ehdr, sizeof(ehdr));
+  gen_write(&gen, &phdr, sizeof(phdr));
+
+  uint64_t n = 1;
+
+  gen_align(&gen, 0x1000);
+  shdrs[n] = (Elf64_Shdr){.sh_name = gen_section_name(shstrtab, &shstrtab_len, ".text"),
+                          .sh_type = SHT_PROGBITS, .sh_flags = SHF_ALLOC | SHF_EXECINSTR,
+                          .sh_addr = 0x1000, .sh_offset = gen.offset, .sh_size = GEN_TEXT, .sh_addralign = 16};
+  memset(text, 0xc3, sizeof(text)); /* ret */
+  gen_write(&gen, text, sizeof(text));
+  n++;
+
+  for (uint64_t i = 0; i < gen.sections; ++i, ++n) {
+    shdrs[n] = (Elf64_Shdr){.sh_name = gen_section_name(shstrtab, &shstrtab_len, ".sec.%lu", (unsigned long)i),
+                            .sh_type = SHT_PROGBITS, .sh_offset = gen.offset, .sh_size = 64, .sh_addralign = 1};
+    gen_write(&gen, filler, 64);
+  }
+
+  /* every compressed section holds the same bytes, they only cost decompression time */
+  uLongf zlen = zbound;
+  Elf64_Chdr chdr = {.ch_type = ELFCOMPRESS_ZLIB, .ch_size = GEN_ZSIZE, .ch_addralign = 1};
+
+  if (gen.compressed && compress2(zbuf, &zlen, filler, GEN_ZSIZE, 6) != Z_OK) {
+    fprintf(stderr, "compress2 failed.\n");
+    return EXIT_FAILURE;
+  }
+
+  for (uint64_t i = 0; i < gen.compressed; ++i, ++n) {
+    gen_align(&gen, 8);
+    shdrs[n] = (Elf64_Shdr){.sh_name = gen_section_name(shstrtab, &shstrtab_len, ".debug_bench.%lu", (unsigned long)i),
+                            .sh_type = SHT_PROGBITS, .sh_flags = SHF_COMPRESSED, .sh_offset = gen.offset,
+                            .sh_size = sizeof(chdr) + zlen, .sh_addralign = 8};
+    gen_write(&gen, &chdr, sizeof(chdr));
+    gen_write(&gen, zbuf, zlen);
+  }
+
+  uint64_t strtab = n++, symtab = n++;
+
+  shdrs[strtab] = (Elf64_Shdr){.sh_name = gen_section_name(shstrtab, &shstrtab_len, ".strtab"),
+                               .sh_type = SHT_STRTAB, .sh_offset = gen.offset, .sh_addralign = 1};
+  gen_write(&gen, "", 1);
+  for (uint64_t i = 0; i < gen.symbols; ++i)
+    gen_name(&gen, i, name);
+  shdrs[strtab].sh_size = gen.offset - shdrs[strtab].sh_offset;
+
+  gen_align(&gen, 8);
+  shdrs[symtab] = (Elf64_Shdr){.sh_name = gen_section_name(shstrtab, &shstrtab_len, ".symtab"),
+                               .sh_type = SHT_SYMTAB, .sh_offset = gen.offset,
+                               .sh_size = (gen.symbols + 1) * sizeof(Elf64_Sym), .sh_link = strtab,
+                               .sh_info = 1, .sh_addralign = 8, .sh_entsize = sizeof(Elf64_Sym)};
+
+  Elf64_Sym sym = {0};
+
+  gen_write(&gen, &sym, sizeof(sym));
+  for (uint64_t i = 0; i < gen.symbols; ++i) {
+    sym = (Elf64_Sym){
+      .st_name = 1 + i * (gen.name_len + 1),
+      .st_info = ELF64_ST_INFO(STB_GLOBAL, (i % 4) ? STT_FUNC : STT_OBJECT),
+      .st_shndx = 1,
+      .st_value = 0x1000 + i * 16,
+      .st_size = 16
+    };
+    gen_write(&gen, &sym, sizeof(sym));
+  }
+
+  n = shnum - 1;
+  shdrs[n] = (Elf64_Shdr){.sh_name = gen_section_name(shstrtab, &shstrtab_len, ".shstrtab"),
+                          .sh_type = SHT_STRTAB, .sh_offset = gen.offset, .sh_size = shstrtab_len, .sh_addralign = 1};
+  gen_write(&gen, shstrtab, shstrtab_len);
+
+  gen_align(&gen, 8);
+  ehdr.e_shoff = gen.offset;
+  gen_write(&gen, shdrs, shnum * sizeof(Elf64_Shdr));
+
+  if (fseek(gen.out, 0, SEEK_SET) || fwrite(&ehdr, sizeof(ehdr), 1, gen.out) != 1 || fclose(gen.out)) {
+    perror(argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  free(shdrs);
+  free(shstrtab);
+  free(name);
+  free(filler);
+  free(zbuf);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,454 @@
+/**
+ * @file addr.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Address to symbol+offset resolution over a sorted interval index.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+#define HUGE_PAGE_SIZE (2UL << 20)
+#define ADDR_KEYS 8 /* one cache line of starts */
+#define ADDR_FANOUT (ADDR_KEYS + 1)
+#define ADDR_LANES 16
+#define ADDR_CACHED_BYTES (256 << 10) /* below this, lanes only add overhead */
+
+/**
+ * @brief qsort() comparator, by start then biggest range first.
+ * 
+ */
+
+static int range_cmp(const void *a, const void *b) {
+  const addr_range_t *ra = a, *rb = b;
+
+  if (ra->start != rb->start)
+    return (ra->start < rb->start) ? -1 : 1;
+  if (ra->end != rb->end)
+    return (ra->end > rb->end) ? -1 : 1;
+  return 0;
+}
+
+/**
+ * @brief Allocates one of the index arrays, cache line aligned.
+ * 
+ * Big arrays are aligned to 2 MiB and flagged for transparent huge pages, the
+ * descent touches a new page at almost every level and TLB misses would
+ * otherwise dominate.
+ */
+
+static void *index_alloc(size_t size) {
+  size_t align = (size >= HUGE_PAGE_SIZE) ? HUGE_PAGE_SIZE : 64;
+  void *ptr = NULL;
+
+  if (posix_memalign(&ptr, align, (size + align - 1) & ~(align - 1)))
+    return NULL;
+  if (align == HUGE_PAGE_SIZE)
+    madvise(ptr, size, MADV_HUGEPAGE);
+  return ptr;
+}
+
+/**
+ * @brief Lays the sorted ranges out as a static B-tree, in-order walk.
+ * 
+ * Node k holds ADDR_FANOUT - 1 starts in one cache line and its children are
+ * nodes k * ADDR_FANOUT + 1 ... k * ADDR_FANOUT + ADDR_FANOUT, the same
+ * implicit numbering as an Eytzinger array, only with wider nodes. Unused
+ * slots in the last nodes hold UINT64_MAX so they never compare <= addr.
+ * 
+ * @param map A pointer to the map.
+ * @param sorted The ranges, sorted by start.
+ * @param count The number of sorted ranges.
+ * @param i The next sorted index to place.
+ * @param k The current node.
+ * @return size_t The next sorted index to place.
+ */
+
+static size_t btree_fill(addrmap_t *map, const addr_range_t *sorted, size_t count, size_t i, size_t k) {
+  if (k >= map->nodes)
+    return i;
+
+  for (size_t j = 0; j < ADDR_KEYS; ++j) {
+    i = btree_fill(map, sorted, count, i, k * ADDR_FANOUT + j + 1);
+
+    size_t slot = k * ADDR_KEYS + j;
+
+    if (i < count) {
+      map->ranges[slot] = sorted[i++];
+      map->starts[slot] = map->ranges[slot].start;
+    } else {
+      map->ranges[slot] = (addr_range_t){UINT64_MAX, 0, NULL};
+      map->starts[slot] = UINT64_MAX;
+    }
+  }
+  return btree_fill(map, sorted, count, i, k * ADDR_FANOUT + ADDR_FANOUT);
+}
+
+/**
+ * @brief Builds the interval index from every sized FUNC/OBJECT symbol.
+ * 
+ * Symbols from .symtab and .dynsym are merged; when several symbols start at
+ * the same address only the one covering the most bytes is kept.
+ * 
+ * @param elf A pointer to the struct.
+ * @param map The map to fill in.
+ * @return bool false if we ran out of memory.
+ */
+
+bool addrmap_build(elf_t *elf, addrmap_t *map) {
+  size_t total = 0, count = 0;
+
+  memset(map, 0, sizeof(addrmap_t));
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    if ((shdr->sh_type == SHT_SYMTAB || shdr->sh_type == SHT_DYNSYM) && shdr->sh_entsize)
+      total += shdr->sh_size / shdr->sh_entsize;
+  }
+
+  addr_range_t *sorted = malloc((total ? total : 1) * sizeof(addr_range_t));
+
+  if (!sorted)
+    return false;
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    if ((shdr->sh_type != SHT_SYMTAB && shdr->sh_type != SHT_DYNSYM) || !shdr->sh_entsize)
+      continue;
+
+    const Elf64_Sym *syms = (const Elf64_Sym *)elf_section_table(elf, i);
+    const char *strtab = elf_section_data(elf, shdr->sh_link);
+
+    if (!syms || !strtab)
+      continue;
+
+    size_t sym_num = shdr->sh_size / shdr->sh_entsize;
+    uint64_t strsize = elf->elf_section_header[shdr->sh_link].sh_size;
+
+    for (size_t j = 0; j < sym_num; ++j) {
+      unsigned char type = ELF64_ST_TYPE(syms[j].st_info);
+
+      if ((type != STT_FUNC && type != STT_OBJECT) || !syms[j].st_size
+          || syms[j].st_shndx == SHN_UNDEF)
+        continue;
+
+      sorted[count++] = (addr_range_t){
+        .start = syms[j].st_value,
+        .end = syms[j].st_value + syms[j].st_size,
+        .name = elf_string(strtab, strsize, syms[j].st_name)
+      };
+    }
+  }
+
+  qsort(sorted, count, sizeof(addr_range_t), range_cmp);
+
+  /* drop aliases, the first one at each start is the widest */
+  for (size_t i = 0; i < count; ++i)
+    if (!map->count || sorted[i].start != sorted[map->count - 1].start)
+      sorted[map->count++] = sorted[i];
+
+  map->nodes = (map->count + ADDR_KEYS - 1) / ADDR_KEYS;
+  map->ranges = index_alloc((map->nodes + 1) * ADDR_KEYS * sizeof(addr_range_t));
+  map->starts = index_alloc((map->nodes + 1) * ADDR_KEYS * sizeof(uint64_t));
+
+  if (map->ranges && map->starts)
+    btree_fill(map, sorted, map->count, 0, 0);
+  free(sorted);
+
+  if (!map->ranges || !map->starts) {
+    addrmap_destroy(map);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Finds the range that contains `addr`.
+ * 
+ * Each level costs one cache line: the starts <= addr in the node are
+ * counted without branching, which is also the child to descend into. The
+ * deepest slot left of that child holds the greatest start <= addr.
+ * 
+ * @param map A pointer to the map.
+ * @param addr The address.
+ * @return long The slot in map->ranges, -1 if no symbol covers it.
+ */
+
+long addrmap_find(const addrmap_t *map, uint64_t addr) {
+  size_t k = 0, last = SIZE_MAX;
+
+  while (k < map->nodes) {
+    const uint64_t *node = map->starts + k * ADDR_KEYS;
+    size_t i = 0;
+
+    for (size_t j = 0; j < ADDR_KEYS; ++j)
+      i += node[j] <= addr;
+
+    last = i ? k * ADDR_KEYS + i - 1 : last;
+    k = k * ADDR_FANOUT + i + 1;
+  }
+
+  if (last == SIZE_MAX || addr >= map->ranges[last].end)
+    return -1;
+  return (long)last;
+}
+
+/**
+ * @brief Resolves a batch of addresses, ADDR_LANES descents at a time.
+ * 
+ * A single descent waits on one cache miss per level. Walking several
+ * independent descents in lockstep keeps that many misses in flight, which
+ * is what keeps big tables (millions of symbols) fast.
+ * 
+ * @param map A pointer to the map.
+ * @param addrs The addresses.
+ * @param total How many there are.
+ * @param slots Where the answers go, same as addrmap_find().
+ */
+
+void addrmap_find_batch(const addrmap_t *map, const uint64_t *addrs, size_t total, long *slots) {
+  size_t full = 0, i = 0, count = total;
+
+  if (map->nodes * ADDR_KEYS * sizeof(uint64_t) <= ADDR_CACHED_BYTES)
+    count = 0; /* the whole tree is in cache, the plain loop below wins */
+
+  /* levels that every lane is guaranteed to have a node on */
+  for (size_t last_node = 0; last_node < map->nodes; last_node = last_node * ADDR_FANOUT + ADDR_FANOUT)
+    ++full;
+
+  for (; i + ADDR_LANES <= count; i += ADDR_LANES) {
+    size_t k[ADDR_LANES] = {0}, last[ADDR_LANES];
+
+    for (size_t l = 0; l < ADDR_LANES; ++l)
+      last[l] = SIZE_MAX;
+
+    for (size_t d = 0; d < full; ++d) {
+      for (size_t l = 0; l < ADDR_LANES; ++l) {
+        const uint64_t *node = map->starts + k[l] * ADDR_KEYS;
+        size_t n = 0;
+
+        for (size_t j = 0; j < ADDR_KEYS; ++j)
+          n += node[j] <= addrs[i + l];
+
+        last[l] = n ? k[l] * ADDR_KEYS + n - 1 : last[l];
+        k[l] = k[l] * ADDR_FANOUT + n + 1;
+        __builtin_prefetch(map->starts + k[l] * ADDR_KEYS);
+      }
+    }
+
+    for (size_t l = 0; l < ADDR_LANES; ++l) {
+      /* at most one partial level is left */
+      if (k[l] < map->nodes) {
+        const uint64_t *node = map->starts + k[l] * ADDR_KEYS;
+        size_t n = 0;
+
+        for (size_t j = 0; j < ADDR_KEYS; ++j)
+          n += node[j] <= addrs[i + l];
+        last[l] = n ? k[l] * ADDR_KEYS + n - 1 : last[l];
+      }
+      __builtin_prefetch(&map->ranges[last[l] == SIZE_MAX ? 0 : last[l]]);
+    }
+
+    for (size_t l = 0; l < ADDR_LANES; ++l)
+      slots[i + l] = (last[l] == SIZE_MAX || addrs[i + l] >= map->ranges[last[l]].end) ? -1 : (long)last[l];
+  }
+
+  for (; i < total; ++i)
+    slots[i] = addrmap_find(map, addrs[i]);
+}
+
+/**
+ * @brief Frees the map.
+ * 
+ */
+
+void addrmap_destroy(addrmap_t *map) {
+  free(map->ranges);
+  free(map->starts);
+  memset(map, 0, sizeof(addrmap_t));
+}
+
+/**
+ * @brief Parses a hex number, with or without 0x.
+ * 
+ * @param p Start of the token.
+ * @param end End of the token.
+ * @param value Where the number goes.
+ * @return bool false if the token isn't a hex number.
+ */
+
+static inline __attribute__((always_inline)) bool parse_hex(const char *p, const char *end, uint64_t *value) {
+  if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    p += 2;
+
+  if (p == end || end - p > 16)
+    return false;
+
+  for (*value = 0; p < end; ++p) {
+    unsigned int c = (unsigned char)*p, d;
+
+    if (c - '0' < 10)
+      d = c - '0';
+    else if ((c | 0x20) - 'a' < 6)
+      d = (c | 0x20) - 'a' + 10;
+    else
+      return false;
+    *value = (*value << 4) | d;
+  }
+  return true;
+}
+
+/**
+ * @brief Reads the whole address list named by path (a file, or - for stdin).
+ * 
+ * @param path The option's argument.
+ * @param len Where the length goes.
+ * @return char* The input, NULL (after saying so) if it couldn't be read.
+ */
+
+char *addr_input(const char *path, size_t *len) {
+  int fd = strcmp(path, "-") ? open(path, O_RDONLY) : STDIN_FILENO;
+  char *input = (fd == -1) ? NULL : read_all(fd, len);
+
+  if (fd > STDIN_FILENO)
+    close(fd);
+
+  if (!input)
+    fprintf(stderr, "%s: Failed to read the addresses.\n", path);
+  return input;
+}
+
+/**
+ * @brief Parses up to `max` whitespace separated hex addresses.
+ * 
+ * Junk keeps its place: its token is stored in tokens[] (NULL for good
+ * addresses), so the answers stay in input order.
+ * 
+ * @param p Where to start, moved past what was parsed.
+ * @param end The end of the input.
+ * @return size_t How many tokens were parsed, 0 at the end.
+ */
+
+size_t addr_parse(const char **p, const char *end, uint64_t *addrs, const char **tokens, size_t max) {
+  const char *q = *p;
+  size_t n = 0;
+
+  for (; n < max; ++n) {
+    while (q < end && (*q == ' ' || *q == '\t' || *q == '\n' || *q == '\r'))
+      ++q;
+
+    const char *tok = q;
+
+    while (q < end && *q != ' ' && *q != '\t' && *q != '\n' && *q != '\r')
+      ++q;
+
+    if (tok == q)
+      break;
+
+    tokens[n] = NULL;
+    if (!parse_hex(tok, q, &addrs[n])) {
+      tokens[n] = tok;
+      addrs[n] = 0;
+    }
+  }
+  *p = q;
+  return n;
+}
+
+/**
+ * @brief Answers a token that isn't an address with `token ??`.
+ * 
+ */
+
+void addr_junk(out_t *out, const char *token, const char *end) {
+  const char *tok = token;
+
+  while (tok < end && *tok != ' ' && *tok != '\t' && *tok != '\n' && *tok != '\r')
+    ++tok;
+  out_write(out, token, tok - token);
+  out_str(out, " ??\n");
+}
+
+/**
+ * @brief Resolves every address read from file->arg (a file, or - for stdin).
+ * 
+ * Addresses are hex, separated by whitespace. Each one is answered on its
+ * own line as `0xaddr symbol+0xoffset`, or `0xaddr ??`. They are parsed and
+ * resolved ADDR_CHUNK at a time so the lookups can overlap their misses.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void resolve_addresses(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  size_t len = 0;
+  char *input = addr_input(file->arg, &len);
+  addrmap_t map;
+
+  if (!input)
+    return;
+
+  uint64_t *addrs = malloc(ADDR_CHUNK * sizeof(uint64_t));
+  long *slots = malloc(ADDR_CHUNK * sizeof(long));
+  const char **tokens = malloc(ADDR_CHUNK * sizeof(char *));
+
+  if (!addrs || !slots || !tokens || !addrmap_build(elf, &map)) {
+    free(input);
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the address index!");
+  }
+
+  for (const char *p = input, *end = input + len; p < end;) {
+    size_t n = addr_parse(&p, end, addrs, tokens, ADDR_CHUNK);
+
+    addrmap_find_batch(&map, addrs, n, slots);
+
+    for (size_t i = 0; i < n; ++i) {
+      /* names are scattered all over the string table, ask for them early */
+      if (i + ADDR_LANES < n && slots[i + ADDR_LANES] >= 0)
+        __builtin_prefetch(map.ranges[slots[i + ADDR_LANES]].name);
+
+      if (tokens[i]) {
+        addr_junk(file->out, tokens[i], end);
+        continue;
+      }
+
+      out_write(file->out, "0x", 2);
+      out_hex(file->out, addrs[i], 0, 0, 0);
+
+      if (slots[i] < 0) {
+        out_str(file->out, " ??\n");
+        continue;
+      }
+
+      const addr_range_t *range = &map.ranges[slots[i]];
+
+      out_char(file->out, ' ');
+      out_str(file->out, range->name);
+      out_write(file->out, "+0x", 3);
+      out_hex(file->out, addrs[i] - range->start, 0, 0, 0);
+      out_char(file->out, '\n');
+    }
+  }
+
+  addrmap_destroy(&map);
+  free(tokens);
+  free(slots);
+  free(addrs);
+  free(input);
+}
@@ -0,0 +1,31 @@
+#ifndef _ADDR_H
+#define _ADDR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ADDR_CHUNK 4096 /* addresses parsed and answered at a time */
+
+typedef struct addr_range {
+  uint64_t start;
+  uint64_t end;
+  const char *name;
+} addr_range_t;
+
+typedef struct addrmap {
+  addr_range_t *ranges;  /* static B-tree order, see btree_fill() */
+  uint64_t *starts;      /* ranges[k].start, packed for the descent */
+  size_t count;
+  size_t nodes;
+} addrmap_t;
+
+bool addrmap_build(elf_t *elf, addrmap_t *map);
+long addrmap_find(const addrmap_t *map, uint64_t addr);
+void addrmap_find_batch(const addrmap_t *map, const uint64_t *addrs, size_t count, long *slots);
+void addrmap_destroy(addrmap_t *map);
+char *addr_input(const char *path, size_t *len);
+size_t addr_parse(const char **p, const char *end, uint64_t *addrs, const char **tokens, size_t max);
+void addr_junk(out_t *out, const char *token, const char *end);
+void resolve_addresses(batch_file_t *file);
+
+#endif
@@ -1,8 +1,28 @@
 #ifndef _ALL_H
 #define _ALL_H
 
+#include "output.h"
+#include "stats.h"
 #include "elfie.h"
+#include "cache.h"
+#include "batch.h"
 #include "cases.h"
+#include "lookup.h"
+#include "addr.h"
+#include "zsec.h"
+#include "core.h"
+#include "deps.h"
+#include "bind.h"
+#include "reloc.h"
+#include "query.h"
+#include "diff.h"
+#include "hash.h"
+#include "bloat.h"
+#include "dwline.h"
+#include "pool.h"
+#include "scan.h"
+#include "archive.h"
 #include "main.h"
+#include "serve.h"
 
 #endif
\ No newline at end of file
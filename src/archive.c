@@ -0,0 +1,490 @@
+/**
+ * @file archive.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Static archives (ar): members as views of one mapping, dumped in parallel, looked up through the armap.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+/**
+ * @brief Tells if the file starts like an ar archive.
+ * 
+ */
+
+bool archive_check(int fd) {
+  char magic[SARMAG];
+
+  return (pread(fd, magic, SARMAG, 0) == SARMAG && !memcmp(magic, ARMAG, SARMAG));
+}
+
+/**
+ * @brief Parses a space padded decimal field of a member header.
+ * 
+ * @return bool false if there is anything but digits before the padding.
+ */
+
+static bool ar_number(const char *field, size_t len, uint64_t *value) {
+  size_t i = 0;
+
+  *value = 0;
+  for (; i < len && field[i] >= '0' && field[i] <= '9'; ++i)
+    *value = *value * 10 + (field[i] - '0');
+  for (size_t j = i; j < len; ++j) {
+    if (field[j] != ' ')
+      return false;
+  }
+  return (i > 0);
+}
+
+/**
+ * @brief Adds a member to the list.
+ * 
+ */
+
+static bool ar_push(archive_t *ar, size_t *cap, const ar_member_t *member) {
+  if (ar->count == *cap) {
+    size_t size = *cap ? *cap * 2 : 64;
+    ar_member_t *tmp = realloc(ar->members, size * sizeof(ar_member_t));
+
+    if (!tmp)
+      return false;
+    ar->members = tmp;
+    *cap = size;
+  }
+  ar->members[ar->count++] = *member;
+  return true;
+}
+
+/**
+ * @brief Walks the member headers of a mapped archive.
+ * 
+ * Names are left where they are: short names in the header (GNU ends them
+ * with '/'), long ones in the // table (`/<offset>`, ended by "/\n"), or
+ * right after the header for BSD archives (`#1/<length>`). The armap is
+ * remembered, the other special members are skipped.
+ * 
+ * @param ar The archive to fill in.
+ * @param file The mapping, it stays owned by the caller.
+ * @param size How long it is.
+ * @return bool false if a header is corrupt or we ran out of memory.
+ */
+
+bool archive_open(archive_t *ar, char *file, uint64_t size) {
+  const char *longnames = NULL;
+  uint64_t longnames_size = 0, off = SARMAG;
+  size_t cap = 0;
+
+  memset(ar, 0, sizeof(archive_t));
+  ar->file = file;
+  ar->size = size;
+
+  while (size - off >= sizeof(struct ar_hdr)) {
+    const struct ar_hdr *hdr = (const struct ar_hdr *)(file + off);
+    ar_member_t member = {.name = hdr->ar_name, .header = off, .offset = off + sizeof(struct ar_hdr)};
+
+    if (memcmp(hdr->ar_fmag, ARFMAG, sizeof(hdr->ar_fmag))
+        || !ar_number(hdr->ar_size, sizeof(hdr->ar_size), &member.size)
+        || member.size > size - member.offset)
+      return false;
+
+    /* the next header starts on an even offset */
+    off = member.offset + member.size + (member.size & 1);
+    if (off > size)
+      off = size;
+
+    if (!memcmp(hdr->ar_name, "/ ", 2) || !memcmp(hdr->ar_name, "/SYM64/ ", 8)) {
+      ar->armap = file + member.offset;
+      ar->armap_size = member.size;
+      ar->armap_word = (hdr->ar_name[1] == ' ') ? 4 : 8;
+      continue;
+    }
+    if (!memcmp(hdr->ar_name, "// ", 3)) {
+      longnames = file + member.offset;
+      longnames_size = member.size;
+      continue;
+    }
+
+    if (hdr->ar_name[0] == '/') {
+      uint64_t at;
+
+      if (!ar_number(hdr->ar_name + 1, sizeof(hdr->ar_name) - 1, &at) || at >= longnames_size)
+        return false;
+
+      const char *end = memchr(longnames + at, '\n', longnames_size - at);
+
+      member.name = longnames + at;
+      member.name_len = (end ? end : longnames + longnames_size) - member.name;
+      if (member.name_len && member.name[member.name_len - 1] == '/')
+        member.name_len--;
+    } else if (!memcmp(hdr->ar_name, "#1/", 3)) {
+      uint64_t len;
+
+      if (!ar_number(hdr->ar_name + 3, sizeof(hdr->ar_name) - 3, &len) || len > member.size)
+        return false;
+      member.name = file + member.offset;
+      member.name_len = strnlen(member.name, len);
+      member.offset += len;
+      member.size -= len;
+      if (member.name_len >= 9 && !memcmp(member.name, "__.SYMDEF", 9))
+        continue;
+    } else {
+      const char *slash = memchr(hdr->ar_name, '/', sizeof(hdr->ar_name));
+
+      member.name_len = slash ? (size_t)(slash - hdr->ar_name) : sizeof(hdr->ar_name);
+      while (!slash && member.name_len && hdr->ar_name[member.name_len - 1] == ' ')
+        member.name_len--;
+    }
+
+    if (!ar_push(ar, &cap, &member))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Frees the member list, the mapping stays.
+ * 
+ */
+
+void archive_close(archive_t *ar) {
+  free(ar->members);
+  ar->members = NULL;
+}
+
+/**
+ * @brief Reads a big-endian word of the armap.
+ * 
+ */
+
+static inline __attribute__((always_inline)) uint64_t ar_word(const archive_t *ar, const char *p) {
+  const unsigned char *b = (const unsigned char *)p;
+  uint64_t v = 0;
+
+  for (unsigned int i = 0; i < ar->armap_word; ++i)
+    v = (v << 8) | b[i];
+  return v;
+}
+
+/**
+ * @brief Returns the index of the member whose header is at `header`, -1 if none is.
+ * 
+ */
+
+static long ar_member_at(const archive_t *ar, uint64_t header) {
+  size_t lo = 0, hi = ar->count;
+
+  /* members are in file order */
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+
+    if (ar->members[mid].header < header)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return (lo < ar->count && ar->members[lo].header == header) ? (long)lo : -1;
+}
+
+/**
+ * @brief Finds the members that define some names, from the armap alone.
+ * 
+ * Every definition counts, not just the first one the linker would take:
+ * a name defined by two members (weak and strong, say) flags both.
+ * 
+ * @param names `count` NUL separated names.
+ * @param count How many there are.
+ * @param defines count * ar->count flags, defines[member * count + n] is
+ * set when the member defines name n.
+ */
+
+void archive_find(const archive_t *ar, const char *names, size_t count, bool *defines) {
+  if (!ar->armap || ar->armap_size < ar->armap_word)
+    return;
+
+  uint64_t entries = ar_word(ar, ar->armap);
+
+  if (entries > (ar->armap_size - ar->armap_word) / ar->armap_word)
+    return;
+
+  const char *offsets = ar->armap + ar->armap_word;
+  const char *p = offsets + entries * ar->armap_word, *end = ar->armap + ar->armap_size;
+
+  for (uint64_t i = 0; i < entries && p < end; ++i) {
+    const char *nul = memchr(p, '\0', end - p);
+    const char *name = names;
+    long member = -1;
+
+    if (!nul)
+      return;
+    for (size_t n = 0; n < count; ++n, name += strlen(name) + 1) {
+      if (!*name || strcmp(p, name))
+        continue;
+      if (member < 0 && (member = ar_member_at(ar, ar_word(ar, offsets + i * ar->armap_word))) < 0)
+        break;
+      defines[member * count + n] = true;
+    }
+    p = nul + 1;
+  }
+}
+
+/**
+ * @brief Runs the handler over one member, a view into the archive's mapping.
+ * 
+ * @return bool false if the member isn't an ELF file.
+ */
+
+static bool ar_member_run(const ar_run_t *run, size_t index, out_t *out) {
+  const ar_member_t *member = &run->ar->members[index];
+  size_t len = strlen(run->path) + member->name_len + 3;
+  char *path = malloc(len);
+  elf_t *elf;
+  elf_status_t status;
+
+  if (!path)
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the member name!");
+  snprintf(path, len, "%s(%.*s)", run->path, (int)member->name_len, member->name);
+
+  if (run->batch->format == OUT_TEXT) {
+    out_str(out, "Member: ");
+    out_str(out, path);
+    out_char(out, '\n');
+  }
+
+  if ((status = elf_open_view(run->ar->file + member->offset, member->size, NULL, &elf)) != ELF_OK) {
+    fprintf(stderr, "%s: %s\n", path, elf_strerror(status));
+    free(path);
+    return false;
+  }
+
+  batch_file_t file = {.elf = elf, .out = out, .format = run->batch->format, .path = path, .arg = run->batch->arg,
+                       .index_dir = run->batch->index_dir, .render_threads = run->batch->render_threads,
+                       .err = stderr};
+
+  run->batch->func(&file);
+  if (run->batch->format == OUT_TEXT)
+    out_char(out, '\n');
+
+  elf_close(elf);
+  free(path);
+  return true;
+}
+
+/**
+ * @brief Writes every finished member that is next in line, in order.
+ * 
+ * Must be called with the lock held.
+ */
+
+static void ar_emit(ar_run_t *run) {
+  while (run->next < run->ar->count && run->results[run->next].done) {
+    ar_result_t *res = &run->results[run->next++];
+
+    out_write(run->out, res->buf, res->len);
+    free(res->buf);
+    res->buf = NULL;
+    run->ok &= res->ok;
+  }
+}
+
+/**
+ * @brief Dumps one member into its own buffer, then hands it to the emitter.
+ * 
+ */
+
+static void ar_job(size_t index, void *ctx) {
+  ar_run_t *run = ctx;
+  ar_result_t *res = &run->results[index];
+  out_t out = {0};
+
+  if (out_init(&out, -1)) {
+    res->ok = ar_member_run(run, index, &out);
+    res->buf = out.buf;
+    res->len = out.len;
+  }
+
+  pthread_mutex_lock(&run->lock);
+  res->done = true;
+  ar_emit(run);
+  pthread_mutex_unlock(&run->lock);
+}
+
+/**
+ * @brief Answers -l for a whole archive from its armap.
+ * 
+ * Each name is looked up in the armap, and only the members that define
+ * one of them are opened, once each and in archive order, to print the
+ * symbols themselves. A name defined by several members is listed under
+ * each of them.
+ */
+
+static void ar_lookup(const ar_run_t *run) {
+  const archive_t *ar = run->ar;
+  out_t *out = run->out;
+  char *names = strdup(run->batch->arg);
+  size_t count = 1;
+
+  if (!names)
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the names!");
+  for (char *p = names; *p; ++p) {
+    if (*p == ',') {
+      *p = '\0';
+      ++count;
+    }
+  }
+
+  bool *defines = calloc(ar->count * count + 1, sizeof(bool));
+  bool *found = calloc(count, sizeof(bool));
+
+  if (!defines || !found)
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the names!");
+
+  archive_find(ar, names, count, defines);
+
+  const char *name;
+  bool missing = false;
+
+  out_str(out, "Symbol lookup in ");
+  out_str(out, run->path);
+  out_str(out, " via the archive index:\n");
+
+  for (size_t member = 0; member < ar->count; ++member) {
+    const bool *flags = &defines[member * count];
+    bool any = false;
+    elf_t *elf = NULL;
+    symtab_t tab;
+    int shndx;
+
+    for (size_t n = 0; n < count; ++n) {
+      any |= flags[n];
+      found[n] |= flags[n];
+    }
+    if (!any)
+      continue;
+
+    out_str(out, "Member: ");
+    out_write(out, ar->members[member].name, ar->members[member].name_len);
+    out_str(out, "\nNum:  Value  Size  Type         Bind           Vis          Ndx        Name\n");
+
+    if (elf_open_view(ar->file + ar->members[member].offset, ar->members[member].size, NULL, &elf) != ELF_OK
+        || (shndx = elf_symbol_table(elf)) < 0 || !symtab_open(elf, shndx, &tab)) {
+      elf_close(elf);
+      continue;
+    }
+
+    name = names;
+    for (size_t m = 0; m < count; ++m, name += strlen(name) + 1) {
+      long index = flags[m] ? symtab_find(&tab, name) : -1;
+
+      if (index >= 0)
+        dump_symbol_row(out, index, &tab.syms[index], symtab_name(&tab, index));
+    }
+    symtab_close(&tab);
+    elf_close(elf);
+  }
+
+  name = names;
+  for (size_t n = 0; n < count; ++n, name += strlen(name) + 1)
+    missing |= (*name && !found[n]);
+
+  if (missing) {
+    out_str(out, "Not found:");
+    name = names;
+    for (size_t n = 0; n < count; ++n, name += strlen(name) + 1) {
+      if (*name && !found[n]) {
+        out_char(out, ' ');
+        out_str(out, name);
+      }
+    }
+    out_char(out, '\n');
+  }
+  free(found);
+  free(defines);
+  free(names);
+}
+
+/**
+ * @brief Runs the handler over every member of an archive.
+ * 
+ * The archive is mapped once and every member is parsed in place, as a
+ * view of that mapping. Members are dumped in parallel, each into its own
+ * buffer, and written out in archive order. -l is answered from the armap
+ * (when there is one) without opening the members that don't match.
+ * 
+ * @param filename The path of the archive.
+ * @param fd Its descriptor, still owned by the caller.
+ * @param size Its size.
+ * @param batch The handler, its argument and the number of threads.
+ * @param out Where the output goes.
+ * @param stats Where each phase is measured, NULL to measure nothing.
+ * @param mark The start of the current phase.
+ * @return bool false if the archive is corrupt or a member isn't an ELF file.
+ */
+
+bool process_archive(const char *filename, int fd, uint64_t size, const batch_t *batch, out_t *out,
+                     stats_t *stats, stats_mark_t *mark) {
+  char *file = size ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+  archive_t ar;
+  ar_run_t run = {.ar = &ar, .path = filename, .batch = batch, .ok = true, .out = out};
+
+  if (file == MAP_FAILED) {
+    fprintf(stderr, "%s: %s\n", filename, elf_strerror(ELF_EMAP));
+    return false;
+  }
+  if (!archive_open(&ar, file, size)) {
+    fprintf(stderr, "%s: The archive is truncated or corrupt.\n", filename);
+    archive_close(&ar);
+    munmap(file, size);
+    return false;
+  }
+
+  if (stats) {
+    stats_add(stats, STATS_INIT, mark);
+    out->count_lines = true;
+    stats->rows = out_lines(out);
+    stats->out_bytes = out->bytes;
+    stats_mark(mark);
+  }
+
+  if (batch->func == lookup_symbols && ar.armap) {
+    ar_lookup(&run);
+  } else if (ar.count) {
+    if (!(run.results = calloc(ar.count, sizeof(ar_result_t))))
+      error_handling(-1, NULL, NULL, "Failed to allocate memory for the members!");
+    pthread_mutex_init(&run.lock, NULL);
+    pool_run(ar.count, batch->jobs, ar_job, &run);
+    pthread_mutex_destroy(&run.lock);
+    free(run.results);
+  }
+
+  if (stats) {
+    stats_add(stats, STATS_HANDLER, mark);
+    stats->rows = out_lines(out) - stats->rows;
+    stats->out_bytes = out->bytes - stats->out_bytes;
+    stats->mapped = size;
+    stats->touched = stats_resident(file, size);
+    stats_mark(mark);
+  }
+
+  archive_close(&ar);
+  munmap(file, size);
+
+  if (stats)
+    stats_add(stats, STATS_DESTROY, mark);
+  return run.ok;
+}
@@ -0,0 +1,51 @@
+#ifndef _ARCHIVE_H
+#define _ARCHIVE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ar.h>
+
+typedef struct ar_member {
+  const char *name;    /* in the header or in the // table, not NUL terminated */
+  size_t name_len;
+  uint64_t header;     /* offset of the member header, what the armap points at */
+  uint64_t offset;     /* offset of the data */
+  uint64_t size;
+} ar_member_t;
+
+typedef struct archive {
+  char *file;
+  uint64_t size;
+  ar_member_t *members;
+  size_t count;
+  const char *armap;   /* the / (or /SYM64/) member: count, offsets, names, big-endian */
+  uint64_t armap_size;
+  unsigned int armap_word;
+} archive_t;
+
+typedef struct ar_result {
+  char *buf;
+  size_t len;
+  bool done;
+  bool ok;
+} ar_result_t;
+
+typedef struct ar_run {
+  const archive_t *ar;
+  const char *path;
+  const batch_t *batch;
+  ar_result_t *results;
+  size_t next;
+  bool ok;
+  out_t *out;
+  pthread_mutex_t lock;
+} ar_run_t;
+
+bool archive_check(int fd);
+bool archive_open(archive_t *ar, char *file, uint64_t size);
+void archive_close(archive_t *ar);
+void archive_find(const archive_t *ar, const char *names, size_t count, bool *defines);
+bool process_archive(const char *filename, int fd, uint64_t size, const batch_t *batch, out_t *out,
+                     stats_t *stats, stats_mark_t *mark);
+
+#endif
@@ -0,0 +1,426 @@
+/**
+ * @file batch.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Multi-file batch mode, fans the files out over the worker pool.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+typedef struct job_result {
+  char *buf;
+  size_t len;
+  stats_t stats;
+  bool done;
+  bool ok;
+} job_result_t;
+
+typedef struct batch_run {
+  batch_t *batch;
+  job_result_t *results;
+  size_t next;
+  bool ok;
+  out_t *out;
+  pthread_mutex_t lock;
+} batch_run_t;
+
+/**
+ * @brief Reads everything from a file descriptor into a NUL terminated buffer.
+ * 
+ * @param fd The file descriptor.
+ * @param len Where the number of bytes read is stored.
+ * @return char* The buffer, NULL on failure.
+ */
+
+char *read_all(int fd, size_t *len) {
+  size_t cap = 4096;
+  char *buf = malloc(cap);
+
+  *len = 0;
+  while (buf) {
+    if (*len + 1 >= cap) {
+      char *tmp = realloc(buf, cap *= 2);
+
+      if (!tmp) {
+        free(buf);
+        return NULL;
+      }
+      buf = tmp;
+    }
+
+    ssize_t n = read(fd, buf + *len, cap - *len - 1);
+
+    if (n < 0) {
+      free(buf);
+      return NULL;
+    }
+    if (!n)
+      break;
+    *len += n;
+  }
+
+  if (buf)
+    buf[*len] = '\0';
+  return buf;
+}
+
+/**
+ * @brief Appends a single path to the batch.
+ * 
+ * @param batch A pointer to the batch.
+ * @param path The path, it has to outlive the batch.
+ */
+
+static bool batch_push(batch_t *batch, char *path) {
+  if (batch->count == batch->capacity) {
+    size_t cap = batch->capacity ? batch->capacity * 2 : 64;
+    char **tmp = realloc(batch->files, cap * sizeof(char *));
+
+    if (!tmp)
+      return false;
+    batch->files = tmp;
+    batch->capacity = cap;
+  }
+  batch->files[batch->count++] = path;
+  return true;
+}
+
+/**
+ * @brief Reads a list of paths and splits it in place on the separator.
+ * 
+ * @param batch A pointer to the batch.
+ * @param fd Where the list is read from.
+ * @param sep '\n' for @listfile, '\0' for stdin.
+ */
+
+static bool batch_read_list(batch_t *batch, int fd, char sep) {
+  size_t len = 0;
+  char *list = read_all(fd, &len);
+  char **tmp = NULL;
+
+  if (!list || !(tmp = realloc(batch->lists, (batch->lists_count + 1) * sizeof(char *)))) {
+    free(list);
+    return false;
+  }
+  batch->lists = tmp;
+  batch->lists[batch->lists_count++] = list;
+
+  for (char *p = list, *end = list + len; p < end;) {
+    char *q = memchr(p, sep, end - p);
+
+    if (!q)
+      q = end;
+    *q = '\0';
+    if (q > p && !batch_push(batch, p))
+      return false;
+    p = q + 1;
+  }
+  return true;
+}
+
+/**
+ * @brief Adds a command line argument to the batch.
+ * 
+ * A plain argument is a path, `@file` reads newline separated paths from
+ * file, and `-` reads NUL separated paths from stdin (find -print0).
+ * 
+ * @param batch A pointer to the batch.
+ * @param arg The argument.
+ */
+
+bool batch_add_arg(batch_t *batch, char *arg) {
+  if (!strcmp(arg, "-"))
+    return batch_read_list(batch, STDIN_FILENO, '\0');
+
+  if (arg[0] == '@') {
+    int fd = open(arg + 1, O_RDONLY);
+    bool ok = false;
+
+    if (fd != -1) {
+      ok = batch_read_list(batch, fd, '\n');
+      close(fd);
+    }
+    return ok;
+  }
+
+  return batch_push(batch, arg);
+}
+
+/**
+ * @brief In case of an error, this will handle it nicely.
+ * 
+ * The parser itself never exits, the command line tool does, from here.
+ * 
+ * @param fd The file descriptor of the file we opened, -1 if none.
+ * @param elf A pointer to the struct, NULL if none.
+ * @param file Unused, the struct owns its mapping.
+ * @param reason The reason. Duh.
+ */
+
+void error_handling(int fd, elf_t *elf, char *file, const char *reason) {
+  (void)file;
+  fprintf(stderr, "%s\n", reason);
+  elf_close(elf);
+  if (fd != -1)
+    close(fd);
+  exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Opens the file, maps the file into memory, parses it and dumps the elf header.
+ *
+ * @param fd The file descriptor of the ELF file we are going to inspect.
+ */
+
+elf_t *init_elf(int fd) {
+  return init_elf_backend(fd, ELF_BACKEND_AUTO);
+}
+
+/**
+ * @brief Same as init_elf(), with a choice of backend, any failure is fatal.
+ * 
+ */
+
+elf_t *init_elf_backend(int fd, elf_backend_t backend) {
+  elf_t *elf;
+  elf_status_t status = elf_open_fd(fd, backend, NULL, &elf);
+
+  if (status != ELF_OK)
+    error_handling(fd, NULL, NULL, elf_strerror(status));
+  return elf;
+}
+
+/**
+ * @brief Frees all the allocated memory, thus "destroying" the parser.
+ * 
+ * @param fd The file descriptor of the file we inspected.
+ * @param elf The pointer to the struct.
+ */
+
+void destroy_parser(int fd, elf_t *elf) {
+  elf_close(elf);
+  close(fd);
+}
+
+/**
+ * @brief Opens a file, runs one handler over it and tears everything down again.
+ * 
+ * With a cache, a hit is served from the cache entry without reading the
+ * file at all, and a miss stores an entry for the next run. With the pread
+ * backend, --stats reports the number of bytes read. Archives are handed
+ * to process_archive(), member by member.
+ * 
+ * @param filename The path of the ELF file.
+ * @param batch The handler, its argument, the backend and the cache (if any).
+ * @param out Where the handler writes its output.
+ * @param stats Where each phase is measured, NULL to measure nothing.
+ * @return bool false if the file could not be opened.
+ */
+
+bool process_file(const char *filename, const batch_t *batch, out_t *out, stats_t *stats) {
+  stats_mark_t mark;
+
+  if (stats)
+    stats_mark(&mark);
+
+  int fd = open(filename, O_RDONLY);
+  struct stat st;
+
+  if (fd == -1 || fstat(fd, &st) == -1) {
+    fprintf(stderr, "%s: Failed to open the file.\n", filename);
+    if (fd != -1)
+      close(fd);
+    return false;
+  }
+
+  if (stats) {
+    stats_add(stats, STATS_OPEN, &mark);
+    stats_mark(&mark);
+  }
+
+  if (S_ISREG(st.st_mode) && archive_check(fd)) {
+    bool ok = process_archive(filename, fd, st.st_size, batch, out, stats, &mark);
+
+    close(fd);
+    return ok;
+  }
+
+  elf_t *elf = (batch->cache && S_ISREG(st.st_mode)) ? cache_open(batch->cache, fd) : NULL;
+
+  if (stats)
+    stats->cached = (elf != NULL);
+
+  if (!elf) {
+    /* one bad file shouldn't take the whole batch down with it */
+    elf_status_t status = elf_open_fd(fd, batch->backend, NULL, &elf);
+
+    if (status != ELF_OK) {
+      fprintf(stderr, "%s: %s\n", filename, elf_strerror(status));
+      close(fd);
+      return false;
+    }
+
+    if (batch->cache && S_ISREG(st.st_mode))
+      cache_store(batch->cache, fd, elf);
+  }
+
+  batch_file_t file = {.elf = elf, .out = out, .format = batch->format, .path = filename, .arg = batch->arg,
+                       .index_dir = batch->index_dir, .render_threads = batch->render_threads, .err = stderr};
+
+  if (stats) {
+    stats_add(stats, STATS_INIT, &mark);
+    out->count_lines = true;
+    stats->rows = out_lines(out);
+    stats->out_bytes = out->bytes;
+    stats_mark(&mark);
+  }
+
+  batch->func(&file);
+
+  if (stats) {
+    stats_add(stats, STATS_HANDLER, &mark);
+    stats->rows = out_lines(out) - stats->rows;
+    stats->out_bytes = out->bytes - stats->out_bytes;
+    stats->mapped = elf->file ? elf->size : 0;
+    stats->touched = elf->file ? stats_resident(elf->file, elf->size) : 0;
+    stats->read = elf->io ? elf->io->bytes_read : 0;
+  }
+
+  if (stats)
+    stats_mark(&mark);
+
+  destroy_parser(fd, elf);
+
+  if (stats)
+    stats_add(stats, STATS_DESTROY, &mark);
+  return true;
+}
+
+/**
+ * @brief Writes every finished block that is next in line, in order.
+ * 
+ * Their --stats reports go to stderr in the same order.
+ * 
+ * Must be called with the lock held.
+ * 
+ * @param run A pointer to the run.
+ */
+
+static void batch_emit(batch_run_t *run) {
+  while (run->next < run->batch->count && run->results[run->next].done) {
+    job_result_t *res = &run->results[run->next++];
+
+    out_write(run->out, res->buf, res->len);
+    free(res->buf);
+    res->buf = NULL;
+    run->ok &= res->ok;
+    if (res->ok)
+      stats_report(&res->stats, run->batch->files[run->next - 1], run->batch->stats);
+  }
+}
+
+/**
+ * @brief Parses one file into its own memory buffer, then hands it to the emitter.
+ * 
+ * @param index The index of the file.
+ * @param ctx A pointer to the run.
+ */
+
+static void batch_job(size_t index, void *ctx) {
+  batch_run_t *run = ctx;
+  job_result_t *res = &run->results[index];
+  const char *path = run->batch->files[index];
+  out_t out = {0};
+
+  if (out_init(&out, -1)) {
+    /* structured output names the file in every document already */
+    if (run->batch->format == OUT_TEXT) {
+      out_str(&out, "File: ");
+      out_str(&out, path);
+      out_char(&out, '\n');
+    }
+    res->ok = process_file(path, run->batch, &out, run->batch->stats ? &res->stats : NULL);
+    if (run->batch->format == OUT_TEXT)
+      out_char(&out, '\n');
+    res->buf = out.buf;
+    res->len = out.len;
+  }
+
+  pthread_mutex_lock(&run->lock);
+  res->done = true;
+  batch_emit(run);
+  pthread_mutex_unlock(&run->lock);
+}
+
+/**
+ * @brief Runs the handler over every file of the batch.
+ * 
+ * Files are parsed in parallel, but each file's output is written as one
+ * contiguous block, in the same order the files were given. A single file
+ * is written straight to stdout, exactly as before.
+ * 
+ * @param batch A pointer to the batch.
+ * @return bool false if any file failed.
+ */
+
+bool run_batch(batch_t *batch) {
+  out_t out = {0};
+  batch_run_t run = {.batch = batch, .ok = true, .out = &out};
+
+  if (!out_init(&out, STDOUT_FILENO)) {
+    fprintf(stderr, "Failed to allocate memory for the output buffer!\n");
+    return false;
+  }
+
+  if (batch->count == 1) {
+    stats_t stats = {0};
+
+    run.ok = process_file(batch->files[0], batch, &out, batch->stats ? &stats : NULL);
+    out_destroy(&out);
+    if (run.ok)
+      stats_report(&stats, batch->files[0], batch->stats);
+    return run.ok;
+  }
+
+  if (!(run.results = calloc(batch->count, sizeof(job_result_t)))) {
+    fprintf(stderr, "Failed to allocate memory for the batch!\n");
+    out_destroy(&out);
+    return false;
+  }
+
+  pthread_mutex_init(&run.lock, NULL);
+  pool_run(batch->count, batch->jobs, batch_job, &run);
+  pthread_mutex_destroy(&run.lock);
+
+  out_destroy(&out);
+  free(run.results);
+  return run.ok;
+}
+
+/**
+ * @brief Frees everything the batch allocated.
+ * 
+ * @param batch A pointer to the batch.
+ */
+
+void destroy_batch(batch_t *batch) {
+  for (size_t i = 0; i < batch->lists_count; ++i)
+    free(batch->lists[i]);
+  free(batch->lists);
+  free(batch->files);
+}
@@ -0,0 +1,47 @@
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* one file as a handler sees it: the parsed file and where its output goes */
+typedef struct batch_file {
+  elf_t *elf;
+  out_t *out;
+  out_format_t format;
+  const char *path;
+  const char *arg;
+  const char *index_dir; /* -c, handlers can keep indexes of their own there */
+  unsigned int render_threads; /* -T, threads rendering one symbol table, 0 or 1 for the serial path */
+  FILE *err; /* diagnostics, stderr but for the server which sends them back */
+} batch_file_t;
+
+typedef struct batch {
+  void (*func)(batch_file_t *);
+  const char *arg;
+  cache_t *cache;
+  const char *index_dir;
+  elf_backend_t backend;
+  out_format_t format;
+  stats_format_t stats;
+  char **files;
+  size_t count;
+  size_t capacity;
+  char **lists;
+  size_t lists_count;
+  unsigned int jobs;
+  unsigned int render_threads;
+} batch_t;
+
+char *read_all(int fd, size_t *len);
+bool batch_add_arg(batch_t *batch, char *arg);
+bool run_batch(batch_t *batch);
+void destroy_batch(batch_t *batch);
+elf_t *init_elf(int fd);
+elf_t *init_elf_backend(int fd, elf_backend_t backend);
+void destroy_parser(int fd, elf_t *elf);
+void error_handling(int fd, elf_t *elf, char *file, const char *reason);
+bool process_file(const char *filename, const batch_t *batch, out_t *out, stats_t *stats);
+
+#endif
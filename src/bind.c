@@ -0,0 +1,606 @@
+/**
+ * @file bind.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Binds every symbol reference of a program to its definition, the way ld.so would, without running it.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+/**
+ * @brief Tells the relocations that take a symbol from the global scope.
+ * 
+ * GLOB_DAT fills a GOT entry, JUMP_SLOT a PLT one; COPY moves a
+ * library's variable into the executable, its source is looked up past
+ * the executable.
+ * 
+ * @return int BIND_SLOT, BIND_COPY, or 0 for the other relocations.
+ */
+
+static int bind_reloc_kind(uint16_t machine, uint32_t type) {
+  switch (machine) {
+    case EM_X86_64:
+      return (type == R_X86_64_GLOB_DAT || type == R_X86_64_JUMP_SLOT) ? BIND_SLOT : (type == R_X86_64_COPY) ? BIND_COPY : 0;
+    case EM_386:
+      return (type == R_386_GLOB_DAT || type == R_386_JMP_SLOT) ? BIND_SLOT : (type == R_386_COPY) ? BIND_COPY : 0;
+    case EM_AARCH64:
+      return (type == R_AARCH64_GLOB_DAT || type == R_AARCH64_JUMP_SLOT) ? BIND_SLOT : (type == R_AARCH64_COPY) ? BIND_COPY : 0;
+    case EM_ARM:
+      return (type == R_ARM_GLOB_DAT || type == R_ARM_JUMP_SLOT) ? BIND_SLOT : (type == R_ARM_COPY) ? BIND_COPY : 0;
+    case EM_PPC:
+      return (type == R_PPC_GLOB_DAT || type == R_PPC_JMP_SLOT) ? BIND_SLOT : (type == R_PPC_COPY) ? BIND_COPY : 0;
+    case EM_PPC64:
+      return (type == R_PPC64_GLOB_DAT || type == R_PPC64_JMP_SLOT) ? BIND_SLOT : (type == R_PPC64_COPY) ? BIND_COPY : 0;
+    case EM_S390:
+      return (type == R_390_GLOB_DAT || type == R_390_JMP_SLOT) ? BIND_SLOT : (type == R_390_COPY) ? BIND_COPY : 0;
+    case EM_RISCV:
+      return (type == R_RISCV_JUMP_SLOT) ? BIND_SLOT : (type == R_RISCV_COPY) ? BIND_COPY : 0;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Names a version index.
+ * 
+ */
+
+static void bind_set_version(bind_obj_t *obj, uint16_t ndx, const char *name, uint32_t hash) {
+  ndx &= BIND_VERSIONS_MAX;
+  if (ndx >= obj->nversions) {
+    bind_version_t *tmp = realloc(obj->versions, (ndx + 1) * sizeof(bind_version_t));
+
+    if (!tmp)
+      error_handling(-1, NULL, NULL, "Failed to allocate memory for the versions!");
+    memset(tmp + obj->nversions, 0, (ndx + 1 - obj->nversions) * sizeof(bind_version_t));
+    obj->versions = tmp;
+    obj->nversions = ndx + 1;
+  }
+  obj->versions[ndx] = (bind_version_t){name, hash};
+}
+
+/**
+ * @brief Returns a string of a string table section, NULL if it is out of it.
+ * 
+ */
+
+static const char *bind_string(elf_t *elf, Elf64_Word strndx, uint64_t offset) {
+  const char *strtab = elf_section_data(elf, strndx);
+  const char *str = strtab ? elf_string(strtab, elf->elf_section_header[strndx].sh_size, offset) : "";
+
+  return *str ? str : NULL;
+}
+
+/**
+ * @brief Reads the versions a file defines (.gnu.version_d).
+ * 
+ * Elf32 and Elf64 verdef records are the same, only their byte order
+ * differs.
+ */
+
+static void bind_read_verdef(bind_obj_t *obj, const Elf64_Shdr *shdr, const char *data) {
+  uint64_t offset = 0;
+
+  if (shdr->sh_size < sizeof(Elf64_Verdef))
+    return;
+
+  for (Elf64_Word n = 0; n < shdr->sh_info && offset <= shdr->sh_size - sizeof(Elf64_Verdef); ++n) {
+    Elf64_Half halves[4];
+    Elf64_Word words[3], vda_name;
+
+    /* vd_version, vd_flags, vd_ndx, vd_cnt, then vd_hash, vd_aux, vd_next */
+    elf_halves(obj->elf, halves, data + offset, 4);
+    elf_words(obj->elf, words, data + offset + 8, 3);
+
+    Elf64_Verdef vd = {.vd_version = halves[0], .vd_flags = halves[1], .vd_ndx = halves[2], .vd_cnt = halves[3],
+                       .vd_hash = words[0], .vd_aux = words[1], .vd_next = words[2]};
+
+    if (vd.vd_aux > shdr->sh_size - offset - sizeof(Elf64_Verdaux))
+      break;
+    elf_words(obj->elf, &vda_name, data + offset + vd.vd_aux, 1);
+
+    const char *name = bind_string(obj->elf, shdr->sh_link, vda_name);
+
+    if (name)
+      bind_set_version(obj, vd.vd_ndx, name, vd.vd_hash);
+    if (!vd.vd_next || vd.vd_next > shdr->sh_size - offset)
+      break;
+    offset += vd.vd_next;
+  }
+}
+
+/**
+ * @brief Reads the versions a file needs (.gnu.version_r).
+ * 
+ */
+
+static void bind_read_verneed(bind_obj_t *obj, const Elf64_Shdr *shdr, const char *data) {
+  uint64_t offset = 0;
+
+  /* a Verneed and a Vernaux are the same size, this keeps both bounds below from wrapping */
+  if (shdr->sh_size < sizeof(Elf64_Verneed) || shdr->sh_size < sizeof(Elf64_Vernaux))
+    return;
+
+  for (Elf64_Word n = 0; n < shdr->sh_info && offset <= shdr->sh_size - sizeof(Elf64_Verneed); ++n) {
+    Elf64_Half halves[2];
+    Elf64_Word words[3];
+
+    /* vn_version, vn_cnt, then vn_file, vn_aux, vn_next */
+    elf_halves(obj->elf, halves, data + offset, 2);
+    elf_words(obj->elf, words, data + offset + 4, 3);
+
+    Elf64_Verneed vn = {.vn_version = halves[0], .vn_cnt = halves[1],
+                        .vn_file = words[0], .vn_aux = words[1], .vn_next = words[2]};
+    uint64_t aux = offset + vn.vn_aux;
+
+    for (Elf64_Half a = 0; a < vn.vn_cnt && aux <= shdr->sh_size - sizeof(Elf64_Vernaux); ++a) {
+      Elf64_Word hash, tail[2];
+      Elf64_Half flags[2];
+
+      /* vna_hash, then vna_flags, vna_other, then vna_name, vna_next */
+      elf_words(obj->elf, &hash, data + aux, 1);
+      elf_halves(obj->elf, flags, data + aux + 4, 2);
+      elf_words(obj->elf, tail, data + aux + 8, 2);
+
+      Elf64_Vernaux vna = {.vna_hash = hash, .vna_flags = flags[0], .vna_other = flags[1],
+                           .vna_name = tail[0], .vna_next = tail[1]};
+      const char *name = bind_string(obj->elf, shdr->sh_link, vna.vna_name);
+
+      if (name)
+        bind_set_version(obj, vna.vna_other, name, vna.vna_hash);
+      if (!vna.vna_next || vna.vna_next > shdr->sh_size - aux)
+        break;
+      aux += vna.vna_next;
+    }
+    if (!vn.vn_next || vn.vn_next > shdr->sh_size - offset)
+      break;
+    offset += vn.vn_next;
+  }
+}
+
+/**
+ * @brief Gets a file ready to look symbols up in: .dynsym and its hash table, versions.
+ * 
+ * @param elf A mapped file, read by several threads at once.
+ * @param obj The object to fill in.
+ */
+
+static void bind_obj_open(elf_t *elf, bind_obj_t *obj) {
+  uint64_t count;
+  const Elf64_Dyn *dyn = elf_dynamic(elf, &count);
+
+  memset(obj, 0, sizeof(bind_obj_t));
+  obj->elf = elf;
+
+  for (uint64_t i = 0; dyn && i < count && dyn[i].d_tag != DT_NULL; ++i) {
+    if (dyn[i].d_tag == DT_SYMBOLIC || (dyn[i].d_tag == DT_FLAGS && (dyn[i].d_un.d_val & DF_SYMBOLIC)))
+      obj->symbolic = true;
+  }
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    if (elf->elf_section_header[i].sh_type == SHT_DYNSYM) {
+      obj->dynsym_index = i;
+      obj->usable = symtab_open(elf, i, &obj->dynsym);
+      break;
+    }
+  }
+  if (!obj->usable)
+    return;
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+    const char *data;
+
+    if (shdr->sh_link != (Elf64_Word)obj->dynsym_index && shdr->sh_type == SHT_GNU_versym)
+      continue;
+
+    switch (shdr->sh_type) {
+      case SHT_GNU_versym:
+        if (shdr->sh_size / sizeof(Elf64_Half) >= obj->dynsym.count)
+          obj->versym = elf_section_table(elf, i);
+        break;
+      case SHT_GNU_verdef:
+        if ((data = elf_section_data(elf, i)) && shdr->sh_link < elf->elf_header->e_shnum)
+          bind_read_verdef(obj, shdr, data);
+        break;
+      case SHT_GNU_verneed:
+        if ((data = elf_section_data(elf, i)) && shdr->sh_link < elf->elf_header->e_shnum)
+          bind_read_verneed(obj, shdr, data);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+/**
+ * @brief Frees what bind_obj_open() allocated.
+ * 
+ */
+
+static void bind_obj_close(bind_obj_t *obj) {
+  symtab_close(&obj->dynsym);
+  free(obj->versions);
+}
+
+/**
+ * @brief Returns the lookup object of a library, built once for the whole run.
+ * 
+ * Threads that race to build it keep the first one published.
+ */
+
+static bind_obj_t *bind_lib_obj(deps_lib_t *lib) {
+  bind_obj_t *obj = __atomic_load_n(&lib->bind, __ATOMIC_ACQUIRE);
+  bind_obj_t *expected = NULL;
+
+  if (obj)
+    return obj;
+  if (!(obj = malloc(sizeof(bind_obj_t))))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the libraries!");
+  bind_obj_open(lib->elf, obj);
+
+  if (!__atomic_compare_exchange_n(&lib->bind, &expected, obj, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    bind_obj_close(obj);
+    free(obj);
+    obj = expected;
+  }
+  return obj;
+}
+
+/**
+ * @brief Tells whether a symbol of a file can satisfy a reference, as ld.so's check_match().
+ * 
+ * @param want The version asked for, NULL for an unversioned reference.
+ * @param mismatch Set when the name is right and the version is not.
+ */
+
+static bool bind_match(const bind_obj_t *obj, long index, const bind_version_t *want, bool *mismatch) {
+  const Elf64_Sym *sym = &obj->dynsym.syms[index];
+  unsigned char type = ELF64_ST_TYPE(sym->st_info);
+
+  if (sym->st_shndx == SHN_UNDEF || (sym->st_value == 0 && sym->st_shndx != SHN_ABS && type != STT_TLS))
+    return false;
+  if (type > STT_TLS && type != STT_GNU_IFUNC)
+    return false;
+  if (ELF64_ST_BIND(sym->st_info) == STB_LOCAL)
+    return false;
+
+  /* files without versions satisfy any version */
+  if (!obj->versym)
+    return true;
+
+  Elf64_Half ndx = obj->versym[index];
+
+  if (!want)
+    return !(ndx & 0x8000); /* hidden versions are only found by name@version */
+
+  ndx &= BIND_VERSIONS_MAX;
+  if (ndx < obj->nversions && obj->versions[ndx].name && obj->versions[ndx].hash == want->hash
+      && !strcmp(obj->versions[ndx].name, want->name))
+    return true;
+  *mismatch = true;
+  return false;
+}
+
+/**
+ * @brief Looks a reference up in the objects of the load order from `from` on.
+ * 
+ * @return int32_t The load order index of the first definition, -1 if there is none.
+ */
+
+static int32_t bind_scope(const bind_run_t *run, size_t from, const char *name, uint32_t hash,
+                          const bind_version_t *want, bool *mismatch) {
+  for (size_t i = from; i < run->walk->count; ++i) {
+    const bind_obj_t *obj = run->objs[i];
+
+    if (!obj->usable)
+      continue;
+    for (long c = -1; (c = symtab_find_next(&obj->dynsym, name, hash, c)) >= 0;) {
+      if (bind_match(obj, c, want, mismatch))
+        return (int32_t)i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Returns the version a reference asks for, NULL if it asks for none.
+ * 
+ */
+
+static const bind_version_t *bind_wanted(const bind_obj_t *obj, uint32_t sym) {
+  if (!obj->versym)
+    return NULL;
+
+  Elf64_Half ndx = obj->versym[sym] & BIND_VERSIONS_MAX;
+
+  return (ndx >= 2 && ndx < obj->nversions && obj->versions[ndx].name) ? &obj->versions[ndx] : NULL;
+}
+
+/**
+ * @brief Collects the references of one object: undefined symbols and GLOB_DAT/JUMP_SLOT/COPY targets.
+ * 
+ * Defined symbols are looked up too when a GOT or PLT slot refers to
+ * them, another object can interpose them; protected ones bind locally.
+ */
+
+static void bind_collect(bind_run_t *run, size_t index) {
+  const bind_obj_t *obj = run->objs[index];
+  elf_t *elf = obj->elf;
+  size_t count = obj->dynsym.count, n = 0;
+  unsigned char *wanted = calloc(count ? count : 1, 1);
+
+  if (!wanted)
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the references!");
+
+  for (size_t i = 1; i < count; ++i) {
+    const Elf64_Sym *sym = &obj->dynsym.syms[i];
+
+    wanted[i] = (sym->st_shndx == SHN_UNDEF && sym->st_name && ELF64_ST_BIND(sym->st_info) != STB_LOCAL)
+                ? BIND_SLOT : 0;
+  }
+
+  for (int s = 0; s < elf->elf_header->e_shnum; ++s) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[s];
+    bool rela = shdr->sh_type == SHT_RELA;
+
+    if ((!rela && shdr->sh_type != SHT_REL) || shdr->sh_link != (Elf64_Word)obj->dynsym_index)
+      continue;
+
+    const char *table = elf_section_table(elf, s);
+    size_t size = rela ? sizeof(Elf64_Rela) : sizeof(Elf64_Rel);
+    uint64_t entries = shdr->sh_size / (rela ? elf->elf_header->e_ident[EI_CLASS] == ELFCLASS32
+                                              ? sizeof(Elf32_Rela) : sizeof(Elf64_Rela)
+                                            : elf->elf_header->e_ident[EI_CLASS] == ELFCLASS32
+                                              ? sizeof(Elf32_Rel) : sizeof(Elf64_Rel));
+
+    for (uint64_t r = 0; table && r < entries; ++r) {
+      /* r_offset and r_info lead both layouts */
+      const Elf64_Rel *rel = (const Elf64_Rel *)(table + r * size);
+      uint64_t sym = ELF64_R_SYM(rel->r_info);
+
+      int kind = bind_reloc_kind(elf->elf_header->e_machine, ELF64_R_TYPE(rel->r_info));
+
+      if (sym && sym < count && kind && (kind == BIND_COPY || !wanted[sym])
+          && ELF64_ST_VISIBILITY(obj->dynsym.syms[sym].st_other) != STV_PROTECTED)
+        wanted[sym] = kind;
+    }
+  }
+
+  for (size_t i = 1; i < count; ++i)
+    n += wanted[i] != 0;
+  if (n && !(run->refs[index] = malloc(n * sizeof(bind_ref_t))))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the references!");
+  for (size_t i = 1; i < count; ++i) {
+    if (wanted[i])
+      run->refs[index][run->nrefs[index]++] = (bind_ref_t){(uint32_t)i, -1, -1, wanted[i] == BIND_COPY, false};
+  }
+  free(wanted);
+}
+
+/**
+ * @brief Gets one object of the load order ready to be looked up in.
+ * 
+ */
+
+static void bind_prepare_job(size_t index, void *ctx) {
+  bind_run_t *run = ctx;
+
+  if (index)
+    run->objs[index] = bind_lib_obj(run->walk->nodes[index].lib);
+}
+
+/**
+ * @brief Binds the references of one object of the load order.
+ * 
+ * The global scope is the load order itself; DT_SYMBOLIC objects look in
+ * themselves first, the source of a COPY is looked up past the object. The search goes on past the definition, to tell
+ * interposed symbols.
+ */
+
+static void bind_job(size_t index, void *ctx) {
+  bind_run_t *run = ctx;
+  const bind_obj_t *obj = run->objs[index];
+
+  if (!obj->usable)
+    return;
+  bind_collect(run, index);
+
+  for (size_t r = 0; r < run->nrefs[index]; ++r) {
+    bind_ref_t *ref = &run->refs[index][r];
+    const char *name = symtab_name(&obj->dynsym, ref->sym);
+    const bind_version_t *want = bind_wanted(obj, ref->sym);
+    uint32_t hash = gnu_hash(name);
+    bool defined = obj->dynsym.syms[ref->sym].st_shndx != SHN_UNDEF;
+
+    if (obj->symbolic && defined && !ref->copy) {
+      for (long c = -1; ref->def < 0 && (c = symtab_find_next(&obj->dynsym, name, hash, c)) >= 0;)
+        ref->def = bind_match(obj, c, want, &ref->version_missing) ? (int32_t)index : -1;
+    }
+    if (ref->def < 0)
+      ref->def = bind_scope(run, ref->copy ? index + 1 : 0, name, hash, want, &ref->version_missing);
+    if (ref->def >= 0) {
+      bool ignored = false;
+
+      ref->also = bind_scope(run, ref->def + 1, name, hash, want, &ignored);
+      if (ref->also == (int32_t)index && obj->symbolic)
+        ref->also = -1;
+    }
+  }
+}
+
+/**
+ * @brief Writes name@version of a reference.
+ * 
+ */
+
+static void bind_dump_name(out_t *out, const bind_obj_t *obj, uint32_t sym) {
+  const bind_version_t *want = bind_wanted(obj, sym);
+
+  out_str(out, symtab_name(&obj->dynsym, sym));
+  if (want) {
+    out_char(out, '@');
+    out_str(out, want->name);
+  }
+}
+
+/**
+ * @brief Prints the totals, what was left unresolved and what is interposed.
+ * 
+ */
+
+static void bind_dump(batch_file_t *file, const bind_run_t *run) {
+  out_t *out = file->out;
+  size_t count = run->walk->count, total = 0, unresolved = 0, weak = 0, interposed = 0;
+  size_t *provided = calloc(count, sizeof(size_t));
+
+  if (!provided)
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the references!");
+
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t r = 0; r < run->nrefs[i]; ++r) {
+      const bind_ref_t *ref = &run->refs[i][r];
+
+      total++;
+      if (ref->def >= 0)
+        provided[ref->def]++;
+      else if (ELF64_ST_BIND(run->objs[i]->dynsym.syms[ref->sym].st_info) == STB_WEAK)
+        weak++;
+      else
+        unresolved++;
+      interposed += ref->also >= 0;
+    }
+  }
+
+  out_str(out, "References: ");
+  out_udec(out, total, 0, 0);
+  out_str(out, ", unresolved: ");
+  out_udec(out, unresolved, 0, 0);
+  out_str(out, ", weak left unresolved: ");
+  out_udec(out, weak, 0, 0);
+  out_str(out, ", interposed: ");
+  out_udec(out, interposed, 0, 0);
+  out_str(out, "\n\nObjects:\n   #        Refs   Defines  Path\n");
+  for (size_t i = 0; i < count; ++i) {
+    out_udec(out, i, 4, 0);
+    out_str(out, "  ");
+    out_udec(out, run->nrefs[i], 10, 0);
+    out_udec(out, provided[i], 10, 0);
+    out_str(out, "  ");
+    out_str(out, run->walk->nodes[i].lib->path);
+    out_str(out, run->objs[i]->usable ? "\n" : " (no .dynsym)\n");
+  }
+
+  if (unresolved) {
+    out_str(out, "\nUnresolved:\n");
+    for (size_t i = 0; i < count; ++i) {
+      for (size_t r = 0; r < run->nrefs[i]; ++r) {
+        const bind_ref_t *ref = &run->refs[i][r];
+
+        if (ref->def >= 0 || ELF64_ST_BIND(run->objs[i]->dynsym.syms[ref->sym].st_info) == STB_WEAK)
+          continue;
+        out_str(out, "  ");
+        bind_dump_name(out, run->objs[i], ref->sym);
+        out_str(out, ", referenced by ");
+        out_str(out, run->walk->nodes[i].lib->path);
+        out_str(out, ref->version_missing ? " (defined, not with that version)\n" : "\n");
+      }
+    }
+  }
+
+  if (interposed) {
+    out_str(out, "\nInterposed:\n");
+    for (size_t i = 0; i < count; ++i) {
+      for (size_t r = 0; r < run->nrefs[i]; ++r) {
+        const bind_ref_t *ref = &run->refs[i][r];
+
+        if (ref->also < 0)
+          continue;
+        out_str(out, "  ");
+        bind_dump_name(out, run->objs[i], ref->sym);
+        out_str(out, ", referenced by ");
+        out_str(out, run->walk->nodes[i].lib->path);
+        out_str(out, ", binds to ");
+        out_str(out, run->walk->nodes[ref->def].lib->path);
+        out_str(out, " over ");
+        out_str(out, run->walk->nodes[ref->also].lib->path);
+        out_char(out, '\n');
+      }
+    }
+  }
+  free(provided);
+}
+
+/**
+ * @brief Binds every symbol reference of a file and its libraries, like ld.so would.
+ * 
+ * The libraries are the ones -D finds (file->arg is the sysroot). Every
+ * undefined .dynsym entry and every GLOB_DAT/JUMP_SLOT/COPY target of each
+ * object is looked up in the load order, through the GNU hash bloom
+ * filters and with the .gnu.version/.gnu.version_r versions checked.
+ * The objects are bound in parallel, and the libraries' lookup tables
+ * are kept for the run, so a batch of binaries shares them.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void bind_symbols(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  deps_lib_t root;
+  deps_walk_t walk;
+  bind_run_t run = {&walk, NULL, NULL, NULL, NULL};
+
+  if (!deps_walk(file, &root, &walk)) {
+    out_str(out, "Not a dynamically linked file.\n");
+    return;
+  }
+
+  /* the threads read the file too, a mapping they can share */
+  run.mapped = elf;
+  if (!elf->file && elf_open(file->path, ELF_BACKEND_MMAP, NULL, &run.mapped) != ELF_OK) {
+    out_str(out, "Failed to map the file.\n");
+    deps_walk_free(&root, &walk);
+    return;
+  }
+
+  bind_obj_t self;
+
+  run.objs = calloc(walk.count, sizeof(bind_obj_t *));
+  run.refs = calloc(walk.count, sizeof(bind_ref_t *));
+  run.nrefs = calloc(walk.count, sizeof(size_t));
+  if (!run.objs || !run.refs || !run.nrefs)
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the references!");
+
+  bind_obj_open(run.mapped, &self);
+  run.objs[0] = &self;
+  pool_run(walk.count, 0, bind_prepare_job, &run);
+  pool_run(walk.count, 0, bind_job, &run);
+
+  bind_dump(file, &run);
+
+  for (size_t i = 0; i < walk.count; ++i)
+    free(run.refs[i]);
+  free(run.refs);
+  free(run.nrefs);
+  free(run.objs);
+  bind_obj_close(&self);
+  if (run.mapped != elf)
+    elf_close(run.mapped);
+  deps_walk_free(&root, &walk);
+}
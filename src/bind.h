@@ -0,0 +1,45 @@
+#ifndef _BIND_H
+#define _BIND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BIND_VERSIONS_MAX 0x7fff /* .gnu.version indices are 15 bits, the top one is "hidden" */
+#define BIND_SLOT 1              /* an undefined symbol, or a GOT/PLT slot */
+#define BIND_COPY 2              /* a COPY relocation, bound past its object */
+
+typedef struct bind_version {
+  const char *name;      /* NULL for an index neither defined nor needed */
+  uint32_t hash;         /* vd_hash/vna_hash, the ELF hash of the name */
+} bind_version_t;
+
+typedef struct bind_obj {
+  elf_t *elf;
+  bool usable;           /* it has a .dynsym to look in */
+  int dynsym_index;
+  symtab_t dynsym;
+  const Elf64_Half *versym;  /* NULL when the file isn't versioned */
+  bind_version_t *versions;  /* by .gnu.version index, from .gnu.version_d and .gnu.version_r */
+  size_t nversions;
+  bool symbolic;         /* DT_SYMBOLIC, its own definitions come first */
+} bind_obj_t;
+
+typedef struct bind_ref {
+  uint32_t sym;          /* .dynsym index in the referencing object */
+  int32_t def;           /* the load order index of the definition, -1 if there is none */
+  int32_t also;          /* the next object defining it too, -1 if there is none */
+  bool copy;             /* the target of a COPY relocation */
+  bool version_missing;  /* the name is there, never with the version asked for */
+} bind_ref_t;
+
+typedef struct bind_run {
+  deps_walk_t *walk;
+  bind_obj_t **objs;     /* per object of the load order */
+  bind_ref_t **refs;
+  size_t *nrefs;
+  elf_t *mapped;         /* the file itself, mapped if it was read with pread */
+} bind_run_t;
+
+void bind_symbols(batch_file_t *file);
+
+#endif
@@ -0,0 +1,613 @@
+/**
+ * @file bloat.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Attributes file and memory size to sections, symbols and namespaces.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+static const char bloat_std[] = "std";
+static const char bloat_global[] = "(global)";
+static const char bloat_none[] = "(no prefix)";
+
+/**
+ * @brief '12.3%', right-aligned in `width`.
+ * 
+ */
+
+static void bloat_percent(out_t *out, uint64_t part, uint64_t total, unsigned int width) {
+  /* tenths of a percent, rounded; part only gets close to 2^64 / 1000 in broken files */
+  uint64_t tenths = !total ? 0 : (part < UINT64_MAX / 1000) ? (part * 1000 + total / 2) / total : part / (total / 1000 + 1);
+  unsigned int len = 4;
+
+  for (uint64_t v = tenths / 10; v >= 10; v /= 10)
+    len++;
+  for (; len < width; ++len)
+    out_char(out, ' ');
+  out_udec(out, tenths / 10, 0, 0);
+  out_char(out, '.');
+  out_char(out, '0' + (char)(tenths % 10));
+  out_char(out, '%');
+}
+
+/**
+ * @brief Skips template arguments (or anything else up to its matching E).
+ * 
+ * Not a demangler: nested I/N/L/X open a level, E closes one, and
+ * <length><identifier> runs are jumped over so their letters don't count.
+ * 
+ * @return const char* Past the closing E, NULL if the name ends first.
+ */
+
+static const char *bloat_skip(const char *p) {
+  unsigned int depth = 0;
+
+  while (*p) {
+    if (*p >= '0' && *p <= '9') {
+      char *end;
+      unsigned long n = strtoul(p, &end, 10);
+
+      if (strnlen(end, n) < n)
+        return NULL;
+      p = end + n;
+      continue;
+    }
+    if (*p == 'I' || *p == 'N' || *p == 'L' || *p == 'X')
+      depth++;
+    else if (*p == 'E' && !--depth)
+      return p + 1;
+    p++;
+  }
+  return NULL;
+}
+
+/**
+ * @brief The namespaces and classes of an Itanium-mangled name, outermost first.
+ * 
+ * _ZN3foo3bar3bazEv gives foo and bar (baz is the function), a
+ * constructor or an operator keeps the whole scope, _ZTV/_ZTI/_ZTS (vtable
+ * and typeinfo) count towards the class they describe.
+ * 
+ * @return size_t The number of levels, 0 for a function at global scope.
+ */
+
+static size_t bloat_mangled(const char *p, const char **comp, uint32_t *len) {
+  size_t n = 0, found = 0;
+  bool scope = false;     /* the last component is a scope, not the entity */
+  bool nested = false;
+
+  p += 2;
+  if (*p == 'T' && (p[1] == 'V' || p[1] == 'I' || p[1] == 'S')) {
+    p += 2;
+    scope = true;
+  }
+  if (*p == 'L')
+    p++;
+  if (*p == 'N') {
+    p++;
+    while (*p == 'r' || *p == 'V' || *p == 'K')
+      p++;
+    nested = true;
+  }
+
+  for (;;) {
+    const char *name;
+    unsigned long size;
+
+    if (p[0] == 'S' && p[1] == 't') {
+      name = bloat_std;
+      size = 3;
+      p += 2;
+    } else if (*p >= '1' && *p <= '9') {
+      char *end;
+
+      size = strtoul(p, &end, 10);
+      if (strnlen(end, size) < size)
+        break;
+      name = end;
+      p = end + size;
+    } else {
+      /* C1/D1, operators: what came before is the scope */
+      scope = scope || (nested && (*p == 'C' || *p == 'D' || (*p >= 'a' && *p <= 'z')));
+      break;
+    }
+
+    if (n < BLOAT_DEPTH + 1) {
+      comp[n] = name;
+      len[n++] = (uint32_t)size;
+    }
+    found++;
+
+    if (*p == 'I' && !(p = bloat_skip(p)))
+      break;
+    /* outside N...E only std:: can be followed by another name */
+    if (!nested && name != bloat_std)
+      break;
+    if (*p == 'E')
+      break;
+  }
+
+  if (!scope && found && n == found)
+    n--;
+  return (n > BLOAT_DEPTH) ? BLOAT_DEPTH : n;
+}
+
+/**
+ * @brief The levels a symbol is rolled up under.
+ * 
+ * Mangled C++ names go by namespace; everything else by its prefixes up
+ * to each '_' or '.', ngx_http_core_module being ngx, then ngx_http, then
+ * ngx_http_core. Prefixes are slices of the name itself.
+ * 
+ * @return size_t The number of levels (at least 1).
+ */
+
+static size_t bloat_path(const char *name, const char **comp, uint32_t *len) {
+  if (name[0] == '_' && name[1] == 'Z') {
+    size_t n = bloat_mangled(name, comp, len);
+
+    if (!n) {
+      comp[0] = bloat_global;
+      len[0] = sizeof(bloat_global) - 1;
+      n = 1;
+    }
+    return n;
+  }
+
+  const char *p = name;
+  size_t n = 0;
+
+  while (*p == '_' || *p == '.')
+    p++;
+  for (; *p && n < BLOAT_DEPTH; ++p) {
+    if ((*p == '_' || *p == '.') && p[1] && p[1] != '_' && p[1] != '.') {
+      comp[n] = name;
+      len[n++] = (uint32_t)(p - name);
+    }
+  }
+
+  if (!n) {
+    comp[0] = bloat_none;
+    len[0] = sizeof(bloat_none) - 1;
+    n = 1;
+  }
+  return n;
+}
+
+static inline __attribute__((always_inline)) uint32_t bloat_hash(uint32_t parent, const char *name, uint32_t len) {
+  uint64_t h = 0xcbf29ce484222325ull ^ parent;
+
+  for (uint32_t i = 0; i < len; ++i)
+    h = (h ^ (unsigned char)name[i]) * 0x100000001b3ull;
+  return (uint32_t)(h ^ (h >> 32));
+}
+
+/**
+ * @brief Resizes the hash table, the stored hashes say where everything goes.
+ * 
+ */
+
+static bool bloat_rehash(bloat_tree_t *tree, size_t size) {
+  uint64_t *slots = calloc(size, sizeof(uint64_t));
+
+  if (!slots)
+    return false;
+
+  for (size_t i = 0; tree->slots && i <= tree->mask; ++i) {
+    size_t slot = (tree->slots[i] >> 32) & (size - 1);
+
+    if (!tree->slots[i])
+      continue;
+    while (slots[slot])
+      slot = (slot + 1) & (size - 1);
+    slots[slot] = tree->slots[i];
+  }
+
+  free(tree->slots);
+  tree->slots = slots;
+  tree->mask = size - 1;
+  return true;
+}
+
+/**
+ * @brief Finds the child of `parent` with this name, adding it if needed.
+ * 
+ * @return uint32_t The node index, 0 if we ran out of memory.
+ */
+
+static uint32_t bloat_child(bloat_tree_t *tree, uint32_t parent, const char *name, uint32_t len) {
+  uint64_t hash = bloat_hash(parent, name, len);
+  size_t slot = hash & tree->mask;
+
+  for (; tree->slots[slot]; slot = (slot + 1) & tree->mask) {
+    /* the hash is checked first, most probes never touch the node */
+    if ((tree->slots[slot] >> 32) != hash)
+      continue;
+
+    uint32_t index = (uint32_t)tree->slots[slot] - 1;
+    const bloat_node_t *node = &tree->nodes[index];
+
+    if (node->parent == parent && node->len == len && !memcmp(node->name, name, len))
+      return index;
+  }
+
+  if (tree->count == tree->capacity) {
+    size_t n = tree->capacity * 2;
+    bloat_node_t *tmp = realloc(tree->nodes, n * sizeof(bloat_node_t));
+
+    if (!tmp)
+      return 0;
+    tree->nodes = tmp;
+    tree->capacity = n;
+  }
+
+  uint32_t index = (uint32_t)tree->count++;
+
+  tree->nodes[index] = (bloat_node_t){name, len, parent, 0, 0, tree->nodes[parent].depth + 1};
+  tree->slots[slot] = (hash << 32) | (index + 1);
+
+  if (tree->count * 2 > tree->mask + 1 && !bloat_rehash(tree, (tree->mask + 1) * 2))
+    return 0;
+  return index;
+}
+
+/**
+ * @brief Adds a symbol to its node and every node above it.
+ * 
+ */
+
+static bool bloat_add(bloat_tree_t *tree, const char *name, uint64_t size) {
+  const char *comp[BLOAT_DEPTH + 1];
+  uint32_t len[BLOAT_DEPTH + 1];
+  size_t levels = bloat_path(name, comp, len);
+  uint32_t node = 0;
+
+  tree->nodes[0].size += size;
+  tree->nodes[0].count++;
+  for (size_t i = 0; i < levels; ++i) {
+    if (!(node = bloat_child(tree, node, comp[i], len[i])))
+      return false;
+    tree->nodes[node].size += size;
+    tree->nodes[node].count++;
+  }
+  return true;
+}
+
+static int bloat_range_cmp(const void *x, const void *y) {
+  const bloat_range_t *a = x, *b = y;
+
+  return (a->start > b->start) - (a->start < b->start);
+}
+
+/**
+ * @brief Bytes of a section inside at least one symbol, sorting its ranges.
+ * 
+ */
+
+static uint64_t bloat_covered(bloat_range_t *ranges, size_t count) {
+  uint64_t covered = 0, end = 0;
+  bool sorted = true;
+
+  for (size_t i = 1; i < count && sorted; ++i)
+    sorted = ranges[i - 1].start <= ranges[i].start;
+  if (!sorted)
+    qsort(ranges, count, sizeof(bloat_range_t), bloat_range_cmp);
+
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t start = (ranges[i].start > end) ? ranges[i].start : end;
+
+    if (ranges[i].end > start) {
+      covered += ranges[i].end - start;
+      end = ranges[i].end;
+    }
+  }
+  return covered;
+}
+
+/**
+ * @brief Walks the symbol table once: section totals, coverage and the name tree.
+ * 
+ * The ranges are bucketed by section with a counting sort into a single
+ * array, nodes live in one growing array; nothing is allocated per symbol.
+ * 
+ * @return bool false if we ran out of memory.
+ */
+
+static bool bloat_symbols(elf_t *elf, bloat_section_t *sections, bloat_tree_t *tree) {
+  int table = elf_symbol_table(elf);
+
+  if (table == -1)
+    return true;
+
+  const Elf64_Shdr *shdr = &elf->elf_section_header[table];
+  const Elf64_Sym *syms = (const Elf64_Sym *)elf_section_table(elf, table);
+  const char *strtab = elf_section_data(elf, shdr->sh_link);
+  uint64_t strsize = elf->elf_section_header[shdr->sh_link].sh_size;
+  size_t sym_num = shdr->sh_size / shdr->sh_entsize;
+  uint16_t shnum = elf->elf_header->e_shnum;
+
+  if (!syms || !strtab)
+    return true;
+
+  size_t slots = 1024;
+
+  /* sized for a node per symbol up front, that saves most of the rehashes */
+  while (slots < sym_num * 2 && slots < ((size_t)1 << 31))
+    slots *= 2;
+  if (slots > tree->mask + 1 && !bloat_rehash(tree, slots))
+    return false;
+
+  size_t *start = calloc(shnum + 1, sizeof(size_t));
+  bloat_range_t *ranges = malloc((sym_num ? sym_num : 1) * sizeof(bloat_range_t));
+  bool ok = start && ranges;
+
+  for (size_t j = 0; ok && j < sym_num; ++j) {
+    const Elf64_Sym *sym = &syms[j];
+    unsigned char type = ELF64_ST_TYPE(sym->st_info);
+
+    if (!sym->st_size || !sym->st_shndx || sym->st_shndx >= shnum || type == STT_SECTION || type == STT_FILE)
+      continue;
+
+    start[sym->st_shndx + 1]++;
+    sections[sym->st_shndx].symbols += sym->st_size;
+    ok = bloat_add(tree, elf_string(strtab, strsize, sym->st_name), sym->st_size);
+  }
+
+  if (ok) {
+    for (uint16_t i = 1; i <= shnum; ++i)
+      start[i] += start[i - 1];
+
+    for (size_t j = 0; j < sym_num; ++j) {
+      const Elf64_Sym *sym = &syms[j];
+      unsigned char type = ELF64_ST_TYPE(sym->st_info);
+
+      if (!sym->st_size || !sym->st_shndx || sym->st_shndx >= shnum || type == STT_SECTION || type == STT_FILE)
+        continue;
+
+      /* st_value is an address, or an offset into the section in relocatables */
+      const Elf64_Shdr *sec = &elf->elf_section_header[sym->st_shndx];
+      uint64_t base = (elf->elf_header->e_type == ET_REL) ? 0 : sec->sh_addr;
+      uint64_t from = sym->st_value - base, to = from + sym->st_size;
+
+      if (sym->st_value < base)
+        from = to = 0;
+      else if (to < from)
+        to = UINT64_MAX;
+      ranges[start[sym->st_shndx]++] = (bloat_range_t){from, (to > sec->sh_size) ? sec->sh_size : to};
+    }
+
+    /* start[i] is now where section i ends */
+    for (uint16_t i = 1; i < shnum; ++i)
+      sections[i].covered = bloat_covered(ranges + start[i - 1], start[i] - start[i - 1]);
+  }
+
+  free(start);
+  free(ranges);
+  return ok;
+}
+
+static int bloat_section_cmp(const void *x, const void *y) {
+  const bloat_section_t *a = x, *b = y;
+  uint64_t sa = (a->file > a->vm) ? a->file : a->vm;
+  uint64_t sb = (b->file > b->vm) ? b->file : b->vm;
+
+  if (sa != sb)
+    return (sa < sb) ? 1 : -1;
+  return a->index - b->index;
+}
+
+static void bloat_section_row(out_t *out, const char *name, const bloat_section_t *sec,
+                              uint64_t size, uint64_t vm_size, uint64_t unattributed) {
+  out_pad(out, name, 20, OUT_LEFT | OUT_TRUNC);
+  out_char(out, ' ');
+  out_udec(out, sec->file, 12, 0);
+  bloat_percent(out, sec->file, size, 8);
+  out_char(out, ' ');
+  out_udec(out, sec->vm, 12, 0);
+  bloat_percent(out, sec->vm, vm_size, 8);
+  out_char(out, ' ');
+  out_udec(out, sec->symbols, 12, 0);
+  out_char(out, ' ');
+  out_udec(out, unattributed, 12, 0);
+  out_char(out, '\n');
+}
+
+/**
+ * @brief Lists the biggest children of a node, and theirs, down to BLOAT_DEPTH.
+ * 
+ * @param kids The children of every node, those of node n at kids[first[n]..first[n + 1]).
+ */
+
+static void bloat_dump_node(out_t *out, const bloat_tree_t *tree, uint32_t *kids, const size_t *first, uint32_t node) {
+  uint32_t *k = kids + first[node];
+  size_t count = first[node + 1] - first[node];
+  size_t shown = (count > BLOAT_TOP) ? BLOAT_TOP : count;
+  uint64_t rest = tree->nodes[node].size, rest_count = tree->nodes[node].count;
+
+  for (size_t i = 0; i < shown; ++i) {
+    /* a partial selection sort, only the first BLOAT_TOP are ever ordered */
+    size_t best = i;
+
+    for (size_t j = i + 1; j < count; ++j) {
+      const bloat_node_t *a = &tree->nodes[k[j]], *b = &tree->nodes[k[best]];
+
+      if (a->size > b->size || (a->size == b->size && k[j] < k[best]))
+        best = j;
+    }
+
+    uint32_t tmp = k[i];
+
+    k[i] = k[best];
+    k[best] = tmp;
+
+    const bloat_node_t *child = &tree->nodes[k[i]];
+
+    out_udec(out, child->size, 12, 0);
+    bloat_percent(out, child->size, tree->nodes[0].size, 8);
+    out_char(out, ' ');
+    out_udec(out, child->count, 10, 0);
+    out_char(out, ' ');
+    for (uint32_t d = 1; d < child->depth; ++d)
+      out_str(out, "  ");
+    out_write(out, child->name, child->len);
+    out_char(out, '\n');
+
+    rest -= child->size;
+    rest_count -= child->count;
+    if (child->depth < BLOAT_DEPTH)
+      bloat_dump_node(out, tree, kids, first, k[i]);
+  }
+
+  if (shown < count) {
+    out_udec(out, rest, 12, 0);
+    bloat_percent(out, rest, tree->nodes[0].size, 8);
+    out_char(out, ' ');
+    out_udec(out, rest_count, 10, 0);
+    out_char(out, ' ');
+    for (uint32_t d = 0; d < tree->nodes[node].depth; ++d)
+      out_str(out, "  ");
+    out_str(out, "(");
+    out_udec(out, count - shown, 0, 0);
+    out_str(out, " more)\n");
+  }
+}
+
+/**
+ * @brief Outputs the symbol tree, the children of every node grouped with a counting sort.
+ * 
+ */
+
+static bool bloat_dump_tree(out_t *out, const bloat_tree_t *tree) {
+  size_t *first = calloc(tree->count + 1, sizeof(size_t));
+  uint32_t *kids = malloc(tree->count * sizeof(uint32_t));
+
+  if (!first || !kids) {
+    free(first);
+    free(kids);
+    return false;
+  }
+
+  for (size_t i = 1; i < tree->count; ++i)
+    first[tree->nodes[i].parent + 1]++;
+  for (size_t i = 1; i <= tree->count; ++i)
+    first[i] += first[i - 1];
+
+  size_t *next = malloc((tree->count + 1) * sizeof(size_t));
+
+  if (!next) {
+    free(first);
+    free(kids);
+    return false;
+  }
+  memcpy(next, first, (tree->count + 1) * sizeof(size_t));
+  for (size_t i = 1; i < tree->count; ++i)
+    kids[next[tree->nodes[i].parent]++] = (uint32_t)i;
+  free(next);
+
+  out_str(out, "\nSymbols by namespace or prefix, ");
+  out_udec(out, tree->nodes[0].size, 0, 0);
+  out_str(out, " bytes in ");
+  out_udec(out, tree->nodes[0].count, 0, 0);
+  out_str(out, " symbols:\n"
+               "        Size        %      Count Name\n");
+  bloat_dump_node(out, tree, kids, first, 0);
+
+  free(first);
+  free(kids);
+  return true;
+}
+
+/**
+ * @brief Tells where the bytes of a file go.
+ * 
+ * File and memory size are split over the sections (plus the ELF headers
+ * and whatever padding is left), each section over the symbols inside it,
+ * with the bytes no symbol covers reported as unattributed. The symbols
+ * are then rolled up by C++ namespace or name prefix into a tree, listing
+ * the BLOAT_TOP biggest entries of every level with their percentage.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void bloat_report(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  Elf64_Ehdr *ehdr = elf->elf_header;
+  bloat_section_t *sections = calloc(ehdr->e_shnum ? ehdr->e_shnum : 1, sizeof(bloat_section_t));
+  bloat_tree_t tree = {.capacity = 1024};
+  bloat_section_t headers = {0}, padding = {0};
+  uint64_t file_sum = 0, vm_sum = 0, vm_size = 0;
+
+  tree.nodes = malloc(tree.capacity * sizeof(bloat_node_t));
+  if (!sections || !tree.nodes || !bloat_rehash(&tree, 1024))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the struct!");
+  tree.nodes[0] = (bloat_node_t){"", 0, 0, 0, 0, 0};
+  tree.count = 1;
+
+  for (int i = 0; i < ehdr->e_phnum; ++i) {
+    if (elf->elf_program_header[i].p_type == PT_LOAD)
+      vm_size += elf->elf_program_header[i].p_memsz;
+  }
+
+  for (int i = 1; i < ehdr->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    sections[i].index = i;
+    sections[i].file = (shdr->sh_type == SHT_NOBITS) ? 0 : shdr->sh_size;
+    sections[i].vm = (shdr->sh_flags & SHF_ALLOC) ? shdr->sh_size : 0;
+    file_sum += sections[i].file;
+    vm_sum += sections[i].vm;
+  }
+  /* relocatables have no segments, what they would load is what the sections say */
+  if (!vm_size)
+    vm_size = vm_sum;
+
+  if (!bloat_symbols(elf, sections, &tree))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the symbols!");
+
+  headers.file = ehdr->e_ehsize + (uint64_t)ehdr->e_phnum * ehdr->e_phentsize
+               + (uint64_t)ehdr->e_shnum * ehdr->e_shentsize;
+  padding.file = (elf->size > file_sum + headers.file) ? elf->size - file_sum - headers.file : 0;
+  padding.vm = (vm_size > vm_sum) ? vm_size - vm_sum : 0;
+
+  out_str(out, "File size ");
+  out_udec(out, elf->size, 0, 0);
+  out_str(out, " bytes, memory size ");
+  out_udec(out, vm_size, 0, 0);
+  out_str(out, " bytes.\n\n"
+               "Section                      File       %       Memory       %      Symbols Unattributed\n");
+
+  if (ehdr->e_shnum > 1)
+    qsort(sections + 1, ehdr->e_shnum - 1, sizeof(bloat_section_t), bloat_section_cmp);
+  for (int i = 1; i < ehdr->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[sections[i].index];
+
+    bloat_section_row(out, elf_section_name(elf, shdr), &sections[i], elf->size, vm_size,
+                      (shdr->sh_size > sections[i].covered) ? shdr->sh_size - sections[i].covered : 0);
+  }
+  bloat_section_row(out, "[ELF headers]", &headers, elf->size, vm_size, headers.file);
+  bloat_section_row(out, "[padding]", &padding, elf->size, vm_size, padding.file > padding.vm ? padding.file : padding.vm);
+
+  if (tree.nodes[0].count && !bloat_dump_tree(out, &tree))
+    fprintf(file->err, "Failed to allocate memory for the symbol tree!\n");
+
+  free(tree.nodes);
+  free(tree.slots);
+  free(sections);
+}
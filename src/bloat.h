@@ -0,0 +1,42 @@
+#ifndef _BLOAT_H
+#define _BLOAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BLOAT_DEPTH 3   /* levels of namespaces or prefixes */
+#define BLOAT_TOP 10    /* rows listed under each level */
+
+typedef struct bloat_section {
+  int index;
+  uint64_t file;      /* bytes in the file */
+  uint64_t vm;        /* bytes in memory */
+  uint64_t symbols;   /* sum of the st_size of its symbols, aliases included */
+  uint64_t covered;   /* bytes inside at least one symbol */
+} bloat_section_t;
+
+typedef struct bloat_range {
+  uint64_t start;
+  uint64_t end;
+} bloat_range_t;
+
+typedef struct bloat_node {
+  const char *name;   /* not NUL terminated */
+  uint32_t len;
+  uint32_t parent;
+  uint64_t size;
+  uint32_t count;
+  uint32_t depth;
+} bloat_node_t;
+
+typedef struct bloat_tree {
+  bloat_node_t *nodes;  /* nodes[0] is the root */
+  size_t count;
+  size_t capacity;
+  uint64_t *slots;      /* open addressing on (parent, name): hash << 32 | node index + 1 */
+  size_t mask;
+} bloat_tree_t;
+
+void bloat_report(batch_file_t *file);
+
+#endif
@@ -0,0 +1,340 @@
+/**
+ * @file cache.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Persistent on-disk cache of the metadata parts of ELF files.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * 
+ * An entry holds the byte ranges of the file that the metadata dumps read
+ * (headers, section header table, symbol tables, their string tables, hash
+ * tables and notes), each stored page aligned. On a hit the entry is mapped
+ * back at the same offsets inside a PROT_NONE reservation the size of the
+ * original file, so elf_t and every handler work unchanged, and the original
+ * file is never read.
+ * 
+ * Entries are named after the NT_GNU_BUILD_ID note when there is one
+ * (bid-<hex>.ec). The key used for lookups is always dev/inode/size/mtime
+ * (st-<...>.ec), a symlink to the build-id entry when there is one, so
+ * copies of the same library share a single entry.
+ */
+
+#include "all.h"
+
+/**
+ * @brief Builds the dev/inode/size/mtime file name of an entry.
+ * 
+ * @param kind What the entry holds: "st" for parsed metadata, other
+ *             handlers keep indexes of their own next to them.
+ */
+
+void cache_entry_path(const char *dir, const char *kind, const struct stat *st, char *path, size_t len) {
+  snprintf(path, len, "%s/%s-%lx-%lx-%lx-%lx.%lx.ec",
+           dir,
+           kind,
+           (unsigned long)st->st_dev,
+           (unsigned long)st->st_ino,
+           (unsigned long)st->st_size,
+           (unsigned long)st->st_mtim.tv_sec,
+           (unsigned long)st->st_mtim.tv_nsec);
+}
+
+static bool cache_stat_path(const cache_t *cache, int fd, char *path, size_t len, struct stat *st) {
+  if (fstat(fd, st) == -1)
+    return false;
+
+  cache_entry_path(cache->dir, "st", st, path, len);
+  return true;
+}
+
+/**
+ * @brief Maps a cache entry back into a reservation the size of the original file.
+ * 
+ * @param cache A pointer to the cache.
+ * @param fd The original file, only fstat()ed.
+ * @return elf_t* The parsed file, NULL on a miss.
+ */
+
+elf_t *cache_open(cache_t *cache, int fd) {
+  char path[4096];
+  struct stat st;
+  cache_header_t hdr;
+  long page = sysconf(_SC_PAGESIZE);
+
+  if (!cache_stat_path(cache, fd, path, sizeof(path), &st))
+    return NULL;
+
+  int cfd = open(path, O_RDONLY);
+
+  if (cfd == -1) {
+    __atomic_fetch_add(&cache->misses, 1, __ATOMIC_RELAXED);
+    return NULL;
+  }
+
+  struct stat cst;
+  bool valid = fstat(cfd, &cst) != -1
+               && pread(cfd, &hdr, sizeof(hdr), 0) == sizeof(hdr)
+               && !memcmp(hdr.magic, CACHE_MAGIC, sizeof(hdr.magic))
+               && hdr.page_size == (uint32_t)page
+               && hdr.file_size == (uint64_t)st.st_size
+               && hdr.extents <= CACHE_MAX_EXTENTS;
+
+  for (uint32_t i = 0; valid && i < hdr.extents; ++i)
+    valid = hdr.extent[i].cache_offset + hdr.extent[i].length <= (uint64_t)cst.st_size
+            && hdr.extent[i].file_offset + hdr.extent[i].length <= ((hdr.file_size + page - 1) & ~(page - 1));
+
+  char *file = valid ? mmap(NULL, hdr.file_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+
+  for (uint32_t i = 0; file != MAP_FAILED && i < hdr.extents; ++i) {
+    if (mmap(file + hdr.extent[i].file_offset, hdr.extent[i].length, PROT_READ,
+             MAP_PRIVATE | MAP_FIXED, cfd, hdr.extent[i].cache_offset) == MAP_FAILED) {
+      munmap(file, hdr.file_size);
+      file = MAP_FAILED;
+    }
+  }
+  close(cfd);
+
+  elf_t *elf = NULL;
+
+  if (file != MAP_FAILED && elf_open_mapped(file, hdr.file_size, NULL, &elf) != ELF_OK)
+    munmap(file, hdr.file_size);
+
+  elf_extent_t resident[CACHE_MAX_EXTENTS];
+
+  for (uint32_t i = 0; elf && i < hdr.extents; ++i)
+    resident[i] = (elf_extent_t){.offset = hdr.extent[i].file_offset, .size = hdr.extent[i].length};
+
+  /* whatever the entry doesn't hold is PROT_NONE, make reads there fail rather than fault */
+  if (elf && !elf_set_resident(elf, resident, hdr.extents)) {
+    elf_close(elf);
+    elf = NULL;
+  }
+
+  if (!elf) {
+    __atomic_fetch_add(&cache->misses, 1, __ATOMIC_RELAXED);
+    return NULL;
+  }
+
+  __atomic_fetch_add(&cache->hits, 1, __ATOMIC_RELAXED);
+  return elf;
+}
+
+/**
+ * @brief Adds a page aligned [offset, offset + size) range to the entry, merging overlaps.
+ * 
+ */
+
+static void cache_add_extent(cache_header_t *hdr, uint64_t offset, uint64_t size, uint64_t page) {
+  uint64_t end = offset + size;
+
+  if (!size || offset >= hdr->file_size)
+    return;
+  if (end > hdr->file_size || end < offset)
+    end = hdr->file_size;
+
+  offset &= ~(page - 1);
+  end = (end + page - 1) & ~(page - 1);
+
+  for (uint32_t i = 0; i < hdr->extents; ++i) {
+    cache_extent_t *ext = &hdr->extent[i];
+
+    if (offset <= ext->file_offset + ext->length && end >= ext->file_offset) {
+      uint64_t lo = (offset < ext->file_offset) ? offset : ext->file_offset;
+      uint64_t hi = (end > ext->file_offset + ext->length) ? end : ext->file_offset + ext->length;
+
+      /* this one grew, it may now touch another one: take it out and retry */
+      hdr->extent[i] = hdr->extent[--hdr->extents];
+      cache_add_extent(hdr, lo, hi - lo, page);
+      return;
+    }
+  }
+
+  if (hdr->extents == CACHE_MAX_EXTENTS) {
+    /* out of slots, fold it into the last one */
+    cache_extent_t *ext = &hdr->extent[hdr->extents - 1];
+    uint64_t lo = (offset < ext->file_offset) ? offset : ext->file_offset;
+    uint64_t hi = (end > ext->file_offset + ext->length) ? end : ext->file_offset + ext->length;
+
+    --hdr->extents;
+    cache_add_extent(hdr, lo, hi - lo, page);
+    return;
+  }
+
+  hdr->extent[hdr->extents++] = (cache_extent_t){.file_offset = offset, .length = end - offset};
+}
+
+/**
+ * @brief Looks for the NT_GNU_BUILD_ID note and writes it out as hex.
+ * 
+ * @return bool false if the file has none.
+ */
+
+static bool cache_build_id(elf_t *elf, char *hex, size_t len) {
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    if (shdr->sh_type != SHT_NOTE)
+      continue;
+
+    const char *p = elf_section_data(elf, i), *end = p + shdr->sh_size;
+    elf_note_t note;
+
+    if (!p)
+      continue;
+
+    while (elf_note_next(elf, &p, end, shdr->sh_addralign, &note)) {
+      const unsigned char *desc = (const unsigned char *)note.desc;
+
+      if (note.type == NT_GNU_BUILD_ID && note.namesz == 4 && !memcmp(note.name, "GNU", 4)
+          && note.descsz && note.descsz * 2 < len) {
+        for (Elf64_Word j = 0; j < note.descsz; ++j)
+          snprintf(hex + j * 2, 3, "%02x", desc[j]);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Writes the entry for a file that was just parsed from disk.
+ * 
+ * The entry goes to a temporary file first and is renamed into place, so
+ * concurrent runs never see half an entry.
+ * 
+ * @param cache A pointer to the cache.
+ * @param fd The original file.
+ * @param elf The file, mapped from disk.
+ */
+
+void cache_store(cache_t *cache, int fd, elf_t *elf) {
+  char stat_path[4096], entry[4096], build_id[256], tmp[4096];
+  struct stat st;
+  uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+  cache_header_t hdr = {.page_size = (uint32_t)page};
+  Elf64_Ehdr *ehdr = elf->elf_header;
+
+  if (!cache_stat_path(cache, fd, stat_path, sizeof(stat_path), &st))
+    return;
+
+  bool has_id = cache_build_id(elf, build_id, sizeof(build_id));
+
+  if (has_id) {
+    /* stripped and unstripped builds share the id, but not the layout */
+    snprintf(entry, sizeof(entry), "%s/bid-%s-%lx.ec", cache->dir, build_id, (unsigned long)st.st_size);
+
+    /* same build somewhere else, share the entry */
+    if (!access(entry, R_OK)) {
+      symlink(strrchr(entry, '/') + 1, stat_path);
+      return;
+    }
+  } else {
+    snprintf(entry, sizeof(entry), "%s", stat_path);
+  }
+
+  memcpy(hdr.magic, CACHE_MAGIC, sizeof(hdr.magic));
+  hdr.file_size = st.st_size;
+
+  cache_add_extent(&hdr, 0, sizeof(Elf64_Ehdr), page);
+  cache_add_extent(&hdr, ehdr->e_phoff, (uint64_t)ehdr->e_phnum * ehdr->e_phentsize, page);
+  cache_add_extent(&hdr, ehdr->e_shoff, (uint64_t)ehdr->e_shnum * ehdr->e_shentsize, page);
+
+  for (int i = 0; i < ehdr->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    switch (shdr->sh_type) {
+      case SHT_REL:
+      case SHT_RELA:
+        /* -Rd names the symbols, keep the table sh_link points at and its strings */
+        if (shdr->sh_link && shdr->sh_link < ehdr->e_shnum) {
+          const Elf64_Shdr *symtab = &elf->elf_section_header[shdr->sh_link];
+
+          cache_add_extent(&hdr, symtab->sh_offset, symtab->sh_size, page);
+          if (symtab->sh_link < ehdr->e_shnum)
+            cache_add_extent(&hdr, elf->elf_section_header[symtab->sh_link].sh_offset,
+                             elf->elf_section_header[symtab->sh_link].sh_size, page);
+        }
+        cache_add_extent(&hdr, shdr->sh_offset, shdr->sh_size, page);
+        break;
+      case SHT_RELR:
+        cache_add_extent(&hdr, shdr->sh_offset, shdr->sh_size, page);
+        break;
+      case SHT_SYMTAB:
+      case SHT_DYNSYM:
+        if (shdr->sh_link < ehdr->e_shnum)
+          cache_add_extent(&hdr, elf->elf_section_header[shdr->sh_link].sh_offset,
+                           elf->elf_section_header[shdr->sh_link].sh_size, page);
+        /* fall through */
+      case SHT_HASH:
+      case SHT_GNU_HASH:
+      case SHT_NOTE:
+        cache_add_extent(&hdr, shdr->sh_offset, shdr->sh_size, page);
+        break;
+      default:
+        if (i == ehdr->e_shstrndx)
+          cache_add_extent(&hdr, shdr->sh_offset, shdr->sh_size, page);
+        break;
+    }
+  }
+
+  uint64_t offset = (sizeof(hdr) + page - 1) & ~(page - 1);
+
+  for (uint32_t i = 0; i < hdr.extents; ++i) {
+    hdr.extent[i].cache_offset = offset;
+    offset += hdr.extent[i].length;
+  }
+
+  snprintf(tmp, sizeof(tmp), "%s/.tmp-XXXXXX", cache->dir);
+
+  int cfd = mkstemp(tmp);
+
+  if (cfd == -1)
+    return;
+
+  bool ok = !fchmod(cfd, 0644) && pwrite(cfd, &hdr, sizeof(hdr), 0) == sizeof(hdr);
+
+  for (uint32_t i = 0; ok && i < hdr.extents; ++i) {
+    /* the tail of the last page may be past the end of the file */
+    uint64_t len = hdr.extent[i].length;
+
+    if (hdr.extent[i].file_offset + len > hdr.file_size)
+      len = hdr.file_size - hdr.extent[i].file_offset;
+    const char *data = elf_read(elf, hdr.extent[i].file_offset, len);
+
+    ok = data && pwrite(cfd, data, len, hdr.extent[i].cache_offset) == (ssize_t)len;
+  }
+  ok = ok && !ftruncate(cfd, offset);
+  close(cfd);
+
+  if (!ok || rename(tmp, entry)) {
+    unlink(tmp);
+    return;
+  }
+
+  if (has_id)
+    symlink(strrchr(entry, '/') + 1, stat_path);
+  __atomic_fetch_add(&cache->stores, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Prints the hit/miss counters to stderr.
+ * 
+ */
+
+void cache_report(const cache_t *cache) {
+  fprintf(stderr, "cache: %lu hits, %lu misses, %lu entries written\n",
+          cache->hits, cache->misses, cache->stores);
+}
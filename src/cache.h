@@ -0,0 +1,36 @@
+#ifndef _CACHE_H
+#define _CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CACHE_MAGIC "ELFIEC02"
+#define CACHE_MAX_EXTENTS 64
+
+typedef struct cache_extent {
+  uint64_t file_offset;
+  uint64_t length;
+  uint64_t cache_offset;
+} cache_extent_t;
+
+typedef struct cache_header {
+  char magic[8];
+  uint32_t page_size;
+  uint32_t extents;
+  uint64_t file_size;
+  cache_extent_t extent[CACHE_MAX_EXTENTS];
+} cache_header_t;
+
+typedef struct cache {
+  const char *dir;
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long stores;
+} cache_t;
+
+void cache_entry_path(const char *dir, const char *kind, const struct stat *st, char *path, size_t len);
+elf_t *cache_open(cache_t *cache, int fd);
+void cache_store(cache_t *cache, int fd, elf_t *elf);
+void cache_report(const cache_t *cache);
+
+#endif
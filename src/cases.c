@@ -453,158 +453,581 @@ static const char *get_symbol_vis(unsigned int vis) {
   }
 }
 
+/**
+ * @brief Outputs one "label:   value" line of the ELF header.
+ * 
+ * @param out The output buffer.
+ * @param label The label, padded to the value column.
+ * @param value The value.
+ */
+
+static void header_str(out_t *out, const char *label, const char *value) {
+  out_pad(out, label, 48, OUT_LEFT);
+  out_str(out, value);
+  out_char(out, '\n');
+}
+
+/**
+ * @brief Same as header_str(), for decimal values.
+ * 
+ */
+
+static void header_dec(out_t *out, const char *label, uint64_t value) {
+  out_pad(out, label, 48, OUT_LEFT);
+  out_udec(out, value, 0, 0);
+  out_char(out, '\n');
+}
+
+/**
+ * @brief Same as header_str(), for 0x prefixed hex values.
+ * 
+ */
+
+static void header_hex(out_t *out, const char *label, uint64_t value) {
+  out_pad(out, label, 48, OUT_LEFT);
+  out_write(out, "0x", 2);
+  out_hex(out, value, 0, 0, 0);
+  out_char(out, '\n');
+}
+
+/**
+ * @brief Starts the document of one file (JSON), NDJSON has none.
+ * 
+ * @param file The file, and where its output goes.
+ * @param json The writer to set up.
+ * @param key The name of the array the rows go in, NULL if there is none.
+ */
+
+static void json_doc_begin(const batch_file_t *file, json_t *json, const char *key) {
+  json_init(json, file->out);
+  if (file->format != OUT_JSON)
+    return;
+
+  json_open(json, NULL, '{');
+  json_str(json, "file", file->path);
+  if (key)
+    json_open(json, key, '[');
+}
+
+/**
+ * @brief Ends what json_doc_begin() started.
+ * 
+ */
+
+static void json_doc_end(const batch_file_t *file, json_t *json, const char *key) {
+  if (file->format != OUT_JSON)
+    return;
+
+  if (key)
+    json_close(json, ']');
+  json_close(json, '}');
+  out_char(file->out, '\n');
+}
+
+/**
+ * @brief Starts a row: an array member with JSON, a line of its own with NDJSON.
+ * 
+ * NDJSON rows carry the file name and what kind of row they are, so they
+ * can be told apart without any context.
+ */
+
+static void json_row_begin(const batch_file_t *file, json_t *json, const char *key, const char *kind) {
+  json_open(json, (file->format == OUT_JSON) ? key : NULL, '{');
+  if (file->format == OUT_NDJSON) {
+    json_str(json, "file", file->path);
+    json_str(json, "kind", kind);
+  }
+}
+
+/**
+ * @brief Ends what json_row_begin() started.
+ * 
+ */
+
+static void json_row_end(const batch_file_t *file, json_t *json) {
+  json_close(json, '}');
+  if (file->format == OUT_NDJSON)
+    out_char(file->out, '\n');
+}
+
+/**
+ * @brief Outputs the ELF header as JSON.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+static void dump_elf_header_json(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  static const char hex[] = "0123456789abcdef";
+  Elf64_Ehdr *ehdr = elf->elf_header;
+  char ident[EI_NIDENT * 2 + 1];
+  json_t json;
+
+  for (int i = 0; i < EI_NIDENT; ++i) {
+    ident[i * 2] = hex[ehdr->e_ident[i] >> 4];
+    ident[i * 2 + 1] = hex[ehdr->e_ident[i] & 0xf];
+  }
+  ident[EI_NIDENT * 2] = '\0';
+
+  json_doc_begin(file, &json, NULL);
+  json_row_begin(file, &json, "header", "header");
+  json_str(&json, "ident", ident);
+  json_str(&json, "class", get_storage_class(elf));
+  json_str(&json, "data", get_data_encoding(elf));
+  json_uint(&json, "ident_version", ehdr->e_ident[EI_VERSION]);
+  json_str(&json, "osabi", get_os_abi(elf));
+  json_uint(&json, "abi_version", ehdr->e_ident[EI_ABIVERSION]);
+  json_uint(&json, "type", ehdr->e_type);
+  json_str(&json, "type_name", get_file_type(elf));
+  json_uint(&json, "machine", ehdr->e_machine);
+  json_str(&json, "machine_name", get_machine_name(elf));
+  json_uint(&json, "version", ehdr->e_version);
+  json_uint(&json, "entry", ehdr->e_entry);
+  json_uint(&json, "phoff", ehdr->e_phoff);
+  json_uint(&json, "shoff", ehdr->e_shoff);
+  json_uint(&json, "flags", ehdr->e_flags);
+  json_uint(&json, "ehsize", ehdr->e_ehsize);
+  json_uint(&json, "phentsize", ehdr->e_phentsize);
+  json_uint(&json, "phnum", ehdr->e_phnum);
+  json_uint(&json, "shentsize", ehdr->e_shentsize);
+  json_uint(&json, "shnum", ehdr->e_shnum);
+  json_uint(&json, "shstrndx", ehdr->e_shstrndx);
+  json_row_end(file, &json);
+  json_doc_end(file, &json, NULL);
+}
+
+/**
+ * @brief Outputs the program headers as JSON.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+static void dump_program_headers_json(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  json_t json;
+
+  json_doc_begin(file, &json, "program_headers");
+  for (int i = 0; i < elf->elf_header->e_phnum; ++i) {
+    Elf64_Phdr *phdr = &elf->elf_program_header[i];
+
+    json_row_begin(file, &json, NULL, "program_header");
+    json_uint(&json, "index", i);
+    json_uint(&json, "type", phdr->p_type);
+    json_str(&json, "type_name", get_program_type(phdr->p_type));
+    json_uint(&json, "offset", phdr->p_offset);
+    json_uint(&json, "vaddr", phdr->p_vaddr);
+    json_uint(&json, "paddr", phdr->p_paddr);
+    json_uint(&json, "filesz", phdr->p_filesz);
+    json_uint(&json, "memsz", phdr->p_memsz);
+    json_uint(&json, "flags", phdr->p_flags);
+    json_uint(&json, "align", phdr->p_align);
+    json_row_end(file, &json);
+  }
+  json_doc_end(file, &json, "program_headers");
+}
+
+/**
+ * @brief Outputs the section headers as JSON.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+static void dump_section_headers_json(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  json_t json;
+
+  json_doc_begin(file, &json, "sections");
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    json_row_begin(file, &json, NULL, "section");
+    json_uint(&json, "index", i);
+    json_str(&json, "name", elf_section_name(elf, shdr));
+    json_uint(&json, "type", shdr->sh_type);
+    json_str(&json, "type_name", get_section_type(shdr->sh_type));
+    json_uint(&json, "addr", shdr->sh_addr);
+    json_uint(&json, "offset", shdr->sh_offset);
+    json_uint(&json, "size", shdr->sh_size);
+    json_uint(&json, "entsize", shdr->sh_entsize);
+    json_uint(&json, "flags", shdr->sh_flags);
+    json_uint(&json, "link", shdr->sh_link);
+    json_uint(&json, "info", shdr->sh_info);
+    json_uint(&json, "align", shdr->sh_addralign);
+    json_row_end(file, &json);
+  }
+  json_doc_end(file, &json, "sections");
+}
+
+/**
+ * @brief Outputs every symbol table as JSON, one row per symbol.
+ * 
+ * With JSON the symbols are grouped per table, with NDJSON each row names
+ * its table instead.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+static void dump_symbol_table_json(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  json_t json;
+
+  json_doc_begin(file, &json, "symbol_tables");
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    if ((shdr->sh_type != SHT_SYMTAB && shdr->sh_type != SHT_DYNSYM) || !shdr->sh_entsize)
+      continue;
+
+    const Elf64_Sym *syms = (const Elf64_Sym *)elf_section_table(elf, i);
+    const char *strtab = elf_section_data(elf, shdr->sh_link);
+    const char *table = elf_section_name(elf, shdr);
+    size_t sym_num = shdr->sh_size / shdr->sh_entsize;
+
+    if (!syms || !strtab)
+      continue;
+
+    uint64_t strsize = elf->elf_section_header[shdr->sh_link].sh_size;
+
+    if (file->format == OUT_JSON) {
+      json_open(&json, NULL, '{');
+      json_str(&json, "name", table);
+      json_uint(&json, "entries", sym_num);
+      json_open(&json, "symbols", '[');
+    }
+
+    for (size_t j = 0; j < sym_num; ++j) {
+      json_row_begin(file, &json, NULL, "symbol");
+      if (file->format == OUT_NDJSON)
+        json_str(&json, "table", table);
+      json_uint(&json, "index", j);
+      json_str(&json, "name", elf_string(strtab, strsize, syms[j].st_name));
+      json_uint(&json, "value", syms[j].st_value);
+      json_uint(&json, "size", syms[j].st_size);
+      json_str(&json, "type", get_symbol_type(syms[j].st_info));
+      json_str(&json, "bind", get_symbol_bind(syms[j].st_info));
+      json_str(&json, "visibility", get_symbol_vis(syms[j].st_other));
+      json_uint(&json, "shndx", syms[j].st_shndx);
+      json_row_end(file, &json);
+    }
+
+    if (file->format == OUT_JSON) {
+      json_close(&json, ']');
+      json_close(&json, '}');
+    }
+  }
+  json_doc_end(file, &json, "symbol_tables");
+}
+
 /**
  * @brief Outputs the content of the ELF header.
  * 
- * @param elf A pointer to the struct.
+ * @param file The file, and where its output goes.
+ */
+
+void dump_elf_header(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  Elf64_Ehdr *ehdr = elf->elf_header;
+  out_t *out = file->out;
+
+  if (file->format != OUT_TEXT) {
+    dump_elf_header_json(file);
+    return;
+  }
+
+  out_str(out, "ELF Header:\nMagic: ");
+
+  for (int i = 0; i < EI_NIDENT; ++i) {
+    out_hex(out, ehdr->e_ident[i], 2, 0, 0);
+    out_char(out, ' ');
+  }
+  out_char(out, '\n');
+
+  header_str(out, "Class:", get_storage_class(elf));
+  header_str(out, "Data:", get_data_encoding(elf));
+  header_dec(out, "Version:", ehdr->e_ident[EI_VERSION]);
+  header_str(out, "OS/ABI:", get_os_abi(elf));
+  header_dec(out, "ABI Version:", ehdr->e_ident[EI_ABIVERSION]);
+  header_str(out, "Type:", get_file_type(elf));
+  header_str(out, "Machine:", get_machine_name(elf));
+  header_hex(out, "Version:", ehdr->e_version);
+  header_hex(out, "Entry:", ehdr->e_entry);
+  header_dec(out, "Program header table offset:", ehdr->e_phoff);
+  header_dec(out, "Section header table offset:", ehdr->e_shoff);
+  header_hex(out, "Flags:", ehdr->e_flags);
+  header_dec(out, "ELF header size:", ehdr->e_ehsize);
+  header_dec(out, "ELF entry size:", ehdr->e_phentsize);
+  header_dec(out, "Number of ELF entries:", ehdr->e_phnum);
+  header_dec(out, "Section header size:", ehdr->e_shentsize);
+  header_dec(out, "Number of entries in section header table:", ehdr->e_shnum);
+  header_dec(out, "Section header string table index:", ehdr->e_shstrndx);
+}
+
+/**
+ * @brief Outputs the file type and machine on one line, for scans.
+ * 
+ * @param file The file, and where its output goes.
  */
 
-void dump_elf_header(elf_t *elf) {
-  puts("ELF Header:");
-  printf("Magic: ");
-
-  for (int i = 0; i < EI_NIDENT; ++i)
-    printf("%2.2x ", elf->elf_header->e_ident[i]);
-  putchar('\n');
-
-  printf("Class:                                          %s\n"
-         "Data:                                           %s\n"
-         "Version:                                        %d\n"
-         "OS/ABI:                                         %s\n"
-         "ABI Version:                                    %d\n"
-         "Type:                                           %s\n"
-         "Machine:                                        %s\n"
-         "Version:                                        0x%x\n"
-         "Entry:                                          0x%lx\n"
-         "Program header table offset:                    %lu\n"
-         "Section header table offset:                    %lu\n"
-         "Flags:                                          0x%x\n"
-         "ELF header size:                                %u\n"
-         "ELF entry size:                                 %u\n"
-         "Number of ELF entries:                          %u\n"
-         "Section header size:                            %u\n"
-         "Number of entries in section header table:      %u\n"
-         "Section header string table index:              %u\n",
-         get_storage_class(elf),
-         get_data_encoding(elf),
-         elf->elf_header->e_ident[EI_VERSION],
-         get_os_abi(elf),
-         elf->elf_header->e_ident[EI_ABIVERSION],
-         get_file_type(elf),
-         get_machine_name(elf),
-         elf->elf_header->e_version,
-         elf->elf_header->e_entry,
-         elf->elf_header->e_phoff,
-         elf->elf_header->e_shoff,
-         elf->elf_header->e_flags,
-         elf->elf_header->e_ehsize,
-         elf->elf_header->e_phentsize,
-         elf->elf_header->e_phnum,
-         elf->elf_header->e_shentsize,
-         elf->elf_header->e_shnum,
-         elf->elf_header->e_shstrndx
-  );
+void dump_elf_summary(batch_file_t *file) {
+  elf_t *elf = file->elf;
+
+  out_str(file->out, get_file_type(elf));
+  out_write(file->out, ", ", 2);
+  out_str(file->out, get_machine_name(elf));
+  out_char(file->out, '\n');
 }
 
 /**
  * @brief Outputs the content of the program header.
  * 
- * @param elf A pointer to the struct.
+ * @param file The file, and where its output goes.
  */
 
-void dump_program_headers(elf_t *elf) {
-  printf("ELF file type is %s\n"
-         "Entry point is 0x%lx\n"
-         "There are %d program headers, starting at offset %ld\n\n",
-         get_file_type(elf),
-         elf->elf_header->e_entry,
-         elf->elf_header->e_phnum,
-         elf->elf_header->e_phoff
-  );
+void dump_program_headers(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
 
-  puts("Program headers:\n"
-       "Type          Offset    VirtAddr    PhysAddr    FileSiz   MemSiz   Flags    Align\n");
+  if (file->format != OUT_TEXT) {
+    dump_program_headers_json(file);
+    return;
+  }
+
+  out_str(out, "ELF file type is ");
+  out_str(out, get_file_type(elf));
+  out_str(out, "\nEntry point is 0x");
+  out_hex(out, elf->elf_header->e_entry, 0, 0, 0);
+  out_str(out, "\nThere are ");
+  out_udec(out, elf->elf_header->e_phnum, 0, 0);
+  out_str(out, " program headers, starting at offset ");
+  out_sdec(out, (int64_t)elf->elf_header->e_phoff, 0, 0);
+  out_str(out, "\n\nProgram headers:\n"
+               "Type          Offset    VirtAddr    PhysAddr    FileSiz   MemSiz   Flags    Align\n\n");
 
   for (int i = 0; i < elf->elf_header->e_phnum; ++i) {
-    printf("%-14.14s", get_program_type(elf->elf_program_header[i].p_type));
-    printf("0x%6.6lx  0x%8.8lx  0x%8.8lx  0x%5.5lx   0x%5.5lx  %-2s       0x%lx\n",
-           elf->elf_program_header[i].p_offset,
-           elf->elf_program_header[i].p_vaddr,
-           elf->elf_program_header[i].p_paddr,
-           elf->elf_program_header[i].p_filesz,
-           elf->elf_program_header[i].p_memsz,
-           get_program_flags(elf->elf_program_header[i].p_flags),
-           elf->elf_program_header[i].p_align
-    );
+    Elf64_Phdr *phdr = &elf->elf_program_header[i];
+
+    out_pad(out, get_program_type(phdr->p_type), 14, OUT_LEFT | OUT_TRUNC);
+    out_write(out, "0x", 2);
+    out_hex(out, phdr->p_offset, 6, 0, 0);
+    out_write(out, "  0x", 4);
+    out_hex(out, phdr->p_vaddr, 8, 0, 0);
+    out_write(out, "  0x", 4);
+    out_hex(out, phdr->p_paddr, 8, 0, 0);
+    out_write(out, "  0x", 4);
+    out_hex(out, phdr->p_filesz, 5, 0, 0);
+    out_write(out, "   0x", 5);
+    out_hex(out, phdr->p_memsz, 5, 0, 0);
+    out_write(out, "  ", 2);
+    out_pad(out, get_program_flags(phdr->p_flags), 2, OUT_LEFT);
+    out_write(out, "       0x", 9);
+    out_hex(out, phdr->p_align, 0, 0, 0);
+    out_char(out, '\n');
   }
 }
 
 /**
  * @brief Dumps the section headers.
  * 
- * @param elf A pointer to the struct.
+ * @param file The file, and where its output goes.
  */
 
-void dump_section_headers(elf_t *elf) {
-  printf("There are %d section headers, starting at offset 0x%ld\n\n",
-          elf->elf_header->e_shnum,
-          elf->elf_header->e_shoff);
-  
+void dump_section_headers(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+
+  if (file->format != OUT_TEXT) {
+    dump_section_headers_json(file);
+    return;
+  }
+
+  out_str(out, "There are ");
+  out_udec(out, elf->elf_header->e_shnum, 0, 0);
+  out_str(out, " section headers, starting at offset 0x");
+  out_sdec(out, (int64_t)elf->elf_header->e_shoff, 0, 0);
+  out_str(out, "\n\n");
+
   if (elf->elf_header->e_shnum == 1)
-    puts("Section Header:");
+    out_str(out, "Section Header:\n");
   else
-    puts("Section Headers:");
-  
-  puts("[Nr] Name                Type              Address   Offset    Size    EntSize   Flags              Link    Info    Align");
+    out_str(out, "Section Headers:\n");
+
+  out_str(out, "[Nr] Name                Type              Address   Offset    Size    EntSize   Flags              Link    Info    Align\n");
 
   for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
-    printf(" %-3d %-19s %-17s 0x%-7lx 0x%6.6lx  %6.6lx  %-9.2lx %-18s %-7u %-6u %2lu\n",
-           i,
-           elf->elf_section_header[i].sh_name + elf->string_table,
-           get_section_type(elf->elf_section_header[i].sh_type),
-           elf->elf_section_header[i].sh_addr,
-           elf->elf_section_header[i].sh_offset,
-           elf->elf_section_header[i].sh_size,
-           elf->elf_section_header[i].sh_entsize,
-           get_section_flags(elf->elf_section_header[i].sh_flags),
-           elf->elf_section_header[i].sh_link,
-           elf->elf_section_header[i].sh_info,
-           elf->elf_section_header[i].sh_addralign
-    );
+    Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    out_char(out, ' ');
+    out_sdec(out, i, 3, OUT_LEFT);
+    out_char(out, ' ');
+    out_pad(out, elf_section_name(elf, shdr), 19, OUT_LEFT);
+    out_char(out, ' ');
+    out_pad(out, get_section_type(shdr->sh_type), 17, OUT_LEFT);
+    out_write(out, " 0x", 3);
+    out_hex(out, shdr->sh_addr, 0, 7, OUT_LEFT);
+    out_write(out, " 0x", 3);
+    out_hex(out, shdr->sh_offset, 6, 0, 0);
+    out_write(out, "  ", 2);
+    out_hex(out, shdr->sh_size, 6, 0, 0);
+    out_write(out, "  ", 2);
+    out_hex(out, shdr->sh_entsize, 2, 9, OUT_LEFT);
+    out_char(out, ' ');
+    out_pad(out, get_section_flags(shdr->sh_flags), 18, OUT_LEFT);
+    out_char(out, ' ');
+    out_udec(out, shdr->sh_link, 7, OUT_LEFT);
+    out_char(out, ' ');
+    out_udec(out, shdr->sh_info, 6, OUT_LEFT);
+    out_char(out, ' ');
+    out_udec(out, shdr->sh_addralign, 2, 0);
+    out_char(out, '\n');
+  }
+}
+
+/**
+ * @brief Outputs a single row of a symbol table.
+ * 
+ * @param out The output buffer.
+ * @param index The index of the symbol in its table.
+ * @param sym The symbol.
+ * @param name Its name, out of elf_string().
+ */
+
+void dump_symbol_row(out_t *out, size_t index, const Elf64_Sym *sym, const char *name) {
+  out_udec(out, index, 5, OUT_LEFT);
+  out_char(out, ' ');
+  out_sdec(out, (int64_t)sym->st_value, 6, OUT_LEFT);
+  out_write(out, " 0x", 3);
+  out_hex(out, sym->st_size, 0, 3, OUT_LEFT);
+  out_char(out, ' ');
+  out_pad(out, get_symbol_type(sym->st_info), 12, OUT_LEFT);
+  out_char(out, ' ');
+  out_pad(out, get_symbol_bind(sym->st_info), 14, OUT_LEFT);
+  out_char(out, ' ');
+  out_pad(out, get_symbol_vis(sym->st_other), 12, OUT_LEFT);
+  out_char(out, ' ');
+  out_udec(out, sym->st_shndx, 10, OUT_LEFT);
+  out_char(out, ' ');
+  out_str(out, name);
+  out_char(out, '\n');
+}
+
+/**
+ * @brief Renders one chunk of rows, then writes out every chunk that is next in line.
+ * 
+ * A chunk waits for its slot of the ring to be written out first, so no
+ * more than `slots` chunks are ever held.
+ */
+
+static void dump_symbol_chunk(size_t index, void *ctx) {
+  symbol_render_t *render = ctx;
+  size_t slot = index % render->slots;
+  size_t first = index * SYMBOL_CHUNK;
+  size_t last = (render->count - first < SYMBOL_CHUNK) ? render->count : first + SYMBOL_CHUNK;
+  size_t chunks = (render->count + SYMBOL_CHUNK - 1) / SYMBOL_CHUNK;
+  out_t *out = &render->ring[slot];
+
+  pthread_mutex_lock(&render->lock);
+  while (index >= render->next + render->slots)
+    pthread_cond_wait(&render->room, &render->lock);
+  pthread_mutex_unlock(&render->lock);
+
+  out->len = 0;
+  for (size_t j = first; j < last; ++j)
+    dump_symbol_row(out, j, &render->syms[j],
+                    elf_string(render->strtab, render->strsize, render->syms[j].st_name));
+
+  pthread_mutex_lock(&render->lock);
+  render->ready[slot] = true;
+  while (render->next < chunks && render->ready[render->next % render->slots]) {
+    out_t *done = &render->ring[render->next % render->slots];
+
+    out_write(render->out, done->buf, done->len);
+    render->ready[render->next % render->slots] = false;
+    render->next++;
+  }
+  pthread_cond_broadcast(&render->room);
+  pthread_mutex_unlock(&render->lock);
+}
+
+/**
+ * @brief Renders the rows of one symbol table on `threads` threads.
+ * 
+ * The table is cut into SYMBOL_CHUNK rows, formatted into per-chunk
+ * buffers and written strictly in order: the output is the same bytes as
+ * the serial loop's.
+ * 
+ * @return bool false if we ran out of memory, nothing was written then.
+ */
+
+static bool dump_symbol_rows_parallel(out_t *out, const Elf64_Sym *syms, size_t count, const char *strtab,
+                                      uint64_t strsize, unsigned int threads) {
+  symbol_render_t render = {.syms = syms, .strtab = strtab, .strsize = strsize, .count = count, .out = out,
+                            .slots = SYMBOL_RING_PER_THREAD * threads};
+  size_t chunks = (count + SYMBOL_CHUNK - 1) / SYMBOL_CHUNK;
+  size_t ready = 0;
+
+  if (render.slots > chunks)
+    render.slots = chunks;
+  render.ring = calloc(render.slots, sizeof(out_t));
+  render.ready = calloc(render.slots, sizeof(bool));
+  for (; render.ring && ready < render.slots && out_init(&render.ring[ready], -1); ++ready)
+    ;
+
+  if (render.ring && render.ready && ready == render.slots) {
+    pthread_mutex_init(&render.lock, NULL);
+    pthread_cond_init(&render.room, NULL);
+    pool_run(chunks, threads, dump_symbol_chunk, &render);
+    pthread_cond_destroy(&render.room);
+    pthread_mutex_destroy(&render.lock);
   }
+
+  for (size_t i = 0; i < ready; ++i)
+    out_destroy(&render.ring[i]);
+  free(render.ring);
+  free(render.ready);
+  return ready == render.slots;
 }
 
 /**
  * @brief Dumps the symbol table.
  * 
- * @param elf A pointer to the struct.
+ * With -T, tables of more than a chunk are rendered in parallel.
+ * 
+ * @param file The file, and where its output goes.
  */
 
-void dump_symbol_table(elf_t *elf) {
+void dump_symbol_table(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+
+  if (file->format != OUT_TEXT) {
+    dump_symbol_table_json(file);
+    return;
+  }
+
   for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
     /* are you... a symbol table...? */
-    if (elf->elf_section_header[i].sh_type != SHT_SYMTAB 
-        && elf->elf_section_header[i].sh_type != SHT_DYNSYM)
+    if ((elf->elf_section_header[i].sh_type != SHT_SYMTAB 
+         && elf->elf_section_header[i].sh_type != SHT_DYNSYM) || !elf->elf_section_header[i].sh_entsize)
       continue; /* no? mkay... */
 
     size_t sym_num = elf->elf_section_header[i].sh_size / elf->elf_section_header[i].sh_entsize;
-    elf->elf_symbol_table = (Elf64_Sym *)(elf->file + elf->elf_section_header[i].sh_offset);
-    char *symbol_table = elf->file + elf->elf_section_header[elf->elf_section_header[i].sh_link].sh_offset;
-
-    printf("Symbol table contains %ld entries:\n", sym_num);
-    puts("Num:  Value  Size  Type         Bind           Vis          Ndx        Name");
-
-    for (size_t j = 0; j < sym_num; ++j)
-      printf("%-5ld %-6ld 0x%-3lx %-12s %-14s %-12s %-10u %s\n",
-             j,
-             elf->elf_symbol_table[j].st_value,
-             elf->elf_symbol_table[j].st_size,
-             get_symbol_type(elf->elf_symbol_table[j].st_info),
-             get_symbol_bind(elf->elf_symbol_table[j].st_info),
-             get_symbol_vis(elf->elf_symbol_table[j].st_other),
-             elf->elf_symbol_table[j].st_shndx,
-             symbol_table + elf->elf_symbol_table[j].st_name
-      );
-    putchar('\n');
+    const Elf64_Sym *syms = elf_section_table(elf, i);
+    const char *symbol_table = elf_section_data(elf, elf->elf_section_header[i].sh_link);
+    uint64_t strsize = symbol_table ? elf->elf_section_header[elf->elf_section_header[i].sh_link].sh_size : 0;
+
+    if (!syms || !symbol_table)
+      continue;
+
+    out_str(out, "Symbol table contains ");
+    out_udec(out, sym_num, 0, 0);
+    out_str(out, " entries:\n"
+                 "Num:  Value  Size  Type         Bind           Vis          Ndx        Name\n");
+
+    if (file->render_threads <= 1 || sym_num <= SYMBOL_CHUNK
+        || !dump_symbol_rows_parallel(out, syms, sym_num, symbol_table, strsize, file->render_threads)) {
+      for (size_t j = 0; j < sym_num; ++j)
+        dump_symbol_row(out, j, &syms[j], elf_string(symbol_table, strsize, syms[j].st_name));
+    }
+    out_char(out, '\n');
   }
-}
\ No newline at end of file
+}
@@ -3,10 +3,30 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
 
-void dump_elf_header(elf_t *elf);
-void dump_program_headers(elf_t *elf);
-void dump_section_headers(elf_t *elf);
-void dump_symbol_table(elf_t *elf);
+#define SYMBOL_CHUNK 16384     /* rows of a symbol table rendered at a time by -T */
+#define SYMBOL_RING_PER_THREAD 2  /* chunks in flight per thread, what bounds the memory */
+
+typedef struct symbol_render {
+  const Elf64_Sym *syms;
+  const char *strtab;
+  uint64_t strsize;
+  size_t count;
+  out_t *out;
+  out_t *ring;           /* a buffer per slot, chunk c goes to slot c % slots */
+  bool *ready;
+  size_t slots;
+  size_t next;           /* the next chunk to write out */
+  pthread_mutex_t lock;
+  pthread_cond_t room;   /* a slot was written out */
+} symbol_render_t;
+
+void dump_elf_header(batch_file_t *file);
+void dump_elf_summary(batch_file_t *file);
+void dump_program_headers(batch_file_t *file);
+void dump_section_headers(batch_file_t *file);
+void dump_symbol_table(batch_file_t *file);
+void dump_symbol_row(out_t *out, size_t index, const Elf64_Sym *sym, const char *name);
 
 #endif 
\ No newline at end of file
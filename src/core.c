@@ -0,0 +1,444 @@
+/**
+ * @file core.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Core dumps: threads, signal, mapped files and auxv, from the PT_NOTE segments only.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+static const char *const regs_x86_64[] = {
+  "r15", "r14", "r13", "r12", "rbp", "rbx", "r11", "r10", "r9", "r8", "rax", "rcx", "rdx", "rsi",
+  "rdi", "orig_rax", "rip", "cs", "eflags", "rsp", "ss", "fs_base", "gs_base", "ds", "es", "fs", "gs"
+};
+
+static const char *const regs_i386[] = {
+  "ebx", "ecx", "edx", "esi", "edi", "ebp", "eax", "ds", "es", "fs", "gs", "orig_eax", "eip", "cs",
+  "eflags", "esp", "ss"
+};
+
+static const char *const regs_aarch64[] = {
+  "x0", "x1", "x2", "x3", "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13", "x14", "x15",
+  "x16", "x17", "x18", "x19", "x20", "x21", "x22", "x23", "x24", "x25", "x26", "x27", "x28", "x29",
+  "x30", "sp", "pc", "pstate"
+};
+
+/**
+ * @brief Get the name of an auxiliary vector entry.
+ * 
+ */
+
+static const char *get_auxv_type(uint64_t type) {
+  switch (type) {
+    case AT_IGNORE:         return ("AT_IGNORE"); break;
+    case AT_EXECFD:         return ("AT_EXECFD"); break;
+    case AT_PHDR:           return ("AT_PHDR"); break;
+    case AT_PHENT:          return ("AT_PHENT"); break;
+    case AT_PHNUM:          return ("AT_PHNUM"); break;
+    case AT_PAGESZ:         return ("AT_PAGESZ"); break;
+    case AT_BASE:           return ("AT_BASE"); break;
+    case AT_FLAGS:          return ("AT_FLAGS"); break;
+    case AT_ENTRY:          return ("AT_ENTRY"); break;
+    case AT_NOTELF:         return ("AT_NOTELF"); break;
+    case AT_UID:            return ("AT_UID"); break;
+    case AT_EUID:           return ("AT_EUID"); break;
+    case AT_GID:            return ("AT_GID"); break;
+    case AT_EGID:           return ("AT_EGID"); break;
+    case AT_PLATFORM:       return ("AT_PLATFORM"); break;
+    case AT_HWCAP:          return ("AT_HWCAP"); break;
+    case AT_CLKTCK:         return ("AT_CLKTCK"); break;
+    case AT_SECURE:         return ("AT_SECURE"); break;
+    case AT_BASE_PLATFORM:  return ("AT_BASE_PLATFORM"); break;
+    case AT_RANDOM:         return ("AT_RANDOM"); break;
+    case AT_HWCAP2:         return ("AT_HWCAP2"); break;
+    case AT_EXECFN:         return ("AT_EXECFN"); break;
+    case AT_SYSINFO:        return ("AT_SYSINFO"); break;
+    case AT_SYSINFO_EHDR:   return ("AT_SYSINFO_EHDR"); break;
+    case AT_MINSIGSTKSZ:    return ("AT_MINSIGSTKSZ"); break;
+    case AT_RSEQ_FEATURE_SIZE: return ("AT_RSEQ_FEATURE_SIZE"); break;
+    case AT_RSEQ_ALIGN:     return ("AT_RSEQ_ALIGN"); break;
+    default:                return ("AT_?"); break;
+  }
+}
+
+/**
+ * @brief Get the name of a note of the "CORE" or "LINUX" owner.
+ * 
+ */
+
+static const char *get_core_note_type(uint32_t type) {
+  switch (type) {
+    case NT_PRSTATUS:       return ("NT_PRSTATUS"); break;
+    case NT_PRFPREG:        return ("NT_PRFPREG"); break;
+    case NT_PRPSINFO:       return ("NT_PRPSINFO"); break;
+    case NT_AUXV:           return ("NT_AUXV"); break;
+    case NT_SIGINFO:        return ("NT_SIGINFO"); break;
+    case NT_FILE:           return ("NT_FILE"); break;
+    case NT_PRXFPREG:       return ("NT_PRXFPREG"); break;
+    case NT_386_TLS:        return ("NT_386_TLS"); break;
+    case NT_X86_XSTATE:     return ("NT_X86_XSTATE"); break;
+    default:                return ("unknown"); break;
+  }
+}
+
+/**
+ * @brief The size of a word (a C long) in the core's class.
+ * 
+ */
+
+static inline __attribute__((always_inline)) unsigned int core_word(const elf_t *elf) {
+  return (elf->elf_header->e_ident[EI_CLASS] == ELFCLASS32 ? 4 : 8);
+}
+
+/**
+ * @brief Prints the registers of a thread, NT_PRSTATUS.
+ * 
+ * struct elf_prstatus is the same everywhere up to pr_reg, only the size
+ * of a long changes: pr_info, the signal masks, the pids and four
+ * timevals, then the general purpose registers and an int (pr_fpvalid,
+ * padded to a long on 64-bit) at the end. The register count follows from
+ * the size of the note, their names from e_machine.
+ */
+
+static void core_prstatus(batch_file_t *file, const elf_note_t *note, core_stats_t *stats) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  unsigned int word = core_word(elf);
+  size_t reg_off = (word == 8) ? 112 : 72, tail = (word == 8) ? 8 : 4;
+  uint32_t info[1], pid[1];
+  uint64_t regs[CORE_REGS];
+
+  if (note->descsz < reg_off + tail)
+    return;
+
+  elf_words(elf, info, note->desc, 1);
+  elf_words(elf, pid, note->desc + reg_off - 8 * word - 16, 1);
+
+  size_t count = (note->descsz - reg_off - tail) / word;
+  const char *const *names = NULL;
+
+  if (count > CORE_REGS)
+    count = CORE_REGS;
+  elf_addrs(elf, regs, note->desc + reg_off, count);
+
+  if (elf->elf_header->e_machine == EM_X86_64 && count == sizeof(regs_x86_64) / sizeof(*regs_x86_64))
+    names = regs_x86_64;
+  else if (elf->elf_header->e_machine == EM_386 && count == sizeof(regs_i386) / sizeof(*regs_i386))
+    names = regs_i386;
+  else if (elf->elf_header->e_machine == EM_AARCH64 && count == sizeof(regs_aarch64) / sizeof(*regs_aarch64))
+    names = regs_aarch64;
+
+  stats->threads++;
+  out_str(out, "\nThread ");
+  out_udec(out, pid[0], 0, 0);
+  if (info[0]) {
+    out_str(out, ", signal ");
+    out_udec(out, info[0], 0, 0);
+  }
+  out_str(out, ":\n");
+
+  for (size_t i = 0; i < count; ++i) {
+    char name[24];
+
+    if (!names)
+      snprintf(name, sizeof(name), "r%zu", i);
+    out_char(out, ' ');
+    out_pad(out, names ? names[i] : name, 9, OUT_LEFT);
+    out_write(out, "0x", 2);
+    out_hex(out, regs[i], word * 2, 0, 0);
+    out_char(out, (i % 4 == 3 || i + 1 == count) ? '\n' : ' ');
+  }
+}
+
+/**
+ * @brief Prints the command of the process, NT_PRPSINFO.
+ * 
+ * pr_fname[16] and pr_psargs[80] close the struct whatever the class and
+ * the width of the ids before them.
+ */
+
+static void core_prpsinfo(batch_file_t *file, const elf_note_t *note) {
+  out_t *out = file->out;
+
+  if (note->descsz < 96)
+    return;
+
+  const char *fname = note->desc + note->descsz - 96, *psargs = fname + 16;
+  size_t len = strnlen(psargs, 80);
+
+  /* the arguments are joined with spaces, the last one too */
+  while (len && psargs[len - 1] == ' ')
+    --len;
+
+  out_str(out, "Process: ");
+  out_write(out, fname, strnlen(fname, 16));
+  out_str(out, ", \"");
+  out_write(out, psargs, len);
+  out_str(out, "\"\n");
+}
+
+/**
+ * @brief Prints the signal that killed the process, NT_SIGINFO.
+ * 
+ * si_addr is only there for the signals raised by a faulting instruction.
+ */
+
+static void core_siginfo(batch_file_t *file, const elf_note_t *note) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  unsigned int word = core_word(elf);
+  size_t addr_off = (word == 8) ? 16 : 12;
+  uint32_t info[3];
+  uint64_t addr;
+
+  if (note->descsz < addr_off + word)
+    return;
+
+  elf_words(elf, info, note->desc, 3);
+  elf_addrs(elf, &addr, note->desc + addr_off, 1);
+
+  out_str(out, "Signal: ");
+  out_udec(out, info[0], 0, 0);
+  out_str(out, ", code ");
+  out_sdec(out, (int32_t)info[2], 0, 0);
+  if (info[0] == SIGSEGV || info[0] == SIGBUS || info[0] == SIGILL || info[0] == SIGFPE || info[0] == SIGTRAP) {
+    out_str(out, ", address 0x");
+    out_hex(out, addr, 0, 0, 0);
+  }
+  out_char(out, '\n');
+}
+
+/**
+ * @brief Prints the auxiliary vector, NT_AUXV, up to AT_NULL.
+ * 
+ */
+
+static void core_auxv(batch_file_t *file, const elf_note_t *note) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  unsigned int word = core_word(elf);
+
+  out_str(out, "\nAuxiliary vector:\n");
+  for (size_t off = 0; off + 2 * word <= note->descsz; off += 2 * word) {
+    uint64_t entry[2];
+
+    elf_addrs(elf, entry, note->desc + off, 2);
+    if (entry[0] == AT_NULL)
+      break;
+    out_char(out, ' ');
+    out_pad(out, get_auxv_type(entry[0]), 22, OUT_LEFT);
+    out_write(out, "0x", 2);
+    out_hex(out, entry[1], 0, 0, 0);
+    out_char(out, '\n');
+  }
+}
+
+/**
+ * @brief Prints the files mapped into the process, NT_FILE.
+ * 
+ * The note is a count and a page size, `count` (start, end, page offset)
+ * triples, then `count` NUL terminated paths in the same order.
+ */
+
+static void core_files(batch_file_t *file, const elf_note_t *note) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  unsigned int word = core_word(elf);
+  uint64_t hdr[2];
+
+  if (note->descsz < 2 * word)
+    return;
+  elf_addrs(elf, hdr, note->desc, 2);
+  if (hdr[0] > (note->descsz - 2 * word) / (3 * word))
+    return;
+
+  const char *name = note->desc + (2 + 3 * hdr[0]) * word, *end = note->desc + note->descsz;
+
+  out_str(out, "\nMapped files: ");
+  out_udec(out, hdr[0], 0, 0);
+  out_str(out, ", page size ");
+  out_udec(out, hdr[1], 0, 0);
+  out_str(out, "\nStart               End                 Offset      Path\n");
+
+  for (uint64_t i = 0; i < hdr[0]; ++i) {
+    uint64_t map[3];
+    const char *nul = name < end ? memchr(name, '\0', end - name) : NULL;
+
+    elf_addrs(elf, map, note->desc + (2 + 3 * i) * word, 3);
+    out_write(out, "0x", 2);
+    out_hex(out, map[0], word * 2, 18, OUT_LEFT);
+    out_write(out, "0x", 2);
+    out_hex(out, map[1], word * 2, 18, OUT_LEFT);
+    out_write(out, "0x", 2);
+    out_hex(out, map[2] * hdr[1], 8, 10, OUT_LEFT);
+    if (nul) {
+      out_write(out, name, nul - name);
+      name = nul + 1;
+    }
+    out_char(out, '\n');
+  }
+}
+
+/**
+ * @brief Finds, or with `add` records, a note type that was shown for the first thread.
+ * 
+ * @return core_seen_t* The entry, NULL if the type wasn't seen (or there is no room left).
+ */
+
+static core_seen_t *core_seen(core_stats_t *stats, const elf_note_t *note, bool add) {
+  size_t len = strnlen(note->name, note->namesz);
+
+  if (len >= sizeof(stats->seen[0].name))
+    return NULL;
+  for (unsigned int i = 0; i < stats->nseen; ++i) {
+    if (stats->seen[i].type == note->type && !strncmp(stats->seen[i].name, note->name, len)
+        && !stats->seen[i].name[len])
+      return &stats->seen[i];
+  }
+  if (!add || stats->nseen == CORE_SEEN_MAX)
+    return NULL;
+
+  core_seen_t *seen = &stats->seen[stats->nseen++];
+
+  memcpy(seen->name, note->name, len);
+  seen->name[len] = '\0';
+  seen->type = note->type;
+  seen->repeats = 0;
+  return seen;
+}
+
+/**
+ * @brief Writes the name, type and size of a note that isn't decoded.
+ * 
+ */
+
+static void core_note_line(out_t *out, const char *name, size_t len, uint32_t type) {
+  out_write(out, name, len);
+  out_char(out, ' ');
+  out_str(out, get_core_note_type(type));
+  out_str(out, " (0x");
+  out_hex(out, type, 0, 0, 0);
+  out_char(out, ')');
+}
+
+/**
+ * @brief Decodes one note of a core dump, the ones nobody reads are only counted.
+ * 
+ * Register sets and the like come once per thread; the types the first
+ * thread had are shown for it only and counted for the others, anything
+ * else a later thread carries is shown where it is.
+ */
+
+static void core_note(batch_file_t *file, const elf_note_t *note, core_stats_t *stats) {
+  out_t *out = file->out;
+
+  stats->notes++;
+  if (note->namesz == 5 && !memcmp(note->name, "CORE", 5)) {
+    switch (note->type) {
+      case NT_PRSTATUS:  core_prstatus(file, note, stats); return;
+      case NT_PRPSINFO:  core_prpsinfo(file, note); return;
+      case NT_SIGINFO:   core_siginfo(file, note); return;
+      case NT_AUXV:      core_auxv(file, note); return;
+      case NT_FILE:      core_files(file, note); return;
+      default:           break;
+    }
+  }
+
+  core_seen_t *seen = core_seen(stats, note, stats->threads <= 1);
+
+  if (stats->threads > 1 && seen) {
+    seen->repeats++;
+    return;
+  }
+  out_str(out, " note ");
+  core_note_line(out, note->name, strnlen(note->name, note->namesz), note->type);
+  out_str(out, ", ");
+  out_udec(out, note->descsz, 0, 0);
+  out_str(out, " bytes\n");
+}
+
+/**
+ * @brief Decodes the notes of a core dump: threads and their registers, the
+ * signal, the command, the mapped files and the auxiliary vector.
+ * 
+ * Only the program headers and the PT_NOTE segments are read, each one at
+ * once (so memory is bounded by the biggest of them); the PT_LOAD payload,
+ * nearly all of a core, is never touched, so a core of any size takes
+ * about as long as its notes.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void dump_core(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  core_stats_t stats = {0};
+
+  if (elf->elf_header->e_type != ET_CORE) {
+    fprintf(file->err, "%s: Not a core dump.\n", file->path);
+    return;
+  }
+
+  for (int i = 0; i < elf->elf_header->e_phnum; ++i) {
+    const Elf64_Phdr *phdr = &elf->elf_program_header[i];
+
+    if (phdr->p_type == PT_LOAD)
+      stats.load_bytes += phdr->p_filesz;
+    if (phdr->p_type != PT_NOTE || !phdr->p_filesz)
+      continue;
+
+    const char *notes = NULL;
+
+    if (phdr->p_offset > elf->size || phdr->p_filesz > elf->size - phdr->p_offset
+        || phdr->p_filesz > CORE_NOTES_MAX || !(notes = elf_read(elf, phdr->p_offset, phdr->p_filesz))) {
+      fprintf(file->err, "%s: The PT_NOTE segment at 0x%lx is truncated or corrupt.\n", file->path,
+              (unsigned long)phdr->p_offset);
+      continue;
+    }
+
+    const char *end = notes + phdr->p_filesz;
+    elf_note_t note;
+
+    stats.segments++;
+    stats.note_bytes += phdr->p_filesz;
+    while (elf_note_next(elf, &notes, end, phdr->p_align, &note))
+      core_note(file, &note, &stats);
+  }
+
+  for (unsigned int i = 0; i < stats.nseen; ++i) {
+    if (!stats.seen[i].repeats)
+      continue;
+    out_str(out, "Not shown: ");
+    core_note_line(out, stats.seen[i].name, strlen(stats.seen[i].name), stats.seen[i].type);
+    out_str(out, " of ");
+    out_udec(out, stats.seen[i].repeats, 0, 0);
+    out_str(out, " more threads\n");
+  }
+
+  out_char(out, '\n');
+  out_udec(out, stats.threads, 0, 0);
+  out_str(out, " threads, ");
+  out_udec(out, stats.notes, 0, 0);
+  out_str(out, " notes in ");
+  out_udec(out, stats.segments, 0, 0);
+  out_str(out, " PT_NOTE segments, ");
+  out_udec(out, stats.note_bytes, 0, 0);
+  out_str(out, " bytes read; ");
+  out_udec(out, stats.load_bytes, 0, 0);
+  out_str(out, " bytes of PT_LOAD left alone\n");
+}
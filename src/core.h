@@ -0,0 +1,42 @@
+#ifndef _CORE_H
+#define _CORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CORE_NOTES_MAX ((uint64_t)256 << 20) /* bigger PT_NOTE segments are taken as corrupt */
+#define CORE_REGS 64
+#define CORE_SEEN_MAX 32 /* note types of the first thread that later threads' copies are counted against */
+
+#ifndef NT_FILE
+#define NT_FILE 0x46494c45
+#endif
+#ifndef AT_RSEQ_FEATURE_SIZE
+#define AT_RSEQ_FEATURE_SIZE 27
+#endif
+#ifndef AT_RSEQ_ALIGN
+#define AT_RSEQ_ALIGN 28
+#endif
+#ifndef NT_SIGINFO
+#define NT_SIGINFO 0x53494749
+#endif
+
+typedef struct core_seen {
+  char name[16];
+  uint32_t type;
+  unsigned long repeats; /* copies in later threads, not shown */
+} core_seen_t;
+
+typedef struct core_stats {
+  unsigned long segments;
+  unsigned long notes;
+  unsigned long threads;
+  uint64_t note_bytes;
+  uint64_t load_bytes; /* PT_LOAD payload, never read */
+  core_seen_t seen[CORE_SEEN_MAX];
+  unsigned int nseen;
+} core_stats_t;
+
+void dump_core(batch_file_t *file);
+
+#endif
@@ -0,0 +1,619 @@
+/**
+ * @file deps.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief DT_NEEDED resolution across a sysroot, the way ld.so searches, without running anything.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+/* what every file of a run shares, so a library is only parsed once */
+static deps_state_t deps = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, false, -1, NULL,
+                            {0}, {0}, NULL, 0};
+
+/**
+ * @brief The hash of the maps (FNV-1a).
+ * 
+ */
+
+static inline __attribute__((always_inline)) size_t deps_hash(const char *key) {
+  size_t h = 14695981039346656037ULL;
+
+  for (const unsigned char *p = (const unsigned char *)key; *p; ++p)
+    h = (h ^ *p) * 1099511628211ULL;
+  return h;
+}
+
+/**
+ * @brief Finds a key.
+ * 
+ * @return bool false if the key was never put.
+ */
+
+static bool deps_map_get(const deps_map_t *map, const char *key, deps_lib_t **val) {
+  if (!map->keys)
+    return false;
+
+  for (size_t slot = deps_hash(key) & map->mask; map->keys[slot]; slot = (slot + 1) & map->mask) {
+    if (!strcmp(map->keys[slot], key)) {
+      *val = map->vals[slot];
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Puts a key (copied) or updates it, the table doubles when half full.
+ * 
+ */
+
+static void deps_map_put(deps_map_t *map, const char *key, deps_lib_t *val) {
+  if (!map->keys || (map->count + 1) * 2 > map->mask + 1) {
+    size_t size = map->keys ? (map->mask + 1) * 2 : DEPS_MAP_SIZE;
+    deps_map_t grown = {calloc(size, sizeof(char *)), calloc(size, sizeof(deps_lib_t *)), size - 1, 0};
+
+    if (!grown.keys || !grown.vals)
+      error_handling(-1, NULL, NULL, "Failed to allocate memory for the libraries!");
+    for (size_t i = 0; map->keys && i <= map->mask; ++i) {
+      if (map->keys[i]) {
+        size_t slot = deps_hash(map->keys[i]) & grown.mask;
+
+        while (grown.keys[slot])
+          slot = (slot + 1) & grown.mask;
+        grown.keys[slot] = map->keys[i];
+        grown.vals[slot] = map->vals[i];
+        grown.count++;
+      }
+    }
+    free(map->keys);
+    free(map->vals);
+    *map = grown;
+  }
+
+  size_t slot = deps_hash(key) & map->mask;
+
+  for (; map->keys[slot]; slot = (slot + 1) & map->mask) {
+    if (!strcmp(map->keys[slot], key)) {
+      map->vals[slot] = val;
+      return;
+    }
+  }
+  if (!(map->keys[slot] = strdup(key)))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the libraries!");
+  map->vals[slot] = val;
+  map->count++;
+}
+
+/**
+ * @brief Opens a path of the target, inside the sysroot.
+ * 
+ * Absolute symlinks and ".." stay inside the sysroot (RESOLVE_IN_ROOT),
+ * the way they would on the target.
+ */
+
+static int deps_open(const char *path) {
+  if (deps.rootfd == -1)
+    return open(path, O_RDONLY | O_CLOEXEC);
+
+  struct open_how how = {.flags = O_RDONLY | O_CLOEXEC, .resolve = RESOLVE_IN_ROOT};
+  int fd = (int)syscall(SYS_openat2, deps.rootfd, path, &how, sizeof(how));
+
+  /* kernels before 5.6, absolute symlinks lead out of the sysroot there */
+  if (fd == -1 && errno == ENOSYS)
+    fd = openat(deps.rootfd, path[0] == '/' ? path + 1 : path, O_RDONLY | O_CLOEXEC);
+  return fd;
+}
+
+/**
+ * @brief Adds a search directory.
+ * 
+ */
+
+static void deps_add_dir(const char *dir, size_t len) {
+  char **tmp = realloc(deps.dirs, (deps.ndirs + 1) * sizeof(char *));
+
+  if (!tmp || !(tmp[deps.ndirs] = strndup(dir, len)))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the search path!");
+  deps.dirs = tmp;
+  deps.ndirs++;
+}
+
+/**
+ * @brief Reads the directories of an ld.so.conf, following its include lines.
+ * 
+ * @param path The file, a path of the target.
+ * @param depth How many includes deep we are.
+ */
+
+static void deps_read_conf(const char *path, int depth) {
+  int fd = deps_open(path);
+  size_t len;
+  char *conf = (fd == -1) ? NULL : read_all(fd, &len);
+
+  if (fd != -1)
+    close(fd);
+  if (!conf || depth > DEPS_CONF_DEPTH) {
+    free(conf);
+    return;
+  }
+
+  for (char *line = strtok(conf, "\n"); line; line = strtok(NULL, "\n")) {
+    char *hash = strchr(line, '#');
+
+    if (hash)
+      *hash = '\0';
+    line += strspn(line, " \t");
+
+    size_t end = strlen(line);
+
+    while (end && strchr(" \t\r", line[end - 1]))
+      line[--end] = '\0';
+    if (!end || !strncmp(line, "hwcap ", 6))
+      continue;
+
+    if (strncmp(line, "include", 7) || !strchr(" \t", line[7])) {
+      deps_add_dir(line, end);
+      continue;
+    }
+
+    /* the pattern is globbed in the sysroot, relative ones are relative to /etc */
+    const char *pattern = line + 7 + strspn(line + 7, " \t");
+    char full[PATH_MAX];
+    glob_t files;
+
+    snprintf(full, sizeof(full), "%s%s%s", deps.sysroot ? deps.sysroot : "",
+             pattern[0] == '/' ? "" : "/etc/", pattern);
+    if (!glob(full, 0, NULL, &files)) {
+      size_t skip = deps.sysroot ? strlen(deps.sysroot) : 0;
+
+      for (size_t i = 0; i < files.gl_pathc; ++i)
+        deps_read_conf(files.gl_pathv[i] + skip, depth + 1);
+    }
+    globfree(&files);
+  }
+  free(conf);
+}
+
+/**
+ * @brief Sets the sysroot up and reads its ld.so.conf, on the first call of the run.
+ * 
+ * Must be called with the lock held.
+ */
+
+static void deps_init(const char *sysroot) {
+  char real[PATH_MAX];
+
+  if (deps.ready)
+    return;
+  deps.ready = true;
+
+  if (strcmp(sysroot, "/") && realpath(sysroot, real) && strcmp(real, "/")) {
+    deps.rootfd = open(real, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (deps.rootfd == -1 || !(deps.sysroot = strdup(real)))
+      error_handling(-1, NULL, NULL, "Failed to open the sysroot!");
+  }
+
+  deps_read_conf("/etc/ld.so.conf", 0);
+  deps_add_dir("/lib64", 6);
+  deps_add_dir("/usr/lib64", 10);
+  deps_add_dir("/lib", 4);
+  deps_add_dir("/usr/lib", 8);
+}
+
+/**
+ * @brief Copies a string of the dynamic string table, NULL if it is out of it.
+ * 
+ */
+
+static char *deps_string(const char *strtab, uint64_t size, uint64_t offset) {
+  if (!strtab || offset >= size)
+    return NULL;
+
+  char *str = strndup(strtab + offset, size - offset);
+
+  if (!str)
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the libraries!");
+  return str;
+}
+
+/**
+ * @brief Keeps what the search needs from the dynamic section of a file.
+ * 
+ */
+
+static void deps_info(elf_t *elf, deps_lib_t *lib) {
+  uint64_t count, size = 0;
+  const Elf64_Dyn *dyn = elf_dynamic(elf, &count);
+  const char *strtab = dyn ? elf_dynamic_strtab(elf, dyn, count, &size) : NULL;
+
+  lib->elf_class = elf->elf_header->e_ident[EI_CLASS];
+  lib->elf_data = elf->elf_header->e_ident[EI_DATA];
+  lib->machine = elf->elf_header->e_machine;
+  lib->ok = true;
+
+  for (uint64_t i = 0; i < count && dyn[i].d_tag != DT_NULL; ++i) {
+    char *str = deps_string(strtab, size, dyn[i].d_un.d_val);
+
+    if (!str)
+      continue;
+
+    switch (dyn[i].d_tag) {
+      case DT_NEEDED: {
+        char **tmp = realloc(lib->needed, (lib->nneeded + 1) * sizeof(char *));
+
+        if (!tmp)
+          error_handling(-1, NULL, NULL, "Failed to allocate memory for the libraries!");
+        lib->needed = tmp;
+        lib->needed[lib->nneeded++] = str;
+        continue;
+      }
+      case DT_RPATH:   free(lib->rpath); lib->rpath = str; continue;
+      case DT_RUNPATH: free(lib->runpath); lib->runpath = str; continue;
+      case DT_SONAME:  free(lib->soname); lib->soname = str; continue;
+      default:         free(str); break;
+    }
+  }
+}
+
+/**
+ * @brief Frees what deps_info() kept.
+ * 
+ */
+
+static void deps_free_info(deps_lib_t *lib) {
+  for (size_t i = 0; i < lib->nneeded; ++i)
+    free(lib->needed[i]);
+  free(lib->needed);
+  free(lib->rpath);
+  free(lib->runpath);
+  free(lib->soname);
+  free(lib->path);
+}
+
+/**
+ * @brief Returns the library at a path of the target, parsing it the first time.
+ * 
+ * Paths and inodes are both remembered, so a library reached through
+ * several names or symlinks, or needed by many files, is parsed once; a
+ * thread that finds it being parsed waits for it.
+ * 
+ * @return deps_lib_t* NULL if there is no such file.
+ */
+
+static deps_lib_t *deps_load(const char *path) {
+  deps_lib_t *lib = NULL;
+  char key[64];
+  struct stat st;
+
+  pthread_mutex_lock(&deps.lock);
+  if (deps_map_get(&deps.paths, path, &lib)) {
+    while (lib && lib->loading)
+      pthread_cond_wait(&deps.done, &deps.lock);
+    pthread_mutex_unlock(&deps.lock);
+    return lib;
+  }
+  pthread_mutex_unlock(&deps.lock);
+
+  int fd = deps_open(path);
+
+  if (fd == -1 || fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+    if (fd != -1)
+      close(fd);
+    pthread_mutex_lock(&deps.lock);
+    deps_map_put(&deps.paths, path, NULL);
+    pthread_mutex_unlock(&deps.lock);
+    return NULL;
+  }
+
+  snprintf(key, sizeof(key), "%lu:%lu", (unsigned long)st.st_dev, (unsigned long)st.st_ino);
+  pthread_mutex_lock(&deps.lock);
+  if (deps_map_get(&deps.inodes, key, &lib)) {
+    deps_map_put(&deps.paths, path, lib);
+    while (lib->loading)
+      pthread_cond_wait(&deps.done, &deps.lock);
+    pthread_mutex_unlock(&deps.lock);
+    close(fd);
+    return lib;
+  }
+  if (!(lib = calloc(1, sizeof(deps_lib_t))) || !(lib->path = strdup(path)))
+    error_handling(fd, NULL, NULL, "Failed to allocate memory for the libraries!");
+  lib->dev = st.st_dev;
+  lib->ino = st.st_ino;
+  lib->loading = true;
+  deps_map_put(&deps.inodes, key, lib);
+  deps_map_put(&deps.paths, path, lib);
+  pthread_mutex_unlock(&deps.lock);
+
+  /* mapped, so that the threads of -B can all read it */
+  if (elf_open_fd(fd, ELF_BACKEND_MMAP, NULL, &lib->elf) == ELF_OK)
+    deps_info(lib->elf, lib);
+  close(fd);
+
+  pthread_mutex_lock(&deps.lock);
+  lib->loading = false;
+  pthread_cond_broadcast(&deps.done);
+  pthread_mutex_unlock(&deps.lock);
+  return lib;
+}
+
+/**
+ * @brief Tries every directory of a colon separated list, $ORIGIN expanded.
+ * 
+ * @param list DT_RPATH, DT_RUNPATH or NULL.
+ * @param req The library that needs `name`, its class, byte order and machine have to match.
+ */
+
+static deps_lib_t *deps_search_list(const char *list, const deps_lib_t *req, const char *name) {
+  const char *slash = strrchr(req->path, '/');
+  int origin_len = slash ? (int)(slash - req->path) : 1;
+  const char *origin = slash ? req->path : ".";
+
+  for (const char *p = list; p && *p;) {
+    size_t len = strcspn(p, ":");
+    char path[PATH_MAX];
+    int n = 0;
+
+    for (size_t i = 0; i < len && n < (int)sizeof(path);) {
+      if (!strncmp(p + i, "$ORIGIN", 7) || !strncmp(p + i, "${ORIGIN}", 9)) {
+        n += snprintf(path + n, sizeof(path) - n, "%.*s", origin_len ? origin_len : 1,
+                      origin_len ? origin : "/");
+        i += (p[i + 1] == '{') ? 9 : 7;
+      } else {
+        path[n++] = p[i++];
+      }
+    }
+    if (len && n < (int)sizeof(path)
+        && snprintf(path + n, sizeof(path) - n, "/%s", name) < (int)sizeof(path) - n) {
+      deps_lib_t *lib = deps_load(path);
+
+      if (lib && lib->ok && lib->elf_class == req->elf_class && lib->elf_data == req->elf_data
+          && lib->machine == req->machine)
+        return lib;
+    }
+    p += len + (p[len] == ':');
+  }
+  return NULL;
+}
+
+/**
+ * @brief Finds the library ld.so would load for one DT_NEEDED entry.
+ * 
+ * A library already loaded under that soname is reused. Otherwise names
+ * with a slash are paths, and the rest are searched in DT_RPATH (of the
+ * library, then of the executable, only when the library has no
+ * DT_RUNPATH), DT_RUNPATH, ld.so.conf and the default directories, in
+ * that order; files of another class, byte order or machine are passed
+ * over.
+ */
+
+static deps_lib_t *deps_find(const deps_walk_t *walk, const deps_lib_t *req, const char *name) {
+  deps_lib_t *lib;
+
+  for (size_t i = 1; i < walk->last; ++i) {
+    if (walk->nodes[i].lib->soname && !strcmp(walk->nodes[i].lib->soname, name))
+      return walk->nodes[i].lib;
+  }
+
+  if (strchr(name, '/')) {
+    lib = deps_load(name);
+    return (lib && lib->ok ? lib : NULL);
+  }
+
+  if (!req->runpath && ((lib = deps_search_list(req->rpath, req, name))
+                        || (req != walk->root && (lib = deps_search_list(walk->root->rpath, walk->root, name)))))
+    return lib;
+  if ((lib = deps_search_list(req->runpath, req, name)))
+    return lib;
+
+  for (size_t i = 0; i < deps.ndirs; ++i) {
+    if ((lib = deps_search_list(deps.dirs[i], req, name)))
+      return lib;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Resolves the DT_NEEDED entries of one library of the current level.
+ * 
+ */
+
+static void deps_job(size_t index, void *ctx) {
+  deps_walk_t *walk = ctx;
+  deps_node_t *node = &walk->nodes[walk->first + index];
+
+  if (node->lib->nneeded && !(node->edges = calloc(node->lib->nneeded, sizeof(deps_lib_t *))))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the libraries!");
+  for (size_t i = 0; i < node->lib->nneeded; ++i)
+    node->edges[i] = deps_find(walk, node->lib, node->lib->needed[i]);
+}
+
+/**
+ * @brief Appends a library to the load order, unless it is there already.
+ * 
+ */
+
+static void deps_push(deps_walk_t *walk, deps_lib_t *lib) {
+  for (size_t i = 0; i < walk->count; ++i) {
+    if (walk->nodes[i].lib == lib)
+      return;
+  }
+  if (walk->count == walk->cap) {
+    size_t cap = walk->cap ? walk->cap * 2 : 64;
+    deps_node_t *tmp = realloc(walk->nodes, cap * sizeof(deps_node_t));
+
+    if (!tmp)
+      error_handling(-1, NULL, NULL, "Failed to allocate memory for the libraries!");
+    walk->nodes = tmp;
+    walk->cap = cap;
+  }
+  walk->nodes[walk->count++] = (deps_node_t){lib, NULL};
+}
+
+/**
+ * @brief Prints the graph: every library with what each of its entries resolved to.
+ * 
+ */
+
+static void deps_dump(batch_file_t *file, const deps_walk_t *walk) {
+  out_t *out = file->out;
+  bool missing = false;
+
+  out_str(out, "Load order:\n");
+  for (size_t i = 0; i < walk->count; ++i) {
+    out_udec(out, i, 4, 0);
+    out_str(out, "  ");
+    out_str(out, walk->nodes[i].lib->path);
+    out_char(out, '\n');
+  }
+
+  for (size_t i = 0; i < walk->count; ++i) {
+    for (size_t j = 0; j < walk->nodes[i].lib->nneeded; ++j) {
+      if (walk->nodes[i].edges[j])
+        continue;
+      if (!missing)
+        out_str(out, "\nNot found:\n");
+      missing = true;
+      out_str(out, "  ");
+      out_str(out, walk->nodes[i].lib->needed[j]);
+      out_str(out, ", needed by ");
+      out_str(out, walk->nodes[i].lib->path);
+      out_char(out, '\n');
+    }
+  }
+
+  out_str(out, "\nGraph:\n");
+  for (size_t i = 0; i < walk->count; ++i) {
+    const deps_node_t *node = &walk->nodes[i];
+
+    out_str(out, node->lib->path);
+    out_char(out, '\n');
+    for (size_t j = 0; j < node->lib->nneeded; ++j) {
+      out_str(out, "  ");
+      out_str(out, node->lib->needed[j]);
+      out_str(out, " => ");
+      out_str(out, node->edges[j] ? node->edges[j]->path : "not found");
+      out_char(out, '\n');
+    }
+  }
+}
+
+/**
+ * @brief Walks the DT_NEEDED graph of a file, the way ld.so loads it.
+ * 
+ * The graph is walked a level at a time, breadth first as ld.so loads,
+ * with the libraries of a level resolved in parallel; the load order and
+ * the graph come out the same whatever the number of threads. file->arg
+ * is the sysroot, the first call of the run sets it.
+ * 
+ * @param file The file, it becomes walk->nodes[0].
+ * @param root Filled in for the file, released by deps_walk_free().
+ * @param walk The load order and the edges.
+ * @return bool false if the file isn't dynamically linked.
+ */
+
+bool deps_walk(batch_file_t *file, deps_lib_t *root, deps_walk_t *walk) {
+  elf_t *elf = file->elf;
+  char real[PATH_MAX];
+  uint64_t count;
+
+  memset(root, 0, sizeof(deps_lib_t));
+  memset(walk, 0, sizeof(deps_walk_t));
+  walk->root = root;
+
+  pthread_mutex_lock(&deps.lock);
+  deps_init(file->arg);
+  pthread_mutex_unlock(&deps.lock);
+
+  if (!elf_dynamic(elf, &count))
+    return false;
+
+  /* $ORIGIN of the file is its directory on the target */
+  size_t skip = (deps.sysroot && realpath(file->path, real) && !strncmp(real, deps.sysroot, strlen(deps.sysroot))
+                 && real[strlen(deps.sysroot)] == '/') ? strlen(deps.sysroot) : 0;
+
+  deps_info(elf, root);
+  root->elf = elf;
+  if (!(root->path = strdup(skip ? real + skip : file->path)))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the libraries!");
+
+  deps_push(walk, root);
+  while (walk->first < walk->count) {
+    walk->last = walk->count;
+    pool_run(walk->last - walk->first, 0, deps_job, walk);
+
+    /* the next level, in the order ld.so would load it */
+    for (size_t i = walk->first; i < walk->last; ++i) {
+      for (size_t j = 0; j < walk->nodes[i].lib->nneeded; ++j) {
+        if (walk->nodes[i].edges[j])
+          deps_push(walk, walk->nodes[i].edges[j]);
+      }
+    }
+    walk->first = walk->last;
+  }
+  return true;
+}
+
+/**
+ * @brief Frees what deps_walk() allocated, the libraries stay for the run.
+ * 
+ */
+
+void deps_walk_free(deps_lib_t *root, deps_walk_t *walk) {
+  for (size_t i = 0; i < walk->count; ++i)
+    free(walk->nodes[i].edges);
+  free(walk->nodes);
+  deps_free_info(root);
+}
+
+/**
+ * @brief Resolves the DT_NEEDED entries of a file, and theirs, like ld.so would.
+ * 
+ * file->arg is the sysroot the target paths are looked up in, "/" for
+ * this system. Nothing is run. Libraries are remembered for the whole
+ * run, a batch of binaries parses each shared one once.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void resolve_dependencies(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  deps_lib_t root;
+  deps_walk_t walk;
+
+  if (!deps_walk(file, &root, &walk)) {
+    out_str(out, "Not a dynamically linked file.\n");
+    return;
+  }
+
+  for (int i = 0; i < elf->elf_header->e_phnum; ++i) {
+    const Elf64_Phdr *phdr = &elf->elf_program_header[i];
+    const char *interp;
+
+    if (phdr->p_type == PT_INTERP && phdr->p_offset <= elf->size && phdr->p_filesz <= elf->size - phdr->p_offset
+        && (interp = elf_read(elf, phdr->p_offset, phdr->p_filesz))) {
+      out_str(out, "Interpreter: ");
+      out_write(out, interp, strnlen(interp, phdr->p_filesz));
+      out_char(out, '\n');
+    }
+  }
+
+  deps_dump(file, &walk);
+  deps_walk_free(&root, &walk);
+}
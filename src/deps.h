@@ -0,0 +1,68 @@
+#ifndef _DEPS_H
+#define _DEPS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <glob.h>
+#include <sys/syscall.h>
+#include <linux/openat2.h>
+
+#define DEPS_CONF_DEPTH 8  /* include levels followed in ld.so.conf */
+#define DEPS_MAP_SIZE 1024
+
+typedef struct deps_lib {
+  dev_t dev;
+  ino_t ino;
+  char *path;            /* where it was first found, inside the sysroot */
+  unsigned char elf_class;
+  unsigned char elf_data; /* byte order */
+  uint16_t machine;
+  char **needed;
+  size_t nneeded;
+  char *rpath;           /* NULL when the file has none */
+  char *runpath;
+  char *soname;
+  elf_t *elf;            /* kept mapped for the run, NULL if it isn't an ELF file */
+  struct bind_obj *bind; /* what -B looks symbols up in, built on first use */
+  bool loading;          /* another thread is parsing it, wait for deps.done */
+  bool ok;               /* it is a parsed ELF file */
+} deps_lib_t;
+
+typedef struct deps_map {
+  char **keys;
+  deps_lib_t **vals;     /* NULL for a path that was tried and has nothing usable */
+  size_t mask;
+  size_t count;
+} deps_map_t;
+
+typedef struct deps_state {
+  pthread_mutex_t lock;
+  pthread_cond_t done;
+  bool ready;
+  int rootfd;            /* -1 for the host */
+  char *sysroot;         /* canonical, NULL for the host */
+  deps_map_t paths;      /* every path tried, to the library there */
+  deps_map_t inodes;     /* "dev:ino", each library is parsed once */
+  char **dirs;           /* ld.so.conf, then the default directories */
+  size_t ndirs;
+} deps_state_t;
+
+typedef struct deps_node {
+  deps_lib_t *lib;
+  deps_lib_t **edges;    /* one per DT_NEEDED, NULL if it wasn't found */
+} deps_node_t;
+
+typedef struct deps_walk {
+  const deps_lib_t *root;
+  deps_node_t *nodes;    /* in load order */
+  size_t count;
+  size_t cap;
+  size_t first;          /* the level being resolved, nodes[first, last) */
+  size_t last;
+} deps_walk_t;
+
+bool deps_walk(batch_file_t *file, deps_lib_t *root, deps_walk_t *walk);
+void deps_walk_free(deps_lib_t *root, deps_walk_t *walk);
+void resolve_dependencies(batch_file_t *file);
+
+#endif
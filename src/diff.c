@@ -0,0 +1,377 @@
+/**
+ * @file diff.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Compares the sections and symbols of two ELF files.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+/**
+ * @brief 64-bit FNV-1a, the name index is sorted on it.
+ * 
+ */
+
+static inline __attribute__((always_inline)) uint64_t diff_hash(const char *name) {
+  uint64_t h = 0xcbf29ce484222325ull;
+
+  for (; *name; ++name)
+    h = (h ^ (unsigned char)*name) * 0x100000001b3ull;
+  return h;
+}
+
+/**
+ * @brief Orders entries by hash, then by name (hashes can collide).
+ * 
+ */
+
+static inline __attribute__((always_inline)) int diff_cmp(const diff_entry_t *a, const diff_entry_t *b) {
+  if (a->hash != b->hash)
+    return (a->hash > b->hash) ? 1 : -1;
+  return strcmp(a->name, b->name);
+}
+
+/**
+ * @brief Sorts the index: LSD radix sort on the hash, 16 bits per pass.
+ * 
+ * Entries with the same hash end up next to each other and are put in
+ * name order afterwards, that's the only comparison sort, and collisions
+ * of a 64-bit hash are rare. Entries with the same name are then merged.
+ * 
+ * @return bool false if we ran out of memory.
+ */
+
+static bool diff_sort(diff_index_t *index) {
+  diff_entry_t *tmp = malloc((index->count ? index->count : 1) * sizeof(diff_entry_t));
+  size_t *counts = malloc((1 << 16) * sizeof(size_t));
+
+  if (!tmp || !counts) {
+    free(tmp);
+    free(counts);
+    return false;
+  }
+
+  diff_entry_t *src = index->entries, *dst = tmp;
+
+  for (int shift = 0; shift < 64; shift += 16) {
+    memset(counts, 0, (1 << 16) * sizeof(size_t));
+    for (size_t i = 0; i < index->count; ++i)
+      counts[(src[i].hash >> shift) & 0xffff]++;
+
+    for (size_t i = 0, sum = 0; i < (1 << 16); ++i) {
+      size_t c = counts[i];
+
+      counts[i] = sum;
+      sum += c;
+    }
+
+    for (size_t i = 0; i < index->count; ++i)
+      dst[counts[(src[i].hash >> shift) & 0xffff]++] = src[i];
+
+    diff_entry_t *swap = src;
+
+    src = dst;
+    dst = swap;
+  }
+  /* four passes, the result is back in index->entries */
+  free(tmp);
+  free(counts);
+
+  for (size_t i = 1; i < index->count; ++i) {
+    diff_entry_t e = index->entries[i];
+    size_t j = i;
+
+    if (index->entries[j - 1].hash != e.hash)
+      continue;
+    while (j && diff_cmp(&index->entries[j - 1], &e) > 0) {
+      index->entries[j] = index->entries[j - 1];
+      j--;
+    }
+    index->entries[j] = e;
+  }
+
+  size_t out = 0;
+
+  for (size_t i = 0; i < index->count; ++i) {
+    if (out && !diff_cmp(&index->entries[out - 1], &index->entries[i])) {
+      index->entries[out - 1].size += index->entries[i].size;
+      index->entries[out - 1].count += index->entries[i].count;
+    } else {
+      index->entries[out++] = index->entries[i];
+    }
+  }
+  index->count = out;
+  return true;
+}
+
+/**
+ * @brief Adds an entry to an index, growing it as needed.
+ * 
+ */
+
+static bool diff_push(diff_index_t *index, size_t *cap, const char *name, uint64_t size) {
+  if (index->count == *cap) {
+    size_t n = *cap ? *cap * 2 : 1024;
+    diff_entry_t *tmp = realloc(index->entries, n * sizeof(diff_entry_t));
+
+    if (!tmp)
+      return false;
+    index->entries = tmp;
+    *cap = n;
+  }
+
+  index->entries[index->count++] = (diff_entry_t){diff_hash(name), name, size, 1};
+  return true;
+}
+
+/**
+ * @brief Indexes the defined, named symbols of a file by name.
+ * 
+ * Only the table elf_symbol_table() picks is read. Sections and file
+ * names aren't symbols worth comparing.
+ * 
+ * @return bool false if we ran out of memory.
+ */
+
+bool diff_index_symbols(elf_t *elf, diff_index_t *index) {
+  int shndx = elf_symbol_table(elf);
+  size_t cap = 0;
+
+  memset(index, 0, sizeof(diff_index_t));
+
+  if (shndx == -1)
+    return diff_sort(index);
+
+  const Elf64_Shdr *shdr = &elf->elf_section_header[shndx];
+  const Elf64_Sym *syms = (const Elf64_Sym *)elf_section_table(elf, shndx);
+  const char *strtab = elf_section_data(elf, shdr->sh_link);
+  uint64_t strsize = elf->elf_section_header[shdr->sh_link].sh_size;
+  size_t sym_num = shdr->sh_size / shdr->sh_entsize;
+
+  if (!syms || !strtab)
+    return diff_sort(index);
+
+  for (size_t j = 0; j < sym_num; ++j) {
+    unsigned char type = ELF64_ST_TYPE(syms[j].st_info);
+
+    if (syms[j].st_shndx == SHN_UNDEF || type == STT_SECTION || type == STT_FILE
+        || !*elf_string(strtab, strsize, syms[j].st_name))
+      continue;
+
+    if (!diff_push(index, &cap, elf_string(strtab, strsize, syms[j].st_name), syms[j].st_size))
+      return false;
+  }
+  return diff_sort(index);
+}
+
+/**
+ * @brief Indexes the sections of a file by name.
+ * 
+ * @return bool false if we ran out of memory.
+ */
+
+bool diff_index_sections(elf_t *elf, diff_index_t *index) {
+  size_t cap = 0;
+
+  memset(index, 0, sizeof(diff_index_t));
+
+  for (int i = 1; i < elf->elf_header->e_shnum; ++i) {
+    if (!diff_push(index, &cap, elf_section_name(elf, &elf->elf_section_header[i]),
+                   elf->elf_section_header[i].sh_size))
+      return false;
+  }
+  return diff_sort(index);
+}
+
+/**
+ * @brief Frees an index.
+ * 
+ */
+
+void diff_index_free(diff_index_t *index) {
+  free(index->entries);
+  memset(index, 0, sizeof(diff_index_t));
+}
+
+/**
+ * @brief Biggest size impact first, then by name.
+ * 
+ */
+
+static int diff_delta_cmp(const void *x, const void *y) {
+  const diff_delta_t *a = x, *b = y;
+  uint64_t da = (a->delta < 0) ? -(uint64_t)a->delta : (uint64_t)a->delta;
+  uint64_t db = (b->delta < 0) ? -(uint64_t)b->delta : (uint64_t)b->delta;
+
+  if (da != db)
+    return (da < db) ? 1 : -1;
+  return strcmp(a->name, b->name);
+}
+
+/**
+ * @brief Merge-joins two sorted indexes, keeping what was added, removed or resized.
+ * 
+ * @param deltas Where the differences go, allocated here.
+ * @return size_t How many there are, (size_t)-1 if we ran out of memory.
+ */
+
+static size_t diff_join(const diff_index_t *old, const diff_index_t *new, diff_delta_t **deltas) {
+  size_t i = 0, j = 0, n = 0;
+
+  if (!(*deltas = malloc((old->count + new->count + 1) * sizeof(diff_delta_t))))
+    return (size_t)-1;
+
+  while (i < old->count || j < new->count) {
+    int c = (i == old->count) ? 1 : (j == new->count) ? -1 : diff_cmp(&old->entries[i], &new->entries[j]);
+    const diff_entry_t *o = (c <= 0) ? &old->entries[i++] : NULL;
+    const diff_entry_t *e = (c >= 0) ? &new->entries[j++] : NULL;
+    uint64_t os = o ? o->size : 0, ns = e ? e->size : 0;
+
+    if (o && e && os == ns)
+      continue;
+
+    (*deltas)[n++] = (diff_delta_t){
+      .name = o ? o->name : e->name,
+      .old_size = os,
+      .new_size = ns,
+      .delta = (int64_t)(ns - os),
+      .status = !o ? '+' : !e ? '-' : '~'
+    };
+  }
+
+  qsort(*deltas, n, sizeof(diff_delta_t), diff_delta_cmp);
+  return n;
+}
+
+/**
+ * @brief Outputs a signed size change, always with its sign.
+ * 
+ */
+
+static void diff_signed(out_t *out, int64_t delta, unsigned int width) {
+  if (delta < 0) {
+    out_sdec(out, delta, width, OUT_LEFT);
+  } else {
+    out_char(out, '+');
+    out_udec(out, (uint64_t)delta, width ? width - 1 : 0, OUT_LEFT);
+  }
+}
+
+/**
+ * @brief Outputs one table of differences.
+ * 
+ */
+
+static void diff_dump(out_t *out, const diff_delta_t *deltas, size_t count) {
+  out_str(out, "Delta        Old          New          Status   Name\n");
+  for (size_t i = 0; i < count; ++i) {
+    diff_signed(out, deltas[i].delta, 12);
+    out_char(out, ' ');
+    out_udec(out, deltas[i].old_size, 12, OUT_LEFT);
+    out_char(out, ' ');
+    out_udec(out, deltas[i].new_size, 12, OUT_LEFT);
+    out_char(out, ' ');
+    out_pad(out, deltas[i].status == '+' ? "added" : deltas[i].status == '-' ? "removed" : "changed", 8, OUT_LEFT);
+    out_char(out, ' ');
+    out_str(out, deltas[i].name);
+    out_char(out, '\n');
+  }
+}
+
+/**
+ * @brief Outputs a summary line: how many were added, removed, changed, and the net change.
+ * 
+ */
+
+static void diff_summary(out_t *out, const char *what, const diff_delta_t *deltas, size_t count) {
+  size_t added = 0, removed = 0;
+  int64_t total = 0;
+
+  for (size_t i = 0; i < count; ++i) {
+    added += deltas[i].status == '+';
+    removed += deltas[i].status == '-';
+    total += deltas[i].delta;
+  }
+
+  out_str(out, what);
+  out_str(out, ": ");
+  out_udec(out, added, 0, 0);
+  out_str(out, " added, ");
+  out_udec(out, removed, 0, 0);
+  out_str(out, " removed, ");
+  out_udec(out, count - added - removed, 0, 0);
+  out_str(out, " changed, ");
+  diff_signed(out, total, 0);
+  out_str(out, " bytes\n");
+}
+
+/**
+ * @brief Compares the file in file->arg (old) with this one (new).
+ * 
+ * Both sides get a name index of their sections and symbols, sorted on
+ * a 64-bit hash of the name, which are then merge-joined in one pass.
+ * Differences are listed biggest size impact first.
+ * 
+ * @param file The new file, and where the output goes.
+ */
+
+void diff_files(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  int fd = open(file->arg, O_RDONLY);
+  char magic[SELFMAG] = {0};
+
+  if (fd == -1 || pread(fd, magic, SELFMAG, 0) != SELFMAG || memcmp(magic, ELFMAG, SELFMAG)) {
+    fprintf(file->err, "%s: The file provided is not an ELF file.\n", file->arg);
+    if (fd != -1)
+      close(fd);
+    return;
+  }
+
+  elf_t *old = init_elf(fd);
+  diff_index_t old_sections, new_sections, old_symbols, new_symbols;
+  diff_delta_t *sections = NULL, *symbols = NULL;
+  size_t nsections = (size_t)-1, nsymbols = (size_t)-1;
+
+  bool ok = diff_index_sections(old, &old_sections) & diff_index_sections(elf, &new_sections)
+          & diff_index_symbols(old, &old_symbols) & diff_index_symbols(elf, &new_symbols);
+
+  if (ok) {
+    nsections = diff_join(&old_sections, &new_sections, &sections);
+    nsymbols = diff_join(&old_symbols, &new_symbols, &symbols);
+  }
+
+  if (nsections == (size_t)-1 || nsymbols == (size_t)-1) {
+    fprintf(file->err, "Failed to allocate memory for the diff!\n");
+  } else {
+    diff_summary(out, "Sections", sections, nsections);
+    diff_summary(out, "Symbols", symbols, nsymbols);
+    out_str(out, "\nSections:\n");
+    diff_dump(out, sections, nsections);
+    out_str(out, "\nSymbols:\n");
+    diff_dump(out, symbols, nsymbols);
+  }
+
+  free(sections);
+  free(symbols);
+  diff_index_free(&old_sections);
+  diff_index_free(&new_sections);
+  diff_index_free(&old_symbols);
+  diff_index_free(&new_symbols);
+  destroy_parser(fd, old);
+}
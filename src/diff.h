@@ -0,0 +1,32 @@
+#ifndef _DIFF_H
+#define _DIFF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct diff_entry {
+  uint64_t hash;
+  const char *name;
+  uint64_t size;
+  uint32_t count;   /* symbols sharing the name (static functions, mostly) */
+} diff_entry_t;
+
+typedef struct diff_index {
+  diff_entry_t *entries;
+  size_t count;
+} diff_index_t;
+
+typedef struct diff_delta {
+  const char *name;
+  uint64_t old_size;
+  uint64_t new_size;
+  int64_t delta;
+  char status;      /* '+' added, '-' removed, '~' changed */
+} diff_delta_t;
+
+bool diff_index_symbols(elf_t *elf, diff_index_t *index);
+bool diff_index_sections(elf_t *elf, diff_index_t *index);
+void diff_index_free(diff_index_t *index);
+void diff_files(batch_file_t *file);
+
+#endif
@@ -0,0 +1,947 @@
+/**
+ * @file dwline.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief A sorted address to file:line index built from .debug_line.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+#define DWLINE_PATH 4096
+
+typedef struct dwline_sec {
+  const unsigned char *data;
+  uint64_t size;
+  char *owned;        /* decompressed copy of an SHF_COMPRESSED section */
+} dwline_sec_t;
+
+typedef struct dwline_cur {
+  const unsigned char *p;
+  const unsigned char *end;
+  bool bad;           /* read past the end, everything after reads as 0 */
+  bool msb;           /* big-endian file */
+} dwline_cur_t;
+
+typedef struct dwline_ent {
+  uint64_t addr;
+  uint32_t file;
+  uint32_t line;
+} dwline_ent_t;
+
+typedef struct dwline_seq {
+  uint64_t start;
+  size_t first;
+  size_t count;
+} dwline_seq_t;
+
+typedef struct dwline_builder {
+  elf_t *elf;
+  dwline_sec_t line_str;
+  dwline_sec_t str;
+  dwline_ent_t *ents;
+  size_t count, cap;
+  dwline_seq_t *seqs;
+  size_t nseqs, seqs_cap;
+  size_t seq_first;     /* first row of the open sequence */
+  char *names;
+  size_t names_len, names_cap;
+  uint32_t *files;
+  size_t nfiles, files_cap;
+  uint64_t *slots;      /* path hash << 32 | file + 1 */
+  size_t mask;
+  uint32_t *ids;        /* the unit's file numbers, as files[] indexes */
+  uint32_t unknown;     /* "??", for file numbers the unit doesn't have */
+  size_t nids, ids_cap;
+  const char **dirs;
+  size_t ndirs, dirs_cap;
+  bool oom;
+  bool msb;
+} dwline_builder_t;
+
+static inline __attribute__((always_inline)) uint64_t dwline_fixed(dwline_cur_t *c, unsigned int size) {
+  uint64_t v = 0;
+
+  if ((size_t)(c->end - c->p) < size) {
+    c->bad = true;
+    c->p = c->end;
+    return 0;
+  }
+  for (unsigned int i = 0; i < size; ++i)
+    v |= (uint64_t)c->p[c->msb ? size - 1 - i : i] << (8 * i);
+  c->p += size;
+  return v;
+}
+
+static inline __attribute__((always_inline)) uint64_t dwline_uleb(dwline_cur_t *c) {
+  uint64_t v = 0;
+  unsigned int shift = 0;
+
+  while (c->p < c->end) {
+    unsigned char b = *c->p++;
+
+    if (shift < 64)
+      v |= (uint64_t)(b & 0x7f) << shift;
+    shift += 7;
+    if (!(b & 0x80))
+      return v;
+  }
+  c->bad = true;
+  return 0;
+}
+
+static inline __attribute__((always_inline)) int64_t dwline_sleb(dwline_cur_t *c) {
+  uint64_t v = 0;
+  unsigned int shift = 0;
+
+  while (c->p < c->end) {
+    unsigned char b = *c->p++;
+
+    if (shift < 64)
+      v |= (uint64_t)(b & 0x7f) << shift;
+    shift += 7;
+    if (!(b & 0x80)) {
+      if (shift < 64 && (b & 0x40))
+        v |= ~(uint64_t)0 << shift;
+      return (int64_t)v;
+    }
+  }
+  c->bad = true;
+  return 0;
+}
+
+static inline __attribute__((always_inline)) const char *dwline_str(dwline_cur_t *c) {
+  const unsigned char *nul = memchr(c->p, '\0', c->end - c->p);
+  const char *s = (const char *)c->p;
+
+  if (!nul) {
+    c->bad = true;
+    c->p = c->end;
+    return NULL;
+  }
+  c->p = nul + 1;
+  return s;
+}
+
+/**
+ * @brief A string at `offset` of .debug_str or .debug_line_str.
+ * 
+ */
+
+static const char *dwline_strp(const dwline_sec_t *sec, uint64_t offset) {
+  if (offset >= sec->size || !memchr(sec->data + offset, '\0', sec->size - offset))
+    return NULL;
+  return (const char *)sec->data + offset;
+}
+
+/**
+ * @brief Finds a section by name, decompressing it if it is SHF_COMPRESSED.
+ * 
+ * @return bool false if there is no such section, or it couldn't be read.
+ */
+
+static bool dwline_section(elf_t *elf, const char *name, dwline_sec_t *sec) {
+  memset(sec, 0, sizeof(dwline_sec_t));
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    if (strcmp(elf_section_name(elf, shdr), name))
+      continue;
+
+    if (!(shdr->sh_flags & SHF_COMPRESSED)) {
+      sec->data = (const unsigned char *)elf_section_data(elf, i);
+      sec->size = sec->data ? shdr->sh_size : 0;
+      return sec->data != NULL;
+    }
+
+    zsec_t zs;
+    long n = 0;
+    uint64_t size;
+
+    if (!zsec_open(elf, i, &zs))
+      return false;
+    size = zs.size;
+    if ((sec->owned = malloc(size ? size : 1))) {
+      while (sec->size < size && (n = zsec_read(&zs, sec->owned + sec->size, size - sec->size)) > 0)
+        sec->size += n;
+    }
+    zsec_close(&zs);
+
+    if (!sec->owned || sec->size != size) {
+      free(sec->owned);
+      memset(sec, 0, sizeof(dwline_sec_t));
+      return false;
+    }
+    sec->data = (const unsigned char *)sec->owned;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Grows an array to hold at least `need` elements.
+ * 
+ */
+
+static bool dwline_grow(void **array, size_t *cap, size_t need, size_t size) {
+  if (need <= *cap)
+    return true;
+
+  size_t n = *cap ? *cap : 256;
+
+  while (n < need)
+    n *= 2;
+
+  void *tmp = realloc(*array, n * size);
+
+  if (!tmp)
+    return false;
+  *array = tmp;
+  *cap = n;
+  return true;
+}
+
+static inline __attribute__((always_inline)) uint32_t dwline_hash(const char *s) {
+  uint64_t h = 0xcbf29ce484222325ull;
+
+  for (; *s; ++s)
+    h = (h ^ (unsigned char)*s) * 0x100000001b3ull;
+  return (uint32_t)(h ^ (h >> 32));
+}
+
+/**
+ * @brief The file number of a path, every path is stored once for the whole table.
+ * 
+ * @return uint32_t The index in files[], DWLINE_NONE if we ran out of memory.
+ */
+
+static uint32_t dwline_intern(dwline_builder_t *b, const char *path) {
+  uint64_t hash = dwline_hash(path);
+  size_t len = strlen(path) + 1;
+
+  if ((b->nfiles + 1) * 2 > b->mask + 1) {
+    size_t size = b->mask ? (b->mask + 1) * 2 : 1024;
+    uint64_t *slots = calloc(size, sizeof(uint64_t));
+
+    if (!slots)
+      return DWLINE_NONE;
+    for (size_t i = 0; b->slots && i <= b->mask; ++i) {
+      size_t slot = (b->slots[i] >> 32) & (size - 1);
+
+      if (!b->slots[i])
+        continue;
+      while (slots[slot])
+        slot = (slot + 1) & (size - 1);
+      slots[slot] = b->slots[i];
+    }
+    free(b->slots);
+    b->slots = slots;
+    b->mask = size - 1;
+  }
+
+  size_t slot = hash & b->mask;
+
+  for (; b->slots[slot]; slot = (slot + 1) & b->mask) {
+    uint32_t id = (uint32_t)b->slots[slot] - 1;
+
+    if ((b->slots[slot] >> 32) == hash && !strcmp(b->names + b->files[id], path))
+      return id;
+  }
+
+  if (!dwline_grow((void **)&b->names, &b->names_cap, b->names_len + len, 1)
+      || !dwline_grow((void **)&b->files, &b->files_cap, b->nfiles + 1, sizeof(uint32_t)))
+    return DWLINE_NONE;
+
+  memcpy(b->names + b->names_len, path, len);
+  b->files[b->nfiles] = (uint32_t)b->names_len;
+  b->names_len += len;
+  b->slots[slot] = (hash << 32) | (b->nfiles + 1);
+  return (uint32_t)b->nfiles++;
+}
+
+/**
+ * @brief Adds one file of the unit's file table, as dir/name.
+ * 
+ * @param comp The compilation directory, relative directories are under it (DWARF 5).
+ */
+
+static void dwline_add_file(dwline_builder_t *b, const char *comp, const char *dir, const char *name) {
+  char path[DWLINE_PATH];
+  uint32_t id;
+
+  if (!name)
+    name = "??";
+  if (name[0] == '/' || !dir || !dir[0])
+    snprintf(path, sizeof(path), "%s", name);
+  else if (dir[0] != '/' && comp && comp[0] && comp != dir)
+    snprintf(path, sizeof(path), "%s/%s/%s", comp, dir, name);
+  else
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+  if ((id = dwline_intern(b, path)) == DWLINE_NONE
+      || !dwline_grow((void **)&b->ids, &b->ids_cap, b->nids + 1, sizeof(uint32_t))) {
+    b->oom = true;
+    return;
+  }
+  b->ids[b->nids++] = id;
+}
+
+static inline __attribute__((always_inline)) void dwline_emit(dwline_builder_t *b, uint64_t addr, uint32_t file, uint32_t line) {
+  if (b->count == b->cap && !dwline_grow((void **)&b->ents, &b->cap, b->count + 1, sizeof(dwline_ent_t))) {
+    b->oom = true;
+    return;
+  }
+  b->ents[b->count++] = (dwline_ent_t){addr, file, line};
+}
+
+/**
+ * @brief Closes a sequence, dropping it if it doesn't start inside a loaded section.
+ * 
+ * Linkers leave the line programs of discarded functions behind with an
+ * address of 0 (or -1), those would shadow real code in the lookups.
+ * Relocatable objects keep everything, their addresses are all 0-based.
+ */
+
+static void dwline_end_sequence(dwline_builder_t *b) {
+  elf_t *elf = b->elf;
+  size_t first = b->seq_first;
+  bool keep = elf->elf_header->e_type == ET_REL;
+
+  if (first == b->count)
+    return;
+
+  for (int i = 0; !keep && i < elf->elf_header->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    keep = (shdr->sh_flags & SHF_ALLOC) && b->ents[first].addr >= shdr->sh_addr
+           && b->ents[first].addr - shdr->sh_addr < shdr->sh_size;
+  }
+
+  if (!keep) {
+    b->count = first;
+    return;
+  }
+
+  if (!dwline_grow((void **)&b->seqs, &b->seqs_cap, b->nseqs + 1, sizeof(dwline_seq_t))) {
+    b->oom = true;
+    return;
+  }
+  b->seqs[b->nseqs++] = (dwline_seq_t){b->ents[first].addr, first, b->count - first};
+  b->seq_first = b->count;
+}
+
+/**
+ * @brief Reads one attribute of a DWARF 5 directory or file entry.
+ * 
+ * @return bool false for forms a line table header has no business using.
+ */
+
+static bool dwline_form(dwline_builder_t *b, dwline_cur_t *c, uint64_t form, bool dwarf64,
+                        const char **string, uint64_t *value) {
+  *string = NULL;
+  *value = 0;
+
+  switch (form) {
+    case DW_FORM_string:    *string = dwline_str(c); break;
+    case DW_FORM_line_strp: *string = dwline_strp(&b->line_str, dwline_fixed(c, dwarf64 ? 8 : 4)); break;
+    case DW_FORM_strp:      *string = dwline_strp(&b->str, dwline_fixed(c, dwarf64 ? 8 : 4)); break;
+    case DW_FORM_udata:     *value = dwline_uleb(c); break;
+    case DW_FORM_data1:     *value = dwline_fixed(c, 1); break;
+    case DW_FORM_data2:     *value = dwline_fixed(c, 2); break;
+    case DW_FORM_data4:     *value = dwline_fixed(c, 4); break;
+    case DW_FORM_data8:     *value = dwline_fixed(c, 8); break;
+    case DW_FORM_data16:    dwline_fixed(c, 8); dwline_fixed(c, 8); break;
+    case DW_FORM_block: {
+      uint64_t len = dwline_uleb(c);
+
+      if (len > (uint64_t)(c->end - c->p))
+        c->bad = true;
+      else
+        c->p += len;
+      break;
+    }
+    default:
+      return false;
+  }
+  return !c->bad;
+}
+
+/**
+ * @brief Reads a DWARF 5 directory or file name table.
+ * 
+ * @param dirs true for the directories, false for the files.
+ */
+
+static bool dwline_table_v5(dwline_builder_t *b, dwline_cur_t *c, bool dwarf64, bool dirs) {
+  uint64_t formats[16][2];
+  unsigned int nformats = (unsigned int)dwline_fixed(c, 1);
+
+  if (nformats > 16)
+    return false;
+  for (unsigned int i = 0; i < nformats; ++i) {
+    formats[i][0] = dwline_uleb(c);
+    formats[i][1] = dwline_uleb(c);
+  }
+
+  uint64_t count = dwline_uleb(c);
+
+  for (uint64_t n = 0; n < count && !c->bad && !b->oom; ++n) {
+    const char *path = NULL;
+    uint64_t dir = 0;
+
+    for (unsigned int i = 0; i < nformats; ++i) {
+      const char *string;
+      uint64_t value;
+
+      if (!dwline_form(b, c, formats[i][1], dwarf64, &string, &value))
+        return false;
+      if (formats[i][0] == DW_LNCT_path)
+        path = string;
+      else if (formats[i][0] == DW_LNCT_directory_index)
+        dir = value;
+    }
+
+    if (dirs) {
+      if (!dwline_grow((void **)&b->dirs, &b->dirs_cap, b->ndirs + 1, sizeof(char *))) {
+        b->oom = true;
+        return false;
+      }
+      b->dirs[b->ndirs++] = path;
+    } else {
+      dwline_add_file(b, b->ndirs ? b->dirs[0] : NULL, (dir < b->ndirs) ? b->dirs[dir] : NULL, path);
+    }
+  }
+  return !c->bad;
+}
+
+/**
+ * @brief Reads the directory and file tables of DWARF 2 to 4.
+ * 
+ * Directory 0 is the compilation directory, which only .debug_info knows,
+ * so files in it keep their bare name.
+ */
+
+static bool dwline_table_v4(dwline_builder_t *b, dwline_cur_t *c) {
+  b->ndirs = 0;
+  if (!dwline_grow((void **)&b->dirs, &b->dirs_cap, 1, sizeof(char *)))
+    return false;
+  b->dirs[b->ndirs++] = NULL;
+
+  while (c->p < c->end && *c->p) {
+    const char *dir = dwline_str(c);
+
+    if (!dwline_grow((void **)&b->dirs, &b->dirs_cap, b->ndirs + 1, sizeof(char *)))
+      return false;
+    b->dirs[b->ndirs++] = dir;
+  }
+  dwline_fixed(c, 1);
+
+  /* file numbers start at 1 */
+  if (!dwline_grow((void **)&b->ids, &b->ids_cap, 1, sizeof(uint32_t)))
+    return false;
+  b->ids[b->nids++] = b->unknown;
+  while (c->p < c->end && *c->p && !b->oom) {
+    const char *name = dwline_str(c);
+    uint64_t dir = dwline_uleb(c);
+
+    dwline_uleb(c);
+    dwline_uleb(c);
+    dwline_add_file(b, NULL, (dir < b->ndirs) ? b->dirs[dir] : NULL, name);
+  }
+  dwline_fixed(c, 1);
+  return !c->bad && !b->oom;
+}
+
+/**
+ * @brief Decodes one line number program unit, header and program.
+ * 
+ * Malformed or unsupported units are dropped as a whole; whatever the
+ * state machine had emitted for them is taken back.
+ */
+
+static void dwline_unit(dwline_builder_t *b, const unsigned char *p, const unsigned char *end, bool dwarf64) {
+  dwline_cur_t c = {p, end, false, b->msb};
+  size_t rollback_rows = b->count, rollback_seqs = b->nseqs;
+  unsigned int version = (unsigned int)dwline_fixed(&c, 2);
+
+  if (version < 2 || version > 5)
+    return;
+  if (version >= 5) {
+    /* address and segment selector size, DW_LNE_set_address says it again */
+    dwline_fixed(&c, 1);
+    dwline_fixed(&c, 1);
+  }
+
+  uint64_t header_length = dwline_fixed(&c, dwarf64 ? 8 : 4);
+
+  if (c.bad || header_length > (uint64_t)(end - c.p))
+    return;
+
+  const unsigned char *program = c.p + header_length;
+  unsigned int min_inst = (unsigned int)dwline_fixed(&c, 1);
+
+  if (version >= 4)
+    dwline_fixed(&c, 1);    /* maximum_operations_per_instruction, VLIW only */
+
+  dwline_fixed(&c, 1);      /* default_is_stmt, every row counts here */
+  int line_base = (int8_t)dwline_fixed(&c, 1);
+  unsigned int line_range = (unsigned int)dwline_fixed(&c, 1);
+  unsigned int opcode_base = (unsigned int)dwline_fixed(&c, 1);
+  const unsigned char *lengths = c.p;
+
+  if (c.bad || !line_range || !opcode_base || opcode_base - 1 > (size_t)(program - c.p))
+    return;
+  c.p += opcode_base - 1;
+  c.end = program;
+
+  b->nids = 0;
+  b->ndirs = 0;
+  if (version >= 5 ? !dwline_table_v5(b, &c, dwarf64, true) || !dwline_table_v5(b, &c, dwarf64, false)
+                   : !dwline_table_v4(b, &c))
+    return;
+
+  uint64_t addr = 0;
+  uint64_t file = 1;
+  int64_t line = 1;
+
+  c = (dwline_cur_t){program, end, false, b->msb};
+  b->seq_first = b->count;
+
+  while (c.p < c.end && !c.bad && !b->oom) {
+    unsigned int op = *c.p++;
+    uint32_t id = (file < b->nids) ? b->ids[file] : b->unknown;
+
+    if (op >= opcode_base) {
+      unsigned int adj = op - opcode_base;
+
+      addr += (uint64_t)(adj / line_range) * min_inst;
+      line += line_base + (int)(adj % line_range);
+      dwline_emit(b, addr, id, (uint32_t)line);
+      continue;
+    }
+
+    switch (op) {
+      case 0: {
+        uint64_t len = dwline_uleb(&c);
+        const unsigned char *next = c.p + len;
+
+        if (!len || len > (uint64_t)(c.end - c.p)) {
+          c.bad = true;
+          break;
+        }
+        switch (*c.p++) {
+          case DW_LNE_end_sequence:
+            dwline_emit(b, addr, DWLINE_NONE, 0);
+            dwline_end_sequence(b);
+            addr = 0;
+            file = 1;
+            line = 1;
+            break;
+          case DW_LNE_set_address:
+            if (len - 1 <= 8)
+              addr = dwline_fixed(&c, (unsigned int)len - 1);
+            break;
+          default:
+            break;
+        }
+        c.p = next;
+        break;
+      }
+      case DW_LNS_copy:
+        dwline_emit(b, addr, id, (uint32_t)line);
+        break;
+      case DW_LNS_advance_pc:
+        addr += dwline_uleb(&c) * min_inst;
+        break;
+      case DW_LNS_advance_line:
+        line += dwline_sleb(&c);
+        break;
+      case DW_LNS_set_file:
+        file = dwline_uleb(&c);
+        break;
+      case DW_LNS_const_add_pc:
+        addr += (uint64_t)((255 - opcode_base) / line_range) * min_inst;
+        break;
+      case DW_LNS_fixed_advance_pc:
+        addr += dwline_fixed(&c, 2);
+        break;
+      default:
+        /* everything else (column, is_stmt, ...) only has ULEB operands we don't need */
+        for (unsigned int i = 0; i < lengths[op - 1]; ++i)
+          dwline_uleb(&c);
+        break;
+    }
+  }
+
+  if (c.bad) {
+    b->count = rollback_rows;
+    b->nseqs = rollback_seqs;
+  } else {
+    /* a program that doesn't end its last sequence, keep what it said */
+    dwline_end_sequence(b);
+  }
+}
+
+static int dwline_seq_cmp(const void *x, const void *y) {
+  const dwline_seq_t *a = x, *b = y;
+
+  if (a->start != b->start)
+    return (a->start < b->start) ? -1 : 1;
+  return (a->first > b->first) - (a->first < b->first);
+}
+
+static int dwline_ent_cmp(const void *x, const void *y) {
+  const dwline_ent_t *a = *(const dwline_ent_t *const *)x, *b = *(const dwline_ent_t *const *)y;
+
+  if (a->addr != b->addr)
+    return (a->addr < b->addr) ? -1 : 1;
+  return (a > b) - (a < b);
+}
+
+/**
+ * @brief Puts the rows in address order and packs them into the table.
+ * 
+ * Sequences are sorted on their first address and laid end to end; rows
+ * within a sequence already ascend, so that's normally all it takes.
+ * Overlapping sequences (relocatables) fall back to sorting every row.
+ * Of rows at the same address the last one wins, and rows that repeat the
+ * file and line of the one before are dropped: lookups can't tell.
+ */
+
+static bool dwline_pack(dwline_builder_t *b, dwline_t *table) {
+  dwline_ent_t *sorted = malloc((b->count ? b->count : 1) * sizeof(dwline_ent_t));
+  const dwline_ent_t **order = NULL;
+  size_t n = 0;
+
+  if (!sorted)
+    return false;
+
+  qsort(b->seqs, b->nseqs, sizeof(dwline_seq_t), dwline_seq_cmp);
+  for (size_t i = 0; i < b->nseqs; ++i) {
+    memcpy(sorted + n, b->ents + b->seqs[i].first, b->seqs[i].count * sizeof(dwline_ent_t));
+    n += b->seqs[i].count;
+  }
+
+  bool ascending = true;
+
+  for (size_t i = 1; i < n && ascending; ++i)
+    ascending = sorted[i - 1].addr <= sorted[i].addr;
+
+  if (!ascending) {
+    if (!(order = malloc(n * sizeof(dwline_ent_t *)))) {
+      free(sorted);
+      return false;
+    }
+    for (size_t i = 0; i < n; ++i)
+      order[i] = &sorted[i];
+    qsort(order, n, sizeof(dwline_ent_t *), dwline_ent_cmp);
+  }
+
+  table->addrs = malloc((n ? n : 1) * sizeof(uint64_t));
+  table->rows = malloc((n ? n : 1) * sizeof(dwline_row_t));
+  if (!table->addrs || !table->rows) {
+    free(order);
+    free(sorted);
+    return false;
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    const dwline_ent_t *e = order ? order[i] : &sorted[i];
+
+    while (table->count && table->addrs[table->count - 1] == e->addr)
+      table->count--;
+    if (table->count && table->rows[table->count - 1].file == e->file && table->rows[table->count - 1].line == e->line)
+      continue;
+    table->addrs[table->count] = e->addr;
+    table->rows[table->count++] = (dwline_row_t){e->file, e->line};
+  }
+
+  free(order);
+  free(sorted);
+  return true;
+}
+
+/**
+ * @brief Runs every line number program in .debug_line once and builds the table.
+ * 
+ * DWARF 2 to 5, 32 and 64-bit units, compressed sections included. Units
+ * that can't be decoded are skipped, the rest still make it in.
+ * 
+ * @param elf A pointer to the struct.
+ * @param table The table to fill in, empty if there is no .debug_line.
+ * @return bool false if we ran out of memory.
+ */
+
+bool dwline_build(elf_t *elf, dwline_t *table) {
+  dwline_builder_t b = {.elf = elf, .msb = elf->elf_header->e_ident[EI_DATA] == ELFDATA2MSB};
+  dwline_sec_t line;
+  bool ok = true;
+
+  memset(table, 0, sizeof(dwline_t));
+
+  if (!dwline_section(elf, ".debug_line", &line))
+    return true;
+  dwline_section(elf, ".debug_line_str", &b.line_str);
+  dwline_section(elf, ".debug_str", &b.str);
+  b.unknown = dwline_intern(&b, "??");
+  b.oom = (b.unknown == DWLINE_NONE);
+
+  for (dwline_cur_t c = {line.data, line.data + line.size, false, b.msb}; c.p < c.end && !b.oom;) {
+    uint64_t len = dwline_fixed(&c, 4);
+    bool dwarf64 = (len == 0xffffffff);
+
+    if (dwarf64)
+      len = dwline_fixed(&c, 8);
+    if (c.bad || len > (uint64_t)(c.end - c.p))
+      break;
+    dwline_unit(&b, c.p, c.p + len, dwarf64);
+    c.p += len;
+  }
+
+  if (b.oom || !dwline_pack(&b, table)) {
+    ok = false;
+  } else {
+    /* the paths move over as they are */
+    table->files = b.files;
+    table->names = b.names;
+    table->nfiles = b.nfiles;
+    table->names_len = b.names_len;
+    b.files = NULL;
+    b.names = NULL;
+  }
+
+  free(b.ents);
+  free(b.seqs);
+  free(b.names);
+  free(b.files);
+  free(b.slots);
+  free(b.ids);
+  free(b.dirs);
+  free(line.owned);
+  free(b.line_str.owned);
+  free(b.str.owned);
+  if (!ok)
+    dwline_destroy(table);
+  return ok;
+}
+
+/**
+ * @brief Maps a table written by dwline_store(), used in place.
+ * 
+ * @param file_size The size of the ELF file, a stale table won't match it.
+ * @return bool false if there is none, or it doesn't check out.
+ */
+
+bool dwline_load(dwline_t *table, const char *path, uint64_t file_size) {
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  dwline_header_t hdr;
+
+  memset(table, 0, sizeof(dwline_t));
+  if (fd == -1)
+    return false;
+
+  bool valid = fstat(fd, &st) != -1
+               && pread(fd, &hdr, sizeof(hdr), 0) == sizeof(hdr)
+               && !memcmp(hdr.magic, DWLINE_MAGIC, sizeof(hdr.magic))
+               && hdr.file_size == file_size
+               && hdr.rows < ((uint64_t)1 << 40) && hdr.files < ((uint64_t)1 << 32) && hdr.names < ((uint64_t)1 << 40)
+               && sizeof(hdr) + hdr.rows * (sizeof(uint64_t) + sizeof(dwline_row_t))
+                  + hdr.files * sizeof(uint32_t) + hdr.names == (uint64_t)st.st_size;
+  char *map = valid ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+
+  close(fd);
+  if (map == MAP_FAILED)
+    return false;
+
+  table->map = map;
+  table->map_len = st.st_size;
+  table->count = hdr.rows;
+  table->nfiles = hdr.files;
+  table->names_len = hdr.names;
+  table->addrs = (uint64_t *)(map + sizeof(hdr));
+  table->rows = (dwline_row_t *)(table->addrs + hdr.rows);
+  table->files = (uint32_t *)(table->rows + hdr.rows);
+  table->names = (char *)(table->files + hdr.files);
+
+  /* every lookup trusts these, check them once */
+  valid = !hdr.names || !table->names[hdr.names - 1];
+  for (size_t i = 0; valid && i < table->nfiles; ++i)
+    valid = table->files[i] < hdr.names;
+  for (size_t i = 0; valid && i < table->count; ++i)
+    valid = (table->rows[i].file < table->nfiles || table->rows[i].file == DWLINE_NONE)
+            && (!i || table->addrs[i - 1] < table->addrs[i]);
+
+  if (!valid)
+    dwline_destroy(table);
+  return valid;
+}
+
+/**
+ * @brief Writes the table out for dwline_load(), through a temporary file and a rename.
+ * 
+ * @return bool false if it couldn't be written, the table still works.
+ */
+
+bool dwline_store(const dwline_t *table, const char *path, uint64_t file_size) {
+  char tmp[DWLINE_PATH];
+  dwline_header_t hdr = {.file_size = file_size, .rows = table->count, .files = table->nfiles, .names = table->names_len};
+
+  memcpy(hdr.magic, DWLINE_MAGIC, sizeof(hdr.magic));
+  if ((size_t)snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path) >= sizeof(tmp))
+    return false;
+
+  int fd = mkstemp(tmp);
+
+  if (fd == -1)
+    return false;
+
+  bool ok = write(fd, &hdr, sizeof(hdr)) == (ssize_t)sizeof(hdr)
+            && write(fd, table->addrs, table->count * sizeof(uint64_t)) == (ssize_t)(table->count * sizeof(uint64_t))
+            && write(fd, table->rows, table->count * sizeof(dwline_row_t)) == (ssize_t)(table->count * sizeof(dwline_row_t))
+            && write(fd, table->files, table->nfiles * sizeof(uint32_t)) == (ssize_t)(table->nfiles * sizeof(uint32_t))
+            && write(fd, table->names, table->names_len) == (ssize_t)table->names_len;
+
+  close(fd);
+  if (!ok || rename(tmp, path) == -1) {
+    unlink(tmp);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Finds the row that covers `addr`: the last one at or below it.
+ * 
+ * A branchless binary search, the compiler turns the step into a cmov.
+ * 
+ * @return long The row, -1 if no line covers the address.
+ */
+
+long dwline_find(const dwline_t *table, uint64_t addr) {
+  const uint64_t *base = table->addrs;
+  size_t n = table->count;
+
+  if (!n || addr < base[0])
+    return -1;
+
+  while (n > 1) {
+    size_t half = n / 2;
+
+    base = (base[half] <= addr) ? base + half : base;
+    n -= half;
+  }
+
+  long row = base - table->addrs;
+
+  return (table->rows[row].file == DWLINE_NONE) ? -1 : row;
+}
+
+/**
+ * @brief Frees the table, or unmaps it.
+ * 
+ */
+
+void dwline_destroy(dwline_t *table) {
+  if (table->map) {
+    munmap(table->map, table->map_len);
+  } else {
+    free(table->addrs);
+    free(table->rows);
+    free(table->files);
+    free(table->names);
+  }
+  memset(table, 0, sizeof(dwline_t));
+}
+
+/**
+ * @brief Resolves every address read from file->arg (a file, or - for stdin) to file:line.
+ * 
+ * The table is built once per file; with -c it is kept in the cache
+ * directory (ln-<dev/inode/size/mtime>.ec) and mapped straight back on
+ * the next run. Answers come one per line, `0xaddr path:line` or `0xaddr ??`.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void resolve_lines(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  size_t len = 0;
+  char *input = addr_input(file->arg, &len);
+  char path[DWLINE_PATH];
+  struct stat st;
+  dwline_t table;
+
+  if (!input)
+    return;
+
+  bool persist = file->index_dir && !stat(file->path, &st) && S_ISREG(st.st_mode);
+
+  if (persist)
+    cache_entry_path(file->index_dir, "ln", &st, path, sizeof(path));
+
+  if (!persist || !dwline_load(&table, path, elf->size)) {
+    if (!dwline_build(elf, &table)) {
+      free(input);
+      error_handling(-1, NULL, NULL, "Failed to allocate memory for the line table!");
+    }
+    if (persist && !dwline_store(&table, path, elf->size))
+      fprintf(file->err, "%s: Failed to store the line table.\n", path);
+  }
+
+  if (!table.count)
+    fprintf(file->err, "%s: There is no line information.\n", file->path);
+
+  uint64_t *addrs = malloc(ADDR_CHUNK * sizeof(uint64_t));
+  const char **tokens = malloc(ADDR_CHUNK * sizeof(char *));
+
+  if (!addrs || !tokens) {
+    free(input);
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the addresses!");
+  }
+
+  for (const char *p = input, *end = input + len; p < end;) {
+    size_t n = addr_parse(&p, end, addrs, tokens, ADDR_CHUNK);
+
+    for (size_t i = 0; i < n; ++i) {
+      if (tokens[i]) {
+        addr_junk(file->out, tokens[i], end);
+        continue;
+      }
+
+      long row = dwline_find(&table, addrs[i]);
+
+      out_write(file->out, "0x", 2);
+      out_hex(file->out, addrs[i], 0, 0, 0);
+      if (row < 0) {
+        out_str(file->out, " ??\n");
+        continue;
+      }
+      out_char(file->out, ' ');
+      out_str(file->out, table.names + table.files[table.rows[row].file]);
+      out_char(file->out, ':');
+      out_udec(file->out, table.rows[row].line, 0, 0);
+      out_char(file->out, '\n');
+    }
+  }
+
+  dwline_destroy(&table);
+  free(tokens);
+  free(addrs);
+  free(input);
+}
@@ -0,0 +1,64 @@
+#ifndef _DWLINE_H
+#define _DWLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DWLINE_MAGIC "ELFIEL01"
+#define DWLINE_NONE UINT32_MAX   /* file of the rows that end a sequence */
+
+/* line number program opcodes, forms and content types, elf.h has none of them */
+#define DW_LNS_copy 0x01
+#define DW_LNS_advance_pc 0x02
+#define DW_LNS_advance_line 0x03
+#define DW_LNS_set_file 0x04
+#define DW_LNS_const_add_pc 0x08
+#define DW_LNS_fixed_advance_pc 0x09
+#define DW_LNE_end_sequence 0x01
+#define DW_LNE_set_address 0x02
+#define DW_LNCT_path 0x1
+#define DW_LNCT_directory_index 0x2
+#define DW_FORM_block 0x09
+#define DW_FORM_data1 0x0b
+#define DW_FORM_data2 0x05
+#define DW_FORM_data4 0x06
+#define DW_FORM_data8 0x07
+#define DW_FORM_data16 0x1e
+#define DW_FORM_string 0x08
+#define DW_FORM_strp 0x0e
+#define DW_FORM_udata 0x0f
+#define DW_FORM_line_strp 0x1f
+
+typedef struct dwline_row {
+  uint32_t file;     /* index into files, DWLINE_NONE past the end of a sequence */
+  uint32_t line;
+} dwline_row_t;
+
+typedef struct dwline_header {
+  char magic[8];
+  uint64_t file_size; /* of the ELF file it was built from */
+  uint64_t rows;
+  uint64_t files;
+  uint64_t names;     /* bytes of NUL terminated paths */
+} dwline_header_t;
+
+typedef struct dwline {
+  uint64_t *addrs;    /* sorted, one per row */
+  dwline_row_t *rows;
+  uint32_t *files;    /* offsets of the paths in names */
+  char *names;
+  size_t count;
+  size_t nfiles;
+  size_t names_len;
+  void *map;          /* the whole table when it was loaded from a file */
+  size_t map_len;
+} dwline_t;
+
+bool dwline_build(elf_t *elf, dwline_t *table);
+bool dwline_load(dwline_t *table, const char *path, uint64_t file_size);
+bool dwline_store(const dwline_t *table, const char *path, uint64_t file_size);
+long dwline_find(const dwline_t *table, uint64_t addr);
+void dwline_destroy(dwline_t *table);
+void resolve_lines(batch_file_t *file);
+
+#endif
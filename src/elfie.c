@@ -23,90 +23,1270 @@
 #include "all.h"
 
 /**
- * @brief Returns the size of the ELF file.
+ * @brief The allocator used when the caller doesn't bring one, plain libc.
  * 
  */
 
-static inline __attribute__((always_inline)) size_t get_elf_size(int fd) {
-  struct stat st_stat = {0};
+static void *std_alloc(void *ctx, size_t size) {
+  (void)ctx;
+  return malloc(size);
+}
+
+static void *std_resize(void *ctx, void *ptr, size_t size) {
+  (void)ctx;
+  return realloc(ptr, size);
+}
+
+static void std_release(void *ctx, void *ptr) {
+  (void)ctx;
+  free(ptr);
+}
+
+static const elf_alloc_t std_allocator = {std_alloc, std_resize, std_release, NULL};
+
+/* what .shstrtab reads as in files without one, never written to */
+static char no_names[1];
+
+/**
+ * @brief Checks if the file mapped in memory is actually an ELF file or not.
+ * 
+ */
 
-  return ((fstat(fd, &st_stat) == -1) ? 0 : st_stat.st_size);
+static inline __attribute__((always_inline)) bool check_magic_bytes(const char *file) {
+  return (!memcmp(file, ELFMAG, SELFMAG) ? true : false);
 }
 
+/* the byte order of the machine we run on, the one parsed structs are kept in */
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define ELF_HOST_DATA ELFDATA2LSB
+#else
+#define ELF_HOST_DATA ELFDATA2MSB
+#endif
+
+/* sizeof() is a constant, each use folds down to one load, or one load and a bswap */
+#define ELF_KEEP(x) ((uint64_t)(x))
+#define ELF_SWAP(x) (sizeof(x) == 8 ? (uint64_t)__builtin_bswap64(x) : sizeof(x) == 4 ? (uint64_t)__builtin_bswap32(x) \
+                     : sizeof(x) == 2 ? (uint64_t)__builtin_bswap16(x) : (uint64_t)(x))
+
+typedef void (*elf_convert_t)(void *dst, const void *src, size_t count);
+
+/* how one (class, byte order) pair is turned into native Elf64 structs */
+struct elf_conv {
+  unsigned char elf_class;
+  bool swap;
+  size_t ehdr_size, phdr_size, shdr_size, sym_size, dyn_size, rel_size, rela_size, addr_size, chdr_size;
+  elf_convert_t ehdr, phdrs, shdrs, syms, dyns, rels, relas, addrs, words, halves, chdr;
+};
+
+struct elf_tables {
+  pthread_mutex_t lock;
+  void *table[]; /* per section and one for PT_DYNAMIC, converted on first use */
+};
+
+/**
+ * @brief Generates the converters of one (class, byte order) pair.
+ * 
+ * Every field is read through SW, ELF_KEEP or ELF_SWAP, at the width of
+ * the source struct, so each instance is a straight loop of loads and
+ * stores with nothing decided per field. Signed fields go back through
+ * their own type first, to be sign extended.
+ */
+
+#define ELF_CONVERTERS(name, C, SW, SWAPPED) \
+  static void name##_ehdr(void *dst, const void *src, size_t count) { \
+    Elf64_Ehdr *d = dst; \
+    const Elf##C##_Ehdr *s = src; \
+    (void)count; \
+    memcpy(d->e_ident, s->e_ident, EI_NIDENT); \
+    d->e_type = SW(s->e_type); \
+    d->e_machine = SW(s->e_machine); \
+    d->e_version = SW(s->e_version); \
+    d->e_entry = SW(s->e_entry); \
+    d->e_phoff = SW(s->e_phoff); \
+    d->e_shoff = SW(s->e_shoff); \
+    d->e_flags = SW(s->e_flags); \
+    d->e_ehsize = SW(s->e_ehsize); \
+    d->e_phentsize = SW(s->e_phentsize); \
+    d->e_phnum = SW(s->e_phnum); \
+    d->e_shentsize = SW(s->e_shentsize); \
+    d->e_shnum = SW(s->e_shnum); \
+    d->e_shstrndx = SW(s->e_shstrndx); \
+  } \
+  static void name##_phdrs(void *dst, const void *src, size_t count) { \
+    Elf64_Phdr *d = dst; \
+    const Elf##C##_Phdr *s = src; \
+    for (size_t i = 0; i < count; ++i) { \
+      d[i].p_type = SW(s[i].p_type); \
+      d[i].p_flags = SW(s[i].p_flags); \
+      d[i].p_offset = SW(s[i].p_offset); \
+      d[i].p_vaddr = SW(s[i].p_vaddr); \
+      d[i].p_paddr = SW(s[i].p_paddr); \
+      d[i].p_filesz = SW(s[i].p_filesz); \
+      d[i].p_memsz = SW(s[i].p_memsz); \
+      d[i].p_align = SW(s[i].p_align); \
+    } \
+  } \
+  static void name##_shdrs(void *dst, const void *src, size_t count) { \
+    Elf64_Shdr *d = dst; \
+    const Elf##C##_Shdr *s = src; \
+    for (size_t i = 0; i < count; ++i) { \
+      d[i].sh_name = SW(s[i].sh_name); \
+      d[i].sh_type = SW(s[i].sh_type); \
+      d[i].sh_flags = SW(s[i].sh_flags); \
+      d[i].sh_addr = SW(s[i].sh_addr); \
+      d[i].sh_offset = SW(s[i].sh_offset); \
+      d[i].sh_size = SW(s[i].sh_size); \
+      d[i].sh_link = SW(s[i].sh_link); \
+      d[i].sh_info = SW(s[i].sh_info); \
+      d[i].sh_addralign = SW(s[i].sh_addralign); \
+      d[i].sh_entsize = SW(s[i].sh_entsize); \
+    } \
+  } \
+  static void name##_syms(void *dst, const void *src, size_t count) { \
+    Elf64_Sym *d = dst; \
+    const Elf##C##_Sym *s = src; \
+    for (size_t i = 0; i < count; ++i) { \
+      d[i].st_name = SW(s[i].st_name); \
+      d[i].st_info = s[i].st_info; \
+      d[i].st_other = s[i].st_other; \
+      d[i].st_shndx = SW(s[i].st_shndx); \
+      d[i].st_value = SW(s[i].st_value); \
+      d[i].st_size = SW(s[i].st_size); \
+    } \
+  } \
+  static void name##_dyns(void *dst, const void *src, size_t count) { \
+    Elf64_Dyn *d = dst; \
+    const Elf##C##_Dyn *s = src; \
+    for (size_t i = 0; i < count; ++i) { \
+      d[i].d_tag = (__typeof__(s[i].d_tag))SW(s[i].d_tag); \
+      d[i].d_un.d_val = SW(s[i].d_un.d_val); \
+    } \
+  } \
+  static void name##_rels(void *dst, const void *src, size_t count) { \
+    Elf64_Rel *d = dst; \
+    const Elf##C##_Rel *s = src; \
+    for (size_t i = 0; i < count; ++i) { \
+      __typeof__(s[i].r_info) info = SW(s[i].r_info); \
+      d[i].r_offset = SW(s[i].r_offset); \
+      d[i].r_info = ELF64_R_INFO(ELF##C##_R_SYM(info), ELF##C##_R_TYPE(info)); \
+    } \
+  } \
+  static void name##_relas(void *dst, const void *src, size_t count) { \
+    Elf64_Rela *d = dst; \
+    const Elf##C##_Rela *s = src; \
+    for (size_t i = 0; i < count; ++i) { \
+      __typeof__(s[i].r_info) info = SW(s[i].r_info); \
+      d[i].r_offset = SW(s[i].r_offset); \
+      d[i].r_info = ELF64_R_INFO(ELF##C##_R_SYM(info), ELF##C##_R_TYPE(info)); \
+      d[i].r_addend = (__typeof__(s[i].r_addend))SW(s[i].r_addend); \
+    } \
+  } \
+  static void name##_addrs(void *dst, const void *src, size_t count) { \
+    uint64_t *d = dst; \
+    const Elf##C##_Addr *s = src; \
+    for (size_t i = 0; i < count; ++i) \
+      d[i] = SW(s[i]); \
+  } \
+  static void name##_words(void *dst, const void *src, size_t count) { \
+    Elf64_Word *d = dst; \
+    const Elf##C##_Word *s = src; \
+    for (size_t i = 0; i < count; ++i) \
+      d[i] = SW(s[i]); \
+  } \
+  static void name##_halves(void *dst, const void *src, size_t count) { \
+    Elf64_Half *d = dst; \
+    const Elf##C##_Half *s = src; \
+    for (size_t i = 0; i < count; ++i) \
+      d[i] = SW(s[i]); \
+  } \
+  static void name##_chdr(void *dst, const void *src, size_t count) { \
+    Elf64_Chdr *d = dst; \
+    const Elf##C##_Chdr *s = src; \
+    (void)count; \
+    memset(d, 0, sizeof(*d)); \
+    d->ch_type = SW(s->ch_type); \
+    d->ch_size = SW(s->ch_size); \
+    d->ch_addralign = SW(s->ch_addralign); \
+  } \
+  static const struct elf_conv name = { \
+    ELFCLASS##C, SWAPPED, \
+    sizeof(Elf##C##_Ehdr), sizeof(Elf##C##_Phdr), sizeof(Elf##C##_Shdr), sizeof(Elf##C##_Sym), \
+    sizeof(Elf##C##_Dyn), sizeof(Elf##C##_Rel), sizeof(Elf##C##_Rela), sizeof(Elf##C##_Addr), \
+    sizeof(Elf##C##_Chdr), \
+    name##_ehdr, name##_phdrs, name##_shdrs, name##_syms, name##_dyns, name##_rels, name##_relas, \
+    name##_addrs, name##_words, name##_halves, name##_chdr \
+  };
+
+ELF_CONVERTERS(elf32_keep, 32, ELF_KEEP, false)
+ELF_CONVERTERS(elf32_swap, 32, ELF_SWAP, true)
+ELF_CONVERTERS(elf64_swap, 64, ELF_SWAP, true)
+
 /**
- * @brief Returns a pointer to the mapped file in memory.
+ * @brief Picks the converters for a file from its e_ident, once.
  * 
+ * @return const struct elf_conv* NULL for ELF64 in the host's byte order, read in place.
  */
 
-static inline __attribute__((always_inline)) char *map_elf_file(int fd) {
-  char *file = mmap(NULL, get_elf_size(fd), PROT_READ, MAP_PRIVATE, fd, 0);
+static const struct elf_conv *pick_conv(const unsigned char *ident, elf_status_t *status) {
+  bool swap = ident[EI_DATA] != ELF_HOST_DATA;
 
-  return (!file ? NULL : file);
+  *status = ELF_OK;
+  if ((ident[EI_CLASS] != ELFCLASS32 && ident[EI_CLASS] != ELFCLASS64)
+      || (ident[EI_DATA] != ELFDATA2LSB && ident[EI_DATA] != ELFDATA2MSB)) {
+    *status = ELF_ECLASS;
+    return NULL;
+  }
+  if (ident[EI_CLASS] == ELFCLASS32)
+    return (swap ? &elf32_swap : &elf32_keep);
+  return (swap ? &elf64_swap : NULL);
 }
 
 /**
- * @brief Checks if the file mapped in memory is actually an ELF file or not.
+ * @brief Tells how the contents of a section are converted, if they have to be.
  * 
+ * @param raw The size of an entry in the file.
+ * @param native The size of the entry once converted.
+ * @return elf_convert_t NULL if the bytes can be used as they are.
  */
 
-static inline __attribute__((always_inline)) bool check_magic_bytes(const char *file) {
-  return ((memcmp(file, (char []){0x7f, 0x45, 0x4c, 0x46}, 4)
-          || memcmp(file, (char []){0x46, 0x4c, 0x45, 0x7f}, 4)) ? true : false);
+static elf_convert_t table_layout(const struct elf_conv *conv, Elf64_Word type, size_t *raw, size_t *native) {
+  switch (type) {
+    case SHT_SYMTAB:
+    case SHT_DYNSYM:
+      *raw = conv->sym_size;
+      *native = sizeof(Elf64_Sym);
+      return conv->syms;
+    case SHT_DYNAMIC:
+      *raw = conv->dyn_size;
+      *native = sizeof(Elf64_Dyn);
+      return conv->dyns;
+    case SHT_REL:
+      *raw = conv->rel_size;
+      *native = sizeof(Elf64_Rel);
+      return conv->rels;
+    case SHT_RELA:
+      *raw = conv->rela_size;
+      *native = sizeof(Elf64_Rela);
+      return conv->relas;
+    case SHT_RELR:
+      *raw = conv->addr_size;
+      *native = sizeof(uint64_t);
+      return conv->addrs;
+    case SHT_HASH:
+    case SHT_GNU_HASH:
+    case SHT_SYMTAB_SHNDX:
+    case SHT_GROUP:
+      *raw = *native = sizeof(Elf64_Word);
+      return (conv->swap ? conv->words : NULL);
+    case SHT_GNU_versym:
+      *raw = *native = sizeof(Elf64_Half);
+      return (conv->swap ? conv->halves : NULL);
+    default:
+      return NULL;
+  }
 }
 
 /**
- * @brief In case of an error, this will handle it nicely.
+ * @brief Checks that the program and section header tables lie inside the file.
  * 
- * @param fd The file descriptor of the file we opened.
- * @param elf A pointer to the struct.
- * @param file The file that was mapped into memory. 
- * @param reason The reason. Duh.
+ * @param phsize The size of a program header in the file's class.
+ * @param shsize The size of a section header in the file's class.
  */
 
-void error_handling(int fd, elf_t *elf, char *file, const char *reason) {
-  fprintf(stderr, "%s\n", reason);
-  munmap(file, get_elf_size(fd));
-  close(fd);
-  free(elf);
-  exit(EXIT_FAILURE);
+static bool check_header(const Elf64_Ehdr *ehdr, uint64_t size, size_t phsize, size_t shsize) {
+  uint64_t phtable = (uint64_t)ehdr->e_phnum * phsize;
+  uint64_t shtable = (uint64_t)ehdr->e_shnum * shsize;
+
+  if (ehdr->e_phnum && (ehdr->e_phentsize != phsize
+      || ehdr->e_phoff > size || phtable > size - ehdr->e_phoff))
+    return false;
+  if (ehdr->e_shnum && (ehdr->e_shentsize != shsize
+      || ehdr->e_shoff > size || shtable > size - ehdr->e_shoff
+      || ehdr->e_shstrndx >= ehdr->e_shnum))
+    return false;
+  return true;
 }
 
 /**
- * @brief Opens the file, maps the file into memory, parses it and dumps the elf header.
- *
- * @param path The path of the ELF file we are going to inspect.
+ * @brief Returns the .shstrtab section header, NULL if the file has none.
+ * 
+ * @param ok Cleared if the section points outside the file.
  */
 
-elf_t *init_elf(int fd) {
-  elf_t *elf = calloc(1, sizeof(elf_t));
+static const Elf64_Shdr *check_shstrtab(const elf_t *elf, bool *ok) {
+  const Elf64_Ehdr *ehdr = elf->elf_header;
 
-  if (!elf)
-    error_handling(fd, NULL, NULL, "Failed to allocate memory for the struct!");
+  if (!ehdr->e_shnum || ehdr->e_shstrndx == SHN_UNDEF)
+    return NULL;
+
+  const Elf64_Shdr *shstrtab = &elf->elf_section_header[ehdr->e_shstrndx];
+
+  *ok = shstrtab->sh_offset <= elf->size && shstrtab->sh_size <= elf->size - shstrtab->sh_offset;
+  return shstrtab;
+}
+
+/**
+ * @brief Gives a mapped range of a slot back, copied ones keep their buffer for reuse.
+ * 
+ */
+
+static void slot_unmap(elf_slot_t *slot) {
+  if (!slot->mapped)
+    return;
+  munmap(slot->buf - slot->lead, slot->lead + slot->size);
+  slot->buf = NULL;
+  slot->mapped = false;
+}
+
+/**
+ * @brief Maps a range bigger than ELF_IO_SLOT_MAX into a slot.
+ * 
+ * The pages come from the page cache as they are touched and the kernel
+ * can drop them again, so a pool of big tables doesn't pin their size in
+ * anonymous memory. The range counts as read.
+ * 
+ * @return bool false if the descriptor can't be mapped, the range is then copied.
+ */
+
+static bool slot_map(elf_t *elf, elf_slot_t *slot, uint64_t offset, uint64_t size) {
+  uint64_t lead = offset % (uint64_t)sysconf(_SC_PAGESIZE);
+  char *map = mmap(NULL, lead + size, PROT_READ, MAP_PRIVATE, elf->io->fd, offset - lead);
+
+  if (map == MAP_FAILED)
+    return false;
+
+  elf->alloc.release(elf->alloc.ctx, slot->buf);
+  slot->buf = map + lead;
+  slot->lead = lead;
+  slot->mapped = true;
+  __atomic_fetch_add(&elf->io->bytes_read, size, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&elf->io->reads, 1, __ATOMIC_RELAXED);
+  return true;
+}
+
+/**
+ * @brief Frees everything the pread backend allocated.
+ * 
+ */
+
+static void destroy_io(elf_t *elf) {
+  if (!elf->io)
+    return;
+
+  for (int i = 0; i < ELF_IO_SLOTS; ++i) {
+    slot_unmap(&elf->io->slots[i]);
+    elf->alloc.release(elf->alloc.ctx, elf->io->slots[i].buf);
+  }
+  if (elf->io->fd != -1)
+    close(elf->io->fd);
+  elf->alloc.release(elf->alloc.ctx, elf->io);
+  elf->alloc.release(elf->alloc.ctx, elf->string_table);
+  elf->io = NULL;
+}
+
+/**
+ * @brief Frees the converted headers and section tables of a foreign file.
+ * 
+ */
+
+static void destroy_tables(elf_t *elf) {
+  if (elf->tables) {
+    for (unsigned int i = 0; i <= elf->elf_header->e_shnum; ++i)
+      elf->alloc.release(elf->alloc.ctx, elf->tables->table[i]);
+    pthread_mutex_destroy(&elf->tables->lock);
+    elf->alloc.release(elf->alloc.ctx, elf->tables);
+    elf->tables = NULL;
+  }
+  if (elf->io || elf->conv) {
+    elf->alloc.release(elf->alloc.ctx, elf->elf_header);
+    elf->alloc.release(elf->alloc.ctx, elf->elf_program_header);
+    elf->alloc.release(elf->alloc.ctx, elf->elf_section_header);
+  }
+}
+
+/**
+ * @brief Returns a human readable description of a status code.
+ * 
+ */
+
+const char *elf_strerror(elf_status_t status) {
+  switch (status) {
+    case ELF_OK:        return "Success.";
+    case ELF_ENOMEM:    return "Failed to allocate memory for the struct!";
+    case ELF_EOPEN:     return "Failed to open the file.";
+    case ELF_EREAD:     return "Failed to read the file!";
+    case ELF_EMAP:      return "Failed to map the file into memory!";
+    case ELF_ENOTELF:   return "The file provided is not an ELF file.";
+    case ELF_ECORRUPT:  return "The file has truncated or corrupt headers.";
+    case ELF_ECLASS:    return "The file has an unknown class or byte order.";
+  }
+  return "Unknown error.";
+}
+
+/**
+ * @brief pread(2)s exactly `size` bytes, and keeps count of them.
+ * 
+ * The counters are atomic, elf_pread() calls this from worker threads.
+ */
+
+static bool io_pread(elf_io_t *io, void *buf, uint64_t size, uint64_t offset) {
+  for (uint64_t done = 0; done < size;) {
+    ssize_t n = pread(io->fd, (char *)buf + done, size - done, offset + done);
+
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    done += n;
+    __atomic_fetch_add(&io->bytes_read, (uint64_t)n, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&io->reads, 1, __ATOMIC_RELAXED);
+  }
+  return true;
+}
+
+/**
+ * @brief Reads a table that lives as long as the struct (headers, .shstrtab).
+ * 
+ * The range has already been checked against the size of the file.
+ */
+
+static elf_status_t io_read_table(elf_t *elf, uint64_t offset, uint64_t size, void *table) {
+  char *buf = elf->alloc.alloc(elf->alloc.ctx, size + 1);
+
+  *(char **)table = buf;
+  if (!buf)
+    return ELF_ENOMEM;
+  if (!io_pread(elf->io, buf, size, offset))
+    return ELF_EREAD;
+  buf[size] = '\0';
+  return ELF_OK;
+}
+
+/**
+ * @brief Copies a pipe (or anything else we can't pread) into an unlinked temporary file.
+ * 
+ * A copy cut short by a read or write error would parse as a truncated
+ * file, so it is thrown away instead.
+ * 
+ * @param fd The descriptor to drain.
+ * @return int A seekable descriptor with all the same bytes, -1 on failure.
+ */
+
+static int spool_to_tmpfile(int fd) {
+  const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+  int tmp = open(dir, O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+  char buf[1 << 16];
+  ssize_t n = 0;
+  bool ok = true;
 
-  if (!(elf->file = map_elf_file(fd)))
-    error_handling(fd, elf, elf->file, "Failed to map the file into memory!");
+  while (tmp != -1 && ok && ((n = read(fd, buf, sizeof(buf))) > 0 || (n < 0 && errno == EINTR))) {
+    for (ssize_t done = 0, w; ok && n > 0 && done < n; done += w) {
+      if ((w = write(tmp, buf + done, n - done)) < 0 && errno == EINTR)
+        w = 0;
+      else
+        ok = w > 0;
+    }
+  }
 
-  if (!check_magic_bytes(elf->file))
-    error_handling(fd, elf, elf->file, "The file provided is not an ELF file.");
+  if (tmp != -1 && (!ok || n < 0)) {
+    close(tmp);
+    tmp = -1;
+  }
+  return tmp;
+}
+
+/**
+ * @brief Allocates a zeroed struct that remembers its allocator.
+ * 
+ */
 
-  elf->elf_header = (Elf64_Ehdr *)elf->file;
-  elf->elf_program_header = (Elf64_Phdr *)(elf->file + elf->elf_header->e_phoff);
-  elf->elf_section_header = (Elf64_Shdr *)(elf->file + elf->elf_header->e_shoff);
-  elf->string_table = elf->file + elf->elf_section_header[elf->elf_header->e_shstrndx].sh_offset;
+static elf_t *elf_new(const elf_alloc_t *alloc) {
+  elf_t *elf = alloc->alloc(alloc->ctx, sizeof(elf_t));
 
+  if (elf) {
+    memset(elf, 0, sizeof(elf_t));
+    elf->alloc = *alloc;
+  }
   return elf;
 }
 
 /**
- * @brief Frees all the allocated memory, thus "destroying" the parser.
+ * @brief Reads e_ident and the ELF header, and picks the converters for the rest.
+ * 
+ * @param head The first `avail` bytes of the file.
+ */
+
+static elf_status_t open_ehdr(elf_t *elf, const char *head, uint64_t avail) {
+  elf_status_t status;
+
+  if (avail < EI_NIDENT || !check_magic_bytes(head))
+    return ELF_ENOTELF;
+  elf->conv = pick_conv((const unsigned char *)head, &status);
+  if (status != ELF_OK)
+    return status;
+  if (avail < (elf->conv ? elf->conv->ehdr_size : sizeof(Elf64_Ehdr)))
+    return ELF_ENOTELF;
+
+  if (!elf->conv && elf->file) {
+    elf->elf_header = (Elf64_Ehdr *)head;
+    return ELF_OK;
+  }
+  if (!(elf->elf_header = elf->alloc.alloc(elf->alloc.ctx, sizeof(Elf64_Ehdr))))
+    return ELF_ENOMEM;
+  if (elf->conv)
+    elf->conv->ehdr(elf->elf_header, head, 1);
+  else
+    memcpy(elf->elf_header, head, sizeof(Elf64_Ehdr));
+  return ELF_OK;
+}
+
+/**
+ * @brief Loads one of the header tables in the native layout.
+ * 
+ * A native file on the mmap backend is used in place, everything else is
+ * read (pread backend) and/or converted into a table of its own.
+ * 
+ * @param raw The size of an entry in the file.
+ * @param native The size of an entry in the table.
+ * @param convert The converter, NULL when both layouts are the same.
+ */
+
+static elf_status_t load_table(elf_t *elf, uint64_t offset, uint64_t count, size_t raw, size_t native,
+                               elf_convert_t convert, void *table) {
+  const char *src = elf->file + offset;
+  char *buf = NULL;
+  elf_status_t status;
+
+  if (elf->file && !convert) {
+    *(const char **)table = src;
+    return ELF_OK;
+  }
+  if (!elf->file) {
+    if ((status = io_read_table(elf, offset, count * raw, convert ? (void *)&buf : table)) != ELF_OK
+        || !convert) {
+      elf->alloc.release(elf->alloc.ctx, buf);
+      return status;
+    }
+    src = buf;
+  }
+
+  char *dst = elf->alloc.alloc(elf->alloc.ctx, count * native + 1);
+
+  if (dst)
+    convert(dst, src, count);
+  *(char **)table = dst;
+  elf->alloc.release(elf->alloc.ctx, buf);
+  return (dst ? ELF_OK : ELF_ENOMEM);
+}
+
+/**
+ * @brief Loads the program and section headers and .shstrtab, once the ELF header is in.
+ * 
+ */
+
+static elf_status_t open_tables(elf_t *elf) {
+  const struct elf_conv *conv = elf->conv;
+  Elf64_Ehdr *ehdr = elf->elf_header;
+  elf_status_t status;
+
+  if (!check_header(ehdr, elf->size, conv ? conv->phdr_size : sizeof(Elf64_Phdr),
+                    conv ? conv->shdr_size : sizeof(Elf64_Shdr)))
+    return ELF_ECORRUPT;
+  if ((status = load_table(elf, ehdr->e_phoff, ehdr->e_phnum, ehdr->e_phentsize, sizeof(Elf64_Phdr),
+                           conv ? conv->phdrs : NULL, &elf->elf_program_header)) != ELF_OK
+      || (status = load_table(elf, ehdr->e_shoff, ehdr->e_shnum, ehdr->e_shentsize, sizeof(Elf64_Shdr),
+                              conv ? conv->shdrs : NULL, &elf->elf_section_header)) != ELF_OK)
+    return status;
+
+  bool ok = true;
+  const Elf64_Shdr *shstrtab = check_shstrtab(elf, &ok);
+
+  if (!ok)
+    return ELF_ECORRUPT;
+  if (elf->io)
+    status = io_read_table(elf, shstrtab ? shstrtab->sh_offset : 0, shstrtab ? shstrtab->sh_size : 0,
+                           &elf->string_table);
+  else
+    elf->string_table = shstrtab ? elf->file + shstrtab->sh_offset : no_names;
+
+  elf->string_table_size = shstrtab ? shstrtab->sh_size : 0;
+
+  if (status == ELF_OK && conv) {
+    size_t size = sizeof(struct elf_tables) + ((size_t)ehdr->e_shnum + 1) * sizeof(void *);
+
+    if (!(elf->tables = elf->alloc.alloc(elf->alloc.ctx, size)))
+      return ELF_ENOMEM;
+    memset(elf->tables, 0, size);
+    pthread_mutex_init(&elf->tables->lock, NULL);
+  }
+  return status;
+}
+
+/**
+ * @brief Sets up the pread backend: only the headers and .shstrtab are read.
+ * 
+ */
+
+static elf_status_t open_stream(elf_t *elf, int fd) {
+  char head[sizeof(Elf64_Ehdr)];
+  struct stat st;
+  elf_status_t status;
+
+  if (!(elf->io = elf->alloc.alloc(elf->alloc.ctx, sizeof(elf_io_t))))
+    return ELF_ENOMEM;
+  memset(elf->io, 0, sizeof(elf_io_t));
+
+  /* pipes and friends can't be read out of order, park them on disk first */
+  elf->io->fd = -1;
+  if (fstat(fd, &st) == -1)
+    return ELF_EREAD;
+  elf->io->fd = S_ISREG(st.st_mode) ? fcntl(fd, F_DUPFD_CLOEXEC, 0) : spool_to_tmpfile(fd);
+  if (elf->io->fd == -1 || fstat(elf->io->fd, &st) == -1)
+    return ELF_EREAD;
+  elf->size = st.st_size;
+
+  uint64_t avail = elf->size < sizeof(head) ? elf->size : sizeof(head);
+
+  if (!io_pread(elf->io, head, avail, 0))
+    return ELF_EREAD;
+  if ((status = open_ehdr(elf, head, avail)) != ELF_OK)
+    return status;
+  return open_tables(elf);
+}
+
+/**
+ * @brief Points the struct into a file that is already in memory.
+ * 
+ */
+
+static elf_status_t open_mapped(elf_t *elf, char *file, uint64_t size) {
+  elf_status_t status;
+
+  elf->file = file;
+  elf->size = size;
+
+  if ((status = open_ehdr(elf, file, size)) != ELF_OK)
+    return status;
+  return open_tables(elf);
+}
+
+/**
+ * @brief Parses an open file, the descriptor stays owned by the caller.
+ * 
+ * ELF_BACKEND_AUTO maps regular files and streams everything else (pipes,
+ * character devices) and files bigger than ELF_MMAP_LIMIT. Nothing here
+ * exits or touches global state, different files can be opened from
+ * different threads at once.
+ * 
+ * @param fd The file descriptor of the file, it can be closed right after.
+ * @param backend Whole-file mmap or on-demand pread.
+ * @param alloc Where the memory comes from, NULL for malloc(3).
+ * @param out Where the struct is stored, NULL on failure.
+ * @return elf_status_t ELF_OK, or why the file could not be parsed.
+ */
+
+elf_status_t elf_open_fd(int fd, elf_backend_t backend, const elf_alloc_t *alloc, elf_t **out) {
+  struct stat st = {0};
+  elf_status_t status;
+
+  *out = NULL;
+  if (fstat(fd, &st) == -1)
+    return ELF_EREAD;
+  if (backend == ELF_BACKEND_AUTO)
+    backend = (S_ISREG(st.st_mode) && (uint64_t)st.st_size < ELF_MMAP_LIMIT)
+              ? ELF_BACKEND_MMAP : ELF_BACKEND_PREAD;
+
+  elf_t *elf = elf_new(alloc ? alloc : &std_allocator);
+
+  if (!elf)
+    return ELF_ENOMEM;
+
+  if (backend == ELF_BACKEND_PREAD) {
+    status = open_stream(elf, fd);
+  } else if ((uint64_t)st.st_size < EI_NIDENT) {
+    status = ELF_ENOTELF;
+  } else {
+    char *file = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    status = (file == MAP_FAILED) ? ELF_EMAP : open_mapped(elf, file, st.st_size);
+  }
+
+  if (status != ELF_OK) {
+    elf_close(elf);
+    return status;
+  }
+  *out = elf;
+  return ELF_OK;
+}
+
+/**
+ * @brief Same as elf_open_fd(), with a path.
  * 
- * @param fd The file descriptor of the file we inspected.
- * @param file The mapped file in memory.
- * @param elf The pointer to the struct.
  */
 
-void destroy_parser(int fd, char *file, elf_t *elf) {
-  munmap(file, get_elf_size(fd));
-  free(elf);
+elf_status_t elf_open(const char *path, elf_backend_t backend, const elf_alloc_t *alloc, elf_t **out) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+  *out = NULL;
+  if (fd == -1)
+    return ELF_EOPEN;
+
+  elf_status_t status = elf_open_fd(fd, backend, alloc, out);
+
   close(fd);
+  return status;
+}
+
+/**
+ * @brief Parses a file that is already in memory, a cache entry for instance.
+ * 
+ * @param file A mapping of `size` bytes, the struct owns it on success only.
+ * @param size How long the mapping is.
+ */
+
+elf_status_t elf_open_mapped(char *file, uint64_t size, const elf_alloc_t *alloc, elf_t **out) {
+  elf_t *elf = elf_new(alloc ? alloc : &std_allocator);
+  elf_status_t status;
+
+  *out = NULL;
+  if (!elf)
+    return ELF_ENOMEM;
+
+  if ((status = open_mapped(elf, file, size)) != ELF_OK) {
+    elf->file = NULL;
+    elf_close(elf);
+    return status;
+  }
+  *out = elf;
+  return ELF_OK;
+}
+
+/**
+ * @brief Parses a file that lives in someone else's memory, an archive member for instance.
+ * 
+ * Nothing is copied, and elf_close() leaves the bytes alone; they have to
+ * outlive the struct. The exception is a file that doesn't start on the
+ * alignment of its class (archive members are only 2-byte aligned): its
+ * headers and tables can't be read in place, so it is copied into memory
+ * of its own.
+ * 
+ * @param data The first byte of the file.
+ * @param size How long it is.
+ */
+
+elf_status_t elf_open_view(const char *data, uint64_t size, const elf_alloc_t *alloc, elf_t **out) {
+  elf_t *elf = elf_new(alloc ? alloc : &std_allocator);
+  elf_status_t status;
+  uintptr_t align = (size > EI_CLASS && data[EI_CLASS] == ELFCLASS32) ? 4 : 8;
+
+  *out = NULL;
+  if (!elf)
+    return ELF_ENOMEM;
+
+  elf->view = true;
+  if ((uintptr_t)data % align) {
+    char *copy = elf->alloc.alloc(elf->alloc.ctx, size + 1);
+
+    if (!copy) {
+      elf_close(elf);
+      return ELF_ENOMEM;
+    }
+    memcpy(copy, data, size);
+    data = copy;
+    elf->copied = true;
+  }
+  if ((status = open_mapped(elf, (char *)data, size)) != ELF_OK) {
+    elf_close(elf);
+    return status;
+  }
+  *out = elf;
+  return ELF_OK;
+}
+
+/**
+ * @brief Unmaps or frees everything the struct holds, then the struct itself.
+ * 
+ */
+
+void elf_close(elf_t *elf) {
+  if (!elf)
+    return;
+  if (elf->file && !elf->view)
+    munmap(elf->file, elf->size);
+  destroy_tables(elf);
+  destroy_io(elf);
+  if (elf->copied)
+    elf->alloc.release(elf->alloc.ctx, elf->file);
+  elf->alloc.release(elf->alloc.ctx, elf->resident);
+  elf->alloc.release(elf->alloc.ctx, elf);
+}
+
+/**
+ * @brief Tells whether [offset, offset + size) is inside the file and backed by memory.
+ * 
+ */
+
+static bool elf_backed(const elf_t *elf, uint64_t offset, uint64_t size) {
+  if (offset > elf->size || size > elf->size - offset)
+    return false;
+  if (!elf->resident)
+    return true;
+
+  for (size_t i = 0; i < elf->resident_count; ++i) {
+    const elf_extent_t *ext = &elf->resident[i];
+
+    if (offset >= ext->offset && offset + size <= ext->offset + ext->size)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Restricts a mapping to the ranges that are actually there.
+ * 
+ * For files mapped back from a cache entry, where everything else is
+ * PROT_NONE: elf_read(), elf_pread() and elf_section_table() fail outside
+ * the extents instead of faulting. The headers and .shstrtab have to be
+ * among them, they were read by the open already.
+ * 
+ * @param extents The ranges, copied.
+ * @param count How many there are.
+ * @return bool false if out of memory.
+ */
+
+bool elf_set_resident(elf_t *elf, const elf_extent_t *extents, size_t count) {
+  elf_extent_t *copy = elf->alloc.alloc(elf->alloc.ctx, count * sizeof(elf_extent_t) + 1);
+
+  if (!copy)
+    return false;
+  memcpy(copy, extents, count * sizeof(elf_extent_t));
+  elf->alloc.release(elf->alloc.ctx, elf->resident);
+  elf->resident = copy;
+  elf->resident_count = count;
+  return true;
+}
+
+/**
+ * @brief Returns `size` bytes of the file starting at `offset`, whatever the backend.
+ * 
+ * With the pread backend the bytes land in one of ELF_IO_SLOTS buffers, the
+ * least recently used one is recycled, so a pointer stays valid until
+ * ELF_IO_SLOTS - 1 other ranges have been read. Ranges that are already
+ * in a slot are not read again. Ranges over ELF_IO_SLOT_MAX are mapped
+ * rather than copied, so the buffers never hold more than ELF_IO_SLOTS
+ * times that; like the mmap backend, they aren't NUL terminated.
+ * 
+ * @param elf A pointer to the struct.
+ * @param offset Where the range starts in the file.
+ * @param size How long it is.
+ * @return const char* The bytes, NULL if the range is not inside the file.
+ */
+
+const char *elf_read(elf_t *elf, uint64_t offset, uint64_t size) {
+  if (!elf_backed(elf, offset, size))
+    return NULL;
+
+  if (!elf->io)
+    return elf->file + offset;
+
+  elf_io_t *io = elf->io;
+  elf_slot_t *victim = &io->slots[0];
+
+  for (int i = 0; i < ELF_IO_SLOTS; ++i) {
+    elf_slot_t *slot = &io->slots[i];
+
+    if (slot->buf && offset >= slot->offset && offset + size <= slot->offset + slot->size) {
+      slot->used = ++io->clock;
+      return slot->buf + (offset - slot->offset);
+    }
+    if (slot->used < victim->used)
+      victim = slot;
+  }
+
+  slot_unmap(victim);
+  victim->offset = offset;
+  victim->used = ++io->clock;
+
+  if (size > ELF_IO_SLOT_MAX && slot_map(elf, victim, offset, size)) {
+    victim->size = size;
+    return victim->buf;
+  }
+
+  char *buf = elf->alloc.resize(elf->alloc.ctx, victim->buf, size + 1);
+
+  if (!buf) {
+    victim->size = 0;
+    return NULL;
+  }
+
+  victim->buf = buf;
+  victim->size = size;
+  buf[size] = '\0';
+
+  if (!io_pread(io, buf, size, offset)) {
+    victim->size = 0;
+    return NULL;
+  }
+  return buf;
+}
+
+/**
+ * @brief Copies `size` bytes of the file at `offset` into the caller's buffer.
+ * 
+ * Unlike elf_read() nothing is cached, so this is safe to call from several
+ * threads at once on the same struct.
+ * 
+ * @return bool false if the range is not inside the file.
+ */
+
+bool elf_pread(elf_t *elf, void *buf, uint64_t size, uint64_t offset) {
+  if (!elf_backed(elf, offset, size))
+    return false;
+
+  if (!elf->io) {
+    memcpy(buf, elf->file + offset, size);
+    return true;
+  }
+  return io_pread(elf->io, buf, size, offset);
+}
+
+/**
+ * @brief Returns the contents of a section, NULL for SHT_NOBITS or bogus sections.
+ * 
+ * @param elf A pointer to the struct.
+ * @param index The section index.
+ */
+
+const char *elf_section_data(elf_t *elf, unsigned int index) {
+  if (index >= elf->elf_header->e_shnum || elf->elf_section_header[index].sh_type == SHT_NOBITS)
+    return NULL;
+
+  return elf_read(elf, elf->elf_section_header[index].sh_offset, elf->elf_section_header[index].sh_size);
+}
+
+/**
+ * @brief Returns the string at `offset` of a string table, "" if it isn't one.
+ * 
+ * Names are offsets taken from the file, they are only trusted when they
+ * fall inside the table and the string ends before the table does.
+ * 
+ * @param strtab The table, NULL is taken as empty.
+ * @param size Its size, sh_size.
+ * @param offset st_name, sh_name and the like.
+ */
+
+const char *elf_string(const char *strtab, uint64_t size, uint64_t offset) {
+  if (!strtab || offset >= size || !memchr(strtab + offset, '\0', size - offset))
+    return "";
+  return strtab + offset;
+}
+
+/**
+ * @brief Returns the name of a section out of .shstrtab, "" if it has none.
+ * 
+ */
+
+const char *elf_section_name(const elf_t *elf, const Elf64_Shdr *shdr) {
+  return elf_string(elf->string_table, elf->string_table_size, shdr->sh_name);
+}
+
+/**
+ * @brief Converts a table of a foreign file once, into tables->table[slot].
+ * 
+ * Tables are never changed once published, readers that find one don't
+ * take the lock.
+ * 
+ * @param slot The section index, e_shnum for PT_DYNAMIC.
+ * @param type The SHT_* type, how the entries are laid out.
+ * @return void* The converted table, NULL if it can't be read or converted.
+ */
+
+static void *convert_table(elf_t *elf, unsigned int slot, Elf64_Word type, uint64_t offset, uint64_t size) {
+  size_t raw, native;
+  elf_convert_t convert = table_layout(elf->conv, type, &raw, &native);
+  void *table = __atomic_load_n(&elf->tables->table[slot], __ATOMIC_ACQUIRE);
+
+  if (table || !convert || !elf_backed(elf, offset, size))
+    return table;
+
+  pthread_mutex_lock(&elf->tables->lock);
+  if (!(table = elf->tables->table[slot])) {
+    uint64_t count = size / raw;
+    char *buf = elf->file ? NULL : elf->alloc.alloc(elf->alloc.ctx, count * raw + 1);
+    const char *src = elf->file ? elf->file + offset : buf;
+
+    if (src && (elf->file || elf_pread(elf, buf, count * raw, offset))
+        && (table = elf->alloc.alloc(elf->alloc.ctx, count * native + 1))) {
+      convert(table, src, count);
+
+      Elf64_Word *words = table;
+
+      /* the bloom filter of ELF64 .gnu.hash is made of 64-bit words, put their halves back in order */
+      if (type == SHT_GNU_HASH && elf->conv->elf_class == ELFCLASS64 && count >= 4
+          && words[2] <= (count - 4) / 2) {
+        for (uint64_t i = 0; i < words[2]; ++i) {
+          Elf64_Word low = words[4 + 2 * i];
+
+          words[4 + 2 * i] = words[5 + 2 * i];
+          words[5 + 2 * i] = low;
+        }
+      }
+      __atomic_store_n(&elf->tables->table[slot], table, __ATOMIC_RELEASE);
+    }
+    elf->alloc.release(elf->alloc.ctx, buf);
+  }
+  pthread_mutex_unlock(&elf->tables->lock);
+  return table;
+}
+
+/**
+ * @brief Returns the entries of a section in the native Elf64 layout.
+ * 
+ * For ELF64 files in the host's byte order this is elf_section_data(). The
+ * tables of other files (symbols, dynamic entries, relocations, hash
+ * tables, version indices) are converted on first use and kept until elf_close(), so the
+ * pointer doesn't move and can be shared between threads.
+ * 
+ * @param elf A pointer to the struct.
+ * @param index The section index.
+ * @return const void* NULL for SHT_NOBITS or bogus sections, or if the conversion failed.
+ */
+
+const void *elf_section_table(elf_t *elf, unsigned int index) {
+  size_t raw, native;
+
+  if (!elf->conv || index >= elf->elf_header->e_shnum
+      || !table_layout(elf->conv, elf->elf_section_header[index].sh_type, &raw, &native))
+    return elf_section_data(elf, index);
+
+  const Elf64_Shdr *shdr = &elf->elf_section_header[index];
+
+  if (shdr->sh_entsize && shdr->sh_entsize != raw)
+    return NULL;
+  return convert_table(elf, index, shdr->sh_type, shdr->sh_offset, shdr->sh_size);
+}
+
+/**
+ * @brief Reads the header of a SHF_COMPRESSED section, whatever the class of the file.
+ * 
+ * @param elf A pointer to the struct.
+ * @param index The section index.
+ * @param chdr Where the header is stored.
+ * @param size Where the size of the header in the file is stored, the data follows it.
+ * @return bool false if the section is too short or can't be read.
+ */
+
+bool elf_chdr(elf_t *elf, unsigned int index, Elf64_Chdr *chdr, uint64_t *size) {
+  char raw[sizeof(Elf64_Chdr)];
+
+  *size = elf->conv ? elf->conv->chdr_size : sizeof(Elf64_Chdr);
+  if (index >= elf->elf_header->e_shnum || elf->elf_section_header[index].sh_size < *size
+      || !elf_pread(elf, raw, *size, elf->elf_section_header[index].sh_offset))
+    return false;
+
+  if (elf->conv)
+    elf->conv->chdr(chdr, raw, 1);
+  else
+    memcpy(chdr, raw, sizeof(Elf64_Chdr));
+  return true;
+}
+
+/**
+ * @brief Finds where a virtual address is stored in the file, through PT_LOAD.
+ * 
+ * @param elf A pointer to the struct.
+ * @param vaddr The address.
+ * @param offset Where the file offset is stored.
+ * @param avail Where the number of bytes the segment has from there on is stored.
+ * @return bool false if no segment has the address in the file.
+ */
+
+bool elf_vaddr_offset(elf_t *elf, uint64_t vaddr, uint64_t *offset, uint64_t *avail) {
+  for (int i = 0; i < elf->elf_header->e_phnum; ++i) {
+    const Elf64_Phdr *phdr = &elf->elf_program_header[i];
+
+    if (phdr->p_type == PT_LOAD && vaddr >= phdr->p_vaddr && vaddr - phdr->p_vaddr < phdr->p_filesz
+        && phdr->p_offset <= elf->size && phdr->p_filesz <= elf->size - phdr->p_offset) {
+      *offset = phdr->p_offset + (vaddr - phdr->p_vaddr);
+      *avail = phdr->p_filesz - (vaddr - phdr->p_vaddr);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Returns the dynamic section in the native layout, from SHT_DYNAMIC or PT_DYNAMIC.
+ * 
+ * The section wins, PT_DYNAMIC is there for files without section headers.
+ * Entries after DT_NULL are garbage.
+ * 
+ * @param elf A pointer to the struct.
+ * @param count Where the number of entries is stored.
+ * @return const Elf64_Dyn* NULL if the file isn't dynamically linked.
+ */
+
+const Elf64_Dyn *elf_dynamic(elf_t *elf, uint64_t *count) {
+  size_t raw = elf->conv ? elf->conv->dyn_size : sizeof(Elf64_Dyn);
+
+  *count = 0;
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    if (elf->elf_section_header[i].sh_type == SHT_DYNAMIC) {
+      const Elf64_Dyn *dyn = elf_section_table(elf, i);
+
+      *count = dyn ? elf->elf_section_header[i].sh_size / raw : 0;
+      return dyn;
+    }
+  }
+
+  for (int i = 0; i < elf->elf_header->e_phnum; ++i) {
+    const Elf64_Phdr *phdr = &elf->elf_program_header[i];
+    const Elf64_Dyn *dyn;
+
+    if (phdr->p_type != PT_DYNAMIC)
+      continue;
+    if (elf->conv)
+      dyn = convert_table(elf, elf->elf_header->e_shnum, SHT_DYNAMIC, phdr->p_offset, phdr->p_filesz);
+    else
+      dyn = (const Elf64_Dyn *)elf_read(elf, phdr->p_offset, phdr->p_filesz);
+    *count = dyn ? phdr->p_filesz / raw : 0;
+    return dyn;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Returns the string table the dynamic entries point into.
+ * 
+ * @param elf A pointer to the struct.
+ * @param dyn The dynamic entries, from elf_dynamic().
+ * @param count How many there are.
+ * @param size Where the size of the table is stored, the strings aren't bounded otherwise.
+ * @return const char* NULL if there is none.
+ */
+
+const char *elf_dynamic_strtab(elf_t *elf, const Elf64_Dyn *dyn, uint64_t count, uint64_t *size) {
+  uint64_t addr = 0, len = 0, offset, avail;
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    if (shdr->sh_type == SHT_DYNAMIC && shdr->sh_link < elf->elf_header->e_shnum
+        && elf->elf_section_header[shdr->sh_link].sh_type == SHT_STRTAB) {
+      *size = elf->elf_section_header[shdr->sh_link].sh_size;
+      return elf_section_data(elf, shdr->sh_link);
+    }
+  }
+
+  for (uint64_t i = 0; i < count && dyn[i].d_tag != DT_NULL; ++i) {
+    if (dyn[i].d_tag == DT_STRTAB)
+      addr = dyn[i].d_un.d_ptr;
+    else if (dyn[i].d_tag == DT_STRSZ)
+      len = dyn[i].d_un.d_val;
+  }
+  if (!addr || !elf_vaddr_offset(elf, addr, &offset, &avail))
+    return NULL;
+  *size = len < avail ? len : avail;
+  return elf_read(elf, offset, *size);
+}
+
+/**
+ * @brief Converts `count` 32-bit words of the file to host order.
+ * 
+ */
+
+void elf_words(const elf_t *elf, uint32_t *dst, const void *src, size_t count) {
+  if (elf->conv && elf->conv->swap)
+    elf->conv->words(dst, src, count);
+  else
+    memcpy(dst, src, count * sizeof(uint32_t));
+}
+
+/**
+ * @brief Converts `count` 16-bit halves of the file to host order.
+ * 
+ */
+
+void elf_halves(const elf_t *elf, uint16_t *dst, const void *src, size_t count) {
+  if (elf->conv && elf->conv->swap)
+    elf->conv->halves(dst, src, count);
+  else
+    memcpy(dst, src, count * sizeof(uint16_t));
+}
+
+/**
+ * @brief Converts `count` words of the file's class (Elf32_Addr or Elf64_Addr) to uint64_t.
+ * 
+ */
+
+void elf_addrs(const elf_t *elf, uint64_t *dst, const void *src, size_t count) {
+  if (elf->conv)
+    elf->conv->addrs(dst, src, count);
+  else
+    memcpy(dst, src, count * sizeof(uint64_t));
+}
+
+/**
+ * @brief Steps through the notes of a SHT_NOTE section or PT_NOTE segment.
+ * 
+ * @param elf A pointer to the struct.
+ * @param cursor The next note, moved past the one returned.
+ * @param end The end of the notes.
+ * @param align 4, or 8 for notes aligned that way (p_align/sh_addralign of 8).
+ * @param note Where the note is described, name and desc point into the notes.
+ * @return bool false at the end, or at a note that doesn't fit.
+ */
+
+bool elf_note_next(const elf_t *elf, const char **cursor, const char *end, uint64_t align, elf_note_t *note) {
+  uint32_t hdr[3];
+  const char *p = *cursor;
+
+  if (align != 8)
+    align = 4;
+  if ((size_t)(end - p) < sizeof(hdr))
+    return false;
+
+  elf_words(elf, hdr, p, 3);
+  p += sizeof(hdr);
+
+  uint64_t name_len = ((uint64_t)hdr[0] + align - 1) & ~(align - 1);
+  uint64_t desc_len = ((uint64_t)hdr[1] + align - 1) & ~(align - 1);
+
+  if (name_len > (size_t)(end - p) || hdr[1] > (size_t)(end - p) - name_len)
+    return false;
+
+  note->namesz = hdr[0];
+  note->descsz = hdr[1];
+  note->type = hdr[2];
+  note->name = p;
+  note->desc = p + name_len;
+  /* the padding of the last note may be missing */
+  *cursor = (desc_len > (size_t)(end - p) - name_len) ? end : p + name_len + desc_len;
+  return true;
+}
+
+/**
+ * @brief Picks the one symbol table that describes the whole file.
+ * 
+ * .symtab is a superset of .dynsym, so it wins when there is one; going
+ * through both would count the exported symbols twice.
+ * 
+ * @param elf A pointer to the struct.
+ * @return int The section index, -1 if there is no usable symbol table.
+ */
+
+int elf_symbol_table(elf_t *elf) {
+  int index = -1;
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    Elf64_Word type = elf->elf_section_header[i].sh_type;
+
+    if (type == SHT_SYMTAB || (type == SHT_DYNSYM && index == -1))
+      index = i;
+  }
+
+  if (index != -1 && (!elf->elf_section_header[index].sh_entsize
+                      || elf->elf_section_header[index].sh_link >= elf->elf_header->e_shnum))
+    return -1;
+  return index;
 }
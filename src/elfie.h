@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <elf.h>
@@ -11,6 +12,72 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#ifndef SHT_RELR
+#define SHT_RELR 19 /* older <elf.h> */
+#endif
+
+#define ELF_IO_SLOTS 8
+#define ELF_IO_SLOT_MAX ((uint64_t)16 << 20) /* bigger ranges are mapped instead of copied into a slot */
+#define ELF_MMAP_LIMIT ((uint64_t)4 << 30) /* bigger files are streamed by default */
+
+typedef enum elf_backend {
+  ELF_BACKEND_AUTO,
+  ELF_BACKEND_MMAP,
+  ELF_BACKEND_PREAD
+} elf_backend_t;
+
+typedef enum elf_status {
+  ELF_OK,
+  ELF_ENOMEM,
+  ELF_EOPEN,
+  ELF_EREAD,
+  ELF_EMAP,
+  ELF_ENOTELF,
+  ELF_ECORRUPT,
+  ELF_ECLASS
+} elf_status_t;
+
+struct elf_conv;
+struct elf_tables;
+
+/* resize(ctx, NULL, n) must behave like alloc(), release(ctx, NULL) must be harmless */
+typedef struct elf_alloc {
+  void *(*alloc)(void *ctx, size_t size);
+  void *(*resize)(void *ctx, void *ptr, size_t size);
+  void (*release)(void *ctx, void *ptr);
+  void *ctx;
+} elf_alloc_t;
+
+typedef struct elf_note {
+  uint32_t type;
+  uint32_t namesz;
+  uint32_t descsz;
+  const char *name; /* namesz bytes, the NUL included */
+  const char *desc; /* descsz bytes, in the file's class and byte order */
+} elf_note_t;
+
+typedef struct elf_slot {
+  uint64_t offset;
+  uint64_t size;
+  char *buf;
+  unsigned long used;
+  uint64_t lead; /* for a mapped range, the bytes of the first page before `offset` */
+  bool mapped;
+} elf_slot_t;
+
+typedef struct elf_io {
+  int fd;
+  elf_slot_t slots[ELF_IO_SLOTS];
+  unsigned long clock;
+  uint64_t bytes_read;
+  unsigned long reads;
+} elf_io_t;
+
+typedef struct elf_extent {
+  uint64_t offset;
+  uint64_t size;
+} elf_extent_t;
+
 typedef struct elf {
   Elf64_Ehdr *elf_header;
   Elf64_Phdr *elf_program_header;
@@ -18,12 +85,39 @@ typedef struct elf {
   Elf64_Sym *elf_symbol_table;
   char *file;
   char *string_table;
+  uint64_t string_table_size; /* bytes of .shstrtab, 0 when there is none */
+  uint64_t size;
+  elf_io_t *io; /* NULL when the whole file is mapped */
+  bool view; /* file is borrowed (elf_open_view()), never unmapped */
+  bool copied; /* a view that wasn't aligned for its class, file is a private copy */
+  const struct elf_conv *conv; /* NULL for ELF64 in the host's byte order, the only layout read in place */
+  struct elf_tables *tables; /* with conv, the section tables converted so far */
+  elf_alloc_t alloc;
+  elf_extent_t *resident; /* NULL, or the only ranges of file that are backed (a cache entry) */
+  size_t resident_count;
 } elf_t;
 
-elf_t *init_elf(int fd);
-void get_elf_header(elf_t *elf);
-void destroy_parser(int fd, char *file, elf_t *elf);
-void process_file(const char *filename);
-void error_handling(int fd, elf_t *elf, char *file, const char *reason);
+elf_status_t elf_open(const char *path, elf_backend_t backend, const elf_alloc_t *alloc, elf_t **out);
+elf_status_t elf_open_fd(int fd, elf_backend_t backend, const elf_alloc_t *alloc, elf_t **out);
+elf_status_t elf_open_mapped(char *file, uint64_t size, const elf_alloc_t *alloc, elf_t **out);
+elf_status_t elf_open_view(const char *data, uint64_t size, const elf_alloc_t *alloc, elf_t **out);
+void elf_close(elf_t *elf);
+const char *elf_strerror(elf_status_t status);
+bool elf_set_resident(elf_t *elf, const elf_extent_t *extents, size_t count);
+const char *elf_read(elf_t *elf, uint64_t offset, uint64_t size);
+bool elf_pread(elf_t *elf, void *buf, uint64_t size, uint64_t offset);
+const char *elf_section_data(elf_t *elf, unsigned int index);
+const void *elf_section_table(elf_t *elf, unsigned int index);
+const char *elf_string(const char *strtab, uint64_t size, uint64_t offset);
+const char *elf_section_name(const elf_t *elf, const Elf64_Shdr *shdr);
+bool elf_chdr(elf_t *elf, unsigned int index, Elf64_Chdr *chdr, uint64_t *size);
+int elf_symbol_table(elf_t *elf);
+bool elf_vaddr_offset(elf_t *elf, uint64_t vaddr, uint64_t *offset, uint64_t *avail);
+const Elf64_Dyn *elf_dynamic(elf_t *elf, uint64_t *count);
+const char *elf_dynamic_strtab(elf_t *elf, const Elf64_Dyn *dyn, uint64_t count, uint64_t *size);
+void elf_words(const elf_t *elf, uint32_t *dst, const void *src, size_t count);
+void elf_halves(const elf_t *elf, uint16_t *dst, const void *src, size_t count);
+void elf_addrs(const elf_t *elf, uint64_t *dst, const void *src, size_t count);
+bool elf_note_next(const elf_t *elf, const char **cursor, const char *end, uint64_t align, elf_note_t *note);
 
 #endif
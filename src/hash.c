@@ -0,0 +1,645 @@
+/**
+ * @file hash.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Per-section XXH3-64 and SHA-256 digests.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+#define XXH_PRIME32_1 0x9E3779B1u
+#define XXH_PRIME32_2 0x85EBCA77u
+#define XXH_PRIME32_3 0xC2B2AE3Du
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ull
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define XXH_PRIME64_3 0x165667B19E3779F9ull
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ull
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ull
+#define XXH_PRIME_MX1 0x165667919E3779F9ull
+#define XXH_PRIME_MX2 0x9FB21C651E98DF25ull
+
+#define XXH_SECRET_SIZE 192
+#define XXH_STRIPES (((XXH_SECRET_SIZE) - 64) / 8)
+
+static const unsigned char xxh_secret[XXH_SECRET_SIZE] = {
+  0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+  0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+  0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+  0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+  0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+  0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+  0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+  0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+  0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+  0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+  0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+  0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e
+};
+
+static const uint32_t sha256_k[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+__extension__ typedef unsigned __int128 xxh_u128_t;
+
+typedef struct hash_job {
+  elf_t *elf;
+  hash_stat_t *stats;
+  size_t *order;    /* biggest sections first, so one doesn't end up last on its own */
+} hash_job_t;
+
+static inline __attribute__((always_inline)) uint64_t xxh_read64(const unsigned char *p) {
+  uint64_t v;
+
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline __attribute__((always_inline)) uint32_t xxh_read32(const unsigned char *p) {
+  uint32_t v;
+
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline __attribute__((always_inline)) uint64_t xxh_rotl64(uint64_t v, unsigned int r) {
+  return (v << r) | (v >> (64 - r));
+}
+
+/**
+ * @brief The 128-bit product of two 64-bit values, its halves xor'ed.
+ * 
+ */
+
+static inline __attribute__((always_inline)) uint64_t xxh_mul128_fold64(uint64_t a, uint64_t b) {
+  xxh_u128_t product = (xxh_u128_t)a * b;
+
+  return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+static inline __attribute__((always_inline)) uint64_t xxh64_avalanche(uint64_t h) {
+  h ^= h >> 33;
+  h *= XXH_PRIME64_2;
+  h ^= h >> 29;
+  h *= XXH_PRIME64_3;
+  return h ^ (h >> 32);
+}
+
+static inline __attribute__((always_inline)) uint64_t xxh3_avalanche(uint64_t h) {
+  h ^= h >> 37;
+  h *= XXH_PRIME_MX1;
+  return h ^ (h >> 32);
+}
+
+static inline __attribute__((always_inline)) uint64_t xxh3_rrmxmx(uint64_t h, uint64_t len) {
+  h ^= xxh_rotl64(h, 49) ^ xxh_rotl64(h, 24);
+  h *= XXH_PRIME_MX2;
+  h ^= (h >> 35) + len;
+  h *= XXH_PRIME_MX2;
+  return h ^ (h >> 28);
+}
+
+static inline __attribute__((always_inline)) uint64_t xxh3_mix16(const unsigned char *p, const unsigned char *secret) {
+  return xxh_mul128_fold64(xxh_read64(p) ^ xxh_read64(secret), xxh_read64(p + 8) ^ xxh_read64(secret + 8));
+}
+
+/**
+ * @brief XXH3-64 of inputs up to 240 bytes, which skip the accumulators.
+ * 
+ */
+
+static uint64_t xxh3_short(const unsigned char *p, size_t len) {
+  const unsigned char *s = xxh_secret;
+  uint64_t acc = len * XXH_PRIME64_1;
+
+  if (!len)
+    return xxh64_avalanche(xxh_read64(s + 56) ^ xxh_read64(s + 64));
+
+  if (len <= 3) {
+    uint32_t combined = ((uint32_t)p[0] << 16) | ((uint32_t)p[len >> 1] << 24) | p[len - 1] | ((uint32_t)len << 8);
+
+    return xxh64_avalanche(combined ^ (uint64_t)(xxh_read32(s) ^ xxh_read32(s + 4)));
+  }
+
+  if (len <= 8) {
+    uint64_t input = xxh_read32(p + len - 4) + ((uint64_t)xxh_read32(p) << 32);
+
+    return xxh3_rrmxmx(input ^ (xxh_read64(s + 8) ^ xxh_read64(s + 16)), len);
+  }
+
+  if (len <= 16) {
+    uint64_t lo = xxh_read64(p) ^ (xxh_read64(s + 24) ^ xxh_read64(s + 32));
+    uint64_t hi = xxh_read64(p + len - 8) ^ (xxh_read64(s + 40) ^ xxh_read64(s + 48));
+
+    return xxh3_avalanche(len + __builtin_bswap64(lo) + hi + xxh_mul128_fold64(lo, hi));
+  }
+
+  if (len <= 128) {
+    if (len > 32) {
+      if (len > 64) {
+        if (len > 96) {
+          acc += xxh3_mix16(p + 48, s + 96);
+          acc += xxh3_mix16(p + len - 64, s + 112);
+        }
+        acc += xxh3_mix16(p + 32, s + 64);
+        acc += xxh3_mix16(p + len - 48, s + 80);
+      }
+      acc += xxh3_mix16(p + 16, s + 32);
+      acc += xxh3_mix16(p + len - 32, s + 48);
+    }
+    acc += xxh3_mix16(p, s);
+    acc += xxh3_mix16(p + len - 16, s + 16);
+    return xxh3_avalanche(acc);
+  }
+
+  for (size_t i = 0; i < 8; ++i)
+    acc += xxh3_mix16(p + 16 * i, s + 16 * i);
+  acc = xxh3_avalanche(acc);
+  for (size_t i = 8; i < len / 16; ++i)
+    acc += xxh3_mix16(p + 16 * i, s + 16 * (i - 8) + 3);
+  acc += xxh3_mix16(p + len - 16, s + 136 - 17);
+  return xxh3_avalanche(acc);
+}
+
+static inline __attribute__((always_inline)) void xxh3_stripe(uint64_t acc[8], const unsigned char *p, const unsigned char *secret) {
+  for (int i = 0; i < 8; ++i) {
+    uint64_t value = xxh_read64(p + 8 * i);
+    uint64_t key = value ^ xxh_read64(secret + 8 * i);
+
+    acc[i ^ 1] += value;
+    acc[i] += (uint32_t)key * (key >> 32);
+  }
+}
+
+/**
+ * @brief Accumulates one HASH_XXH3_BLOCK and scrambles the accumulators.
+ * 
+ */
+
+static void xxh3_block(uint64_t acc[8], const unsigned char *p) {
+  for (int s = 0; s < XXH_STRIPES; ++s)
+    xxh3_stripe(acc, p + 64 * s, xxh_secret + 8 * s);
+
+  for (int i = 0; i < 8; ++i) {
+    uint64_t a = acc[i];
+
+    a ^= a >> 47;
+    a ^= xxh_read64(xxh_secret + XXH_SECRET_SIZE - 64 + 8 * i);
+    acc[i] = a * XXH_PRIME32_1;
+  }
+}
+
+/**
+ * @brief Starts an XXH3-64 (seed 0, default secret) stream.
+ * 
+ */
+
+void hash_xxh3_init(hash_xxh3_t *xxh) {
+  static const uint64_t init[8] = {
+    XXH_PRIME32_3, XXH_PRIME64_1, XXH_PRIME64_2, XXH_PRIME64_3,
+    XXH_PRIME64_4, XXH_PRIME32_2, XXH_PRIME64_5, XXH_PRIME32_1
+  };
+
+  memcpy(xxh->acc, init, sizeof(init));
+  xxh->len = 0;
+  xxh->buffered = 0;
+}
+
+/**
+ * @brief Feeds data to an XXH3-64 stream.
+ * 
+ * Whole blocks are hashed straight from `data`. A block is only hashed
+ * once more input follows it: the final one, even if full, is finished
+ * differently by hash_xxh3_final().
+ * 
+ */
+
+void hash_xxh3_update(hash_xxh3_t *xxh, const void *data, size_t len) {
+  const unsigned char *p = data;
+  const unsigned char *last = NULL;
+
+  xxh->len += len;
+  if (xxh->buffered + len <= HASH_XXH3_BLOCK) {
+    memcpy(xxh->buf + xxh->buffered, p, len);
+    xxh->buffered += len;
+    return;
+  }
+
+  if (xxh->buffered) {
+    size_t fill = HASH_XXH3_BLOCK - xxh->buffered;
+
+    memcpy(xxh->buf + xxh->buffered, p, fill);
+    p += fill;
+    len -= fill;
+    xxh3_block(xxh->acc, xxh->buf);
+    last = xxh->buf;
+  }
+
+  for (; len > HASH_XXH3_BLOCK; p += HASH_XXH3_BLOCK, len -= HASH_XXH3_BLOCK) {
+    xxh3_block(xxh->acc, p);
+    last = p;
+  }
+
+  memcpy(xxh->last, last + HASH_XXH3_BLOCK - 64, 64);
+  memcpy(xxh->buf, p, len);
+  xxh->buffered = len;
+}
+
+/**
+ * @brief The digest of everything fed so far, the stream can go on.
+ * 
+ */
+
+uint64_t hash_xxh3_final(const hash_xxh3_t *xxh) {
+  if (xxh->len <= 240)
+    return xxh3_short(xxh->buf, xxh->len);
+
+  uint64_t acc[8];
+  unsigned char tail[64];
+  const unsigned char *p = xxh->buf + xxh->buffered - 64;
+  size_t stripes = (xxh->buffered - 1) / 64;
+
+  memcpy(acc, xxh->acc, sizeof(acc));
+  for (size_t s = 0; s < stripes; ++s)
+    xxh3_stripe(acc, xxh->buf + 64 * s, xxh_secret + 8 * s);
+
+  if (xxh->buffered < 64) {
+    /* the last stripe starts in the previous block */
+    memcpy(tail, xxh->last + xxh->buffered, 64 - xxh->buffered);
+    memcpy(tail + 64 - xxh->buffered, xxh->buf, xxh->buffered);
+    p = tail;
+  }
+  xxh3_stripe(acc, p, xxh_secret + XXH_SECRET_SIZE - 64 - 7);
+
+  uint64_t result = xxh->len * XXH_PRIME64_1;
+
+  for (int i = 0; i < 4; ++i)
+    result += xxh_mul128_fold64(acc[2 * i] ^ xxh_read64(xxh_secret + 11 + 16 * i),
+                                acc[2 * i + 1] ^ xxh_read64(xxh_secret + 11 + 16 * i + 8));
+  return xxh3_avalanche(result);
+}
+
+static inline __attribute__((always_inline)) uint32_t sha_rotr(uint32_t v, unsigned int r) {
+  return (v >> r) | (v << (32 - r));
+}
+
+/**
+ * @brief The FIPS 180-4 compression function, one 64-byte block at a time.
+ * 
+ */
+
+static void sha256_blocks_c(uint32_t state[8], const unsigned char *p, size_t blocks) {
+  for (; blocks; --blocks, p += 64) {
+    uint32_t w[64];
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 16; ++i)
+      w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) | ((uint32_t)p[4 * i + 2] << 8) | p[4 * i + 3];
+    for (int i = 16; i < 64; ++i) {
+      uint32_t s0 = sha_rotr(w[i - 15], 7) ^ sha_rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = sha_rotr(w[i - 2], 17) ^ sha_rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    for (int i = 0; i < 64; ++i) {
+      uint32_t t1 = h + (sha_rotr(e, 6) ^ sha_rotr(e, 11) ^ sha_rotr(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+      uint32_t t2 = (sha_rotr(a, 2) ^ sha_rotr(a, 13) ^ sha_rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief The same with the SHA extensions, four rounds per pair of sha256rnds2.
+ * 
+ */
+
+__attribute__((target("sha,sse4.1")))
+static void sha256_blocks_ni(uint32_t state[8], const unsigned char *p, size_t blocks) {
+  const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bll, 0x0405060700010203ll);
+  __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xb1);
+  __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1b);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);   /* ABEF */
+
+  state1 = _mm_blend_epi16(state1, tmp, 0xf0);         /* CDGH */
+
+  for (; blocks; --blocks, p += 64) {
+    __m128i abef = state0, cdgh = state1;
+    __m128i msg[4];
+
+    for (int i = 0; i < 4; ++i)
+      msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 16 * i)), mask);
+
+    for (int i = 0; i < 16; ++i) {
+      __m128i k = _mm_add_epi32(msg[i & 3], _mm_loadu_si128((const __m128i *)&sha256_k[4 * i]));
+
+      state1 = _mm_sha256rnds2_epu32(state1, state0, k);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(k, 0x0e));
+      if (i < 12) {
+        __m128i next = _mm_sha256msg1_epu32(msg[i & 3], msg[(i + 1) & 3]);
+
+        next = _mm_add_epi32(next, _mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4));
+        msg[i & 3] = _mm_sha256msg2_epu32(next, msg[(i + 3) & 3]);
+      }
+    }
+
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1b);
+  state1 = _mm_shuffle_epi32(state1, 0xb1);
+  _mm_storeu_si128((__m128i *)&state[0], _mm_blend_epi16(tmp, state1, 0xf0));
+  _mm_storeu_si128((__m128i *)&state[4], _mm_alignr_epi8(state1, tmp, 8));
+}
+#endif
+
+/**
+ * @brief Hashes whole blocks with the SHA extensions when the CPU has them.
+ * 
+ */
+
+static void sha256_blocks(uint32_t state[8], const unsigned char *p, size_t blocks) {
+#if defined(__x86_64__) || defined(__i386__)
+  static int ni = -1;
+  int has = __atomic_load_n(&ni, __ATOMIC_RELAXED);
+
+  if (has == -1) {
+    unsigned int eax, ebx = 0, ecx, edx;
+
+    /* every thread that gets here stores the same value */
+    has = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1u << 29));
+    __atomic_store_n(&ni, has, __ATOMIC_RELAXED);
+  }
+  if (has) {
+    sha256_blocks_ni(state, p, blocks);
+    return;
+  }
+#endif
+  sha256_blocks_c(state, p, blocks);
+}
+
+void hash_sha256_init(hash_sha256_t *sha) {
+  static const uint32_t init[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+
+  memcpy(sha->state, init, sizeof(init));
+  sha->len = 0;
+  sha->buffered = 0;
+}
+
+void hash_sha256_update(hash_sha256_t *sha, const void *data, size_t len) {
+  const unsigned char *p = data;
+
+  sha->len += len;
+  if (sha->buffered) {
+    size_t fill = 64 - sha->buffered;
+
+    if (fill > len)
+      fill = len;
+    memcpy(sha->buf + sha->buffered, p, fill);
+    sha->buffered += fill;
+    p += fill;
+    len -= fill;
+    if (sha->buffered < 64)
+      return;
+    sha256_blocks(sha->state, sha->buf, 1);
+    sha->buffered = 0;
+  }
+
+  sha256_blocks(sha->state, p, len / 64);
+  memcpy(sha->buf, p + (len & ~(size_t)63), len & 63);
+  sha->buffered = len & 63;
+}
+
+void hash_sha256_final(hash_sha256_t *sha, unsigned char digest[32]) {
+  unsigned char pad[72] = {0x80};
+  uint64_t bits = sha->len * 8;
+  size_t padlen = (sha->buffered < 56) ? 56 - sha->buffered : 120 - sha->buffered;
+
+  for (int i = 0; i < 8; ++i)
+    pad[padlen + i] = (unsigned char)(bits >> (56 - 8 * i));
+  hash_sha256_update(sha, pad, padlen + 8);
+
+  for (int i = 0; i < 8; ++i) {
+    digest[4 * i] = (unsigned char)(sha->state[i] >> 24);
+    digest[4 * i + 1] = (unsigned char)(sha->state[i] >> 16);
+    digest[4 * i + 2] = (unsigned char)(sha->state[i] >> 8);
+    digest[4 * i + 3] = (unsigned char)sha->state[i];
+  }
+}
+
+/**
+ * @brief Hashes one section, in HASH_CHUNK pieces so both hashes find them in cache.
+ * 
+ * Mapped files are hashed in place, with the pread backend each piece
+ * goes through a buffer of its own (elf_pread() is thread-safe).
+ * 
+ */
+
+static void hash_job(size_t index, void *ctx) {
+  hash_job_t *job = ctx;
+  hash_stat_t *stat = &job->stats[job->order[index]];
+  elf_t *elf = job->elf;
+  const Elf64_Shdr *shdr = &elf->elf_section_header[stat->index];
+  char *buf = NULL;
+  hash_xxh3_t xxh;
+  hash_sha256_t sha;
+
+  hash_xxh3_init(&xxh);
+  hash_sha256_init(&sha);
+
+  stat->size = (shdr->sh_type == SHT_NOBITS) ? 0 : shdr->sh_size;
+  if (shdr->sh_offset > elf->size || stat->size > elf->size - shdr->sh_offset)
+    return;
+  if (elf->io && stat->size && !(buf = malloc(HASH_CHUNK)))
+    return;
+
+  for (uint64_t done = 0; done < stat->size; ) {
+    size_t len = (stat->size - done > HASH_CHUNK) ? HASH_CHUNK : stat->size - done;
+    const char *data = elf->file + shdr->sh_offset + done;
+
+    if (buf) {
+      if (!elf_pread(elf, buf, len, shdr->sh_offset + done)) {
+        free(buf);
+        return;
+      }
+      data = buf;
+    }
+    hash_xxh3_update(&xxh, data, len);
+    hash_sha256_update(&sha, data, len);
+    done += len;
+  }
+  free(buf);
+
+  stat->xxh3 = hash_xxh3_final(&xxh);
+  hash_sha256_final(&sha, stat->sha256);
+  stat->ok = true;
+}
+
+/**
+ * @brief Whether a section is left out of the combined digest.
+ * 
+ * @param patterns Comma separated globs, NULL for none.
+ */
+
+static bool hash_excluded(const char *name, const char *patterns) {
+  char pattern[256];
+
+  for (const char *p = patterns; p && *p; ) {
+    size_t len = strcspn(p, ",");
+
+    if (len && len < sizeof(pattern)) {
+      memcpy(pattern, p, len);
+      pattern[len] = '\0';
+      if (!fnmatch(pattern, name, 0))
+        return true;
+    }
+    p += len + !!p[len];
+  }
+  return false;
+}
+
+static int hash_order_cmp(const void *x, const void *y, void *ctx) {
+  const hash_stat_t *stats = ctx;
+  uint64_t a = stats[*(const size_t *)x].size, b = stats[*(const size_t *)y].size;
+
+  return (a < b) - (a > b);
+}
+
+static void hash_hex(out_t *out, const unsigned char *digest, size_t len) {
+  for (size_t i = 0; i < len; ++i)
+    out_hex(out, digest[i], 2, 0, 0);
+}
+
+/**
+ * @brief Lists an XXH3-64 and a SHA-256 digest for every section, then a combined digest.
+ * 
+ * Sections are hashed in parallel, biggest first. The combined digest is
+ * a SHA-256 over the name and SHA-256 of each section in header order,
+ * leaving out the sections matching the globs in file->arg (-e), so builds
+ * that differ only in, say, .comment or .note.gnu.build-id compare equal.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void hash_sections(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  hash_job_t job = {.elf = elf};
+  size_t count = elf->elf_header->e_shnum ? elf->elf_header->e_shnum - 1 : 0;
+  size_t included = 0;
+  hash_sha256_t combined;
+  unsigned char digest[32];
+  bool ok = true;
+
+  if (!count) {
+    out_str(out, "There are no sections in this file.\n");
+    return;
+  }
+
+  job.stats = calloc(count, sizeof(hash_stat_t));
+  job.order = malloc(count * sizeof(size_t));
+  if (!job.stats || !job.order)
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the struct!");
+
+  for (size_t i = 0; i < count; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i + 1];
+
+    job.stats[i].index = (int)i + 1;
+    job.stats[i].size = (shdr->sh_type == SHT_NOBITS) ? 0 : shdr->sh_size;
+    job.order[i] = i;
+  }
+  qsort_r(job.order, count, sizeof(size_t), hash_order_cmp, job.stats);
+
+  pool_run(count, 0, hash_job, &job);
+
+  hash_sha256_init(&combined);
+  out_str(out, "[Nr] Name                Size        XXH3              SHA-256\n");
+  for (size_t i = 0; i < count; ++i) {
+    const hash_stat_t *stat = &job.stats[i];
+    const char *name = elf_section_name(elf, &elf->elf_section_header[stat->index]);
+    bool excluded = hash_excluded(name, file->arg);
+
+    out_udec(out, stat->index, 4, 0);
+    out_char(out, excluded ? '-' : ' ');
+    out_pad(out, name, 19, OUT_LEFT | OUT_TRUNC);
+    out_char(out, ' ');
+    out_hex(out, stat->size, 8, 10, OUT_LEFT);
+    out_str(out, "  ");
+    if (!stat->ok) {
+      out_str(out, "out of the file bounds\n");
+      ok = false;
+      continue;
+    }
+    out_hex(out, stat->xxh3, 16, 16, 0);
+    out_str(out, "  ");
+    hash_hex(out, stat->sha256, sizeof(stat->sha256));
+    out_char(out, '\n');
+
+    if (excluded)
+      continue;
+    hash_sha256_update(&combined, name, strlen(name) + 1);
+    hash_sha256_update(&combined, stat->sha256, sizeof(stat->sha256));
+    included++;
+  }
+
+  if (ok) {
+    hash_sha256_final(&combined, digest);
+    out_str(out, "\nCombined SHA-256 of ");
+    out_udec(out, included, 0, 0);
+    out_str(out, " of ");
+    out_udec(out, count, 0, 0);
+    out_str(out, " sections: ");
+    hash_hex(out, digest, sizeof(digest));
+    out_char(out, '\n');
+  } else {
+    out_str(out, "\nNo combined digest, some sections are out of the file bounds.\n");
+  }
+
+  free(job.stats);
+  free(job.order);
+}
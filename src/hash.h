@@ -0,0 +1,46 @@
+#ifndef _HASH_H
+#define _HASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#define HASH_CHUNK (1 << 20)   /* bytes fed to both hashes at a time */
+#define HASH_XXH3_BLOCK 1024   /* 16 stripes of 64 bytes */
+
+typedef struct hash_xxh3 {
+  uint64_t acc[8];
+  uint64_t len;
+  size_t buffered;
+  unsigned char buf[HASH_XXH3_BLOCK];
+  unsigned char last[64];       /* the end of the last block, for the final stripe */
+} hash_xxh3_t;
+
+typedef struct hash_sha256 {
+  uint32_t state[8];
+  uint64_t len;
+  size_t buffered;
+  unsigned char buf[64];
+} hash_sha256_t;
+
+typedef struct hash_stat {
+  int index;
+  uint64_t size;
+  uint64_t xxh3;
+  unsigned char sha256[32];
+  bool ok;
+} hash_stat_t;
+
+void hash_xxh3_init(hash_xxh3_t *xxh);
+void hash_xxh3_update(hash_xxh3_t *xxh, const void *data, size_t len);
+uint64_t hash_xxh3_final(const hash_xxh3_t *xxh);
+void hash_sha256_init(hash_sha256_t *sha);
+void hash_sha256_update(hash_sha256_t *sha, const void *data, size_t len);
+void hash_sha256_final(hash_sha256_t *sha, unsigned char digest[32]);
+void hash_sections(batch_file_t *file);
+
+#endif
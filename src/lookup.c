@@ -0,0 +1,409 @@
+/**
+ * @file lookup.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Symbol lookup by name, through .gnu.hash / .hash or an index built on the fly.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+/**
+ * @brief The hash function used by SHT_GNU_HASH (djb2).
+ * 
+ */
+
+uint32_t gnu_hash(const char *name) {
+  uint32_t h = 5381;
+
+  for (const unsigned char *p = (const unsigned char *)name; *p; ++p)
+    h = (h << 5) + h + *p;
+  return h;
+}
+
+/**
+ * @brief The hash function used by SHT_HASH.
+ * 
+ */
+
+uint32_t sysv_hash(const char *name) {
+  uint32_t h = 0, g;
+
+  for (const unsigned char *p = (const unsigned char *)name; *p; ++p) {
+    h = (h << 4) + *p;
+    if ((g = h & 0xf0000000))
+      h ^= g >> 24;
+    h &= ~g;
+  }
+  return h;
+}
+
+/**
+ * @brief Tells if `sym` should win over `old` when both have the same name.
+ * 
+ * Defined globals beat locals and undefined references, so the index answers
+ * the same way a dynamic lookup would.
+ */
+
+static inline __attribute__((always_inline)) bool symbol_preferred(const Elf64_Sym *sym, const Elf64_Sym *old) {
+  bool sym_def = sym->st_shndx != SHN_UNDEF && ELF64_ST_BIND(sym->st_info) != STB_LOCAL;
+  bool old_def = old->st_shndx != SHN_UNDEF && ELF64_ST_BIND(old->st_info) != STB_LOCAL;
+
+  return (sym_def && !old_def);
+}
+
+/**
+ * @brief Returns the name of a symbol of the table, "" if st_name is out of the string table.
+ * 
+ */
+
+const char *symtab_name(const symtab_t *tab, size_t index) {
+  return elf_string(tab->strtab, tab->strsize, tab->syms[index].st_name);
+}
+
+/**
+ * @brief Builds an open addressing hash index over a symbol table.
+ * 
+ * Used when the file carries no hash section for the table (.symtab never
+ * does). Each slot packs the name hash next to the symbol index, so most
+ * probes are decided without touching the string table.
+ * 
+ * @param tab The symbol table, its index gets filled in.
+ * @return bool false if we ran out of memory.
+ */
+
+static bool symhash_build(symtab_t *tab) {
+  size_t size = 16;
+
+  while (size < tab->count * 2)
+    size <<= 1;
+
+  if (!(tab->index.slots = calloc(size, sizeof(uint64_t))))
+    return false;
+  tab->index.mask = size - 1;
+
+  for (size_t i = 1; i < tab->count; ++i) {
+    const char *name = symtab_name(tab, i);
+
+    if (!*name)
+      continue;
+
+    uint32_t h = gnu_hash(name);
+    size_t slot = h & tab->index.mask;
+
+    for (;; slot = (slot + 1) & tab->index.mask) {
+      uint64_t entry = tab->index.slots[slot];
+
+      if (!entry) {
+        tab->index.slots[slot] = ((uint64_t)h << 32) | (i + 1);
+        break;
+      }
+
+      size_t old = (uint32_t)entry - 1;
+
+      if ((uint32_t)(entry >> 32) == h && !strcmp(name, symtab_name(tab, old))) {
+        if (symbol_preferred(&tab->syms[i], &tab->syms[old]))
+          tab->index.slots[slot] = ((uint64_t)h << 32) | (i + 1);
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Looks a name up in the on the fly index.
+ * 
+ * The index keeps the preferred symbol of each name only.
+ */
+
+static long symhash_find(const symtab_t *tab, const char *name, uint32_t h, long prev) {
+  if (prev >= 0)
+    return -1; /* one symbol per name */
+
+  for (size_t slot = h & tab->index.mask;; slot = (slot + 1) & tab->index.mask) {
+    uint64_t entry = tab->index.slots[slot];
+
+    if (!entry)
+      return -1;
+    if ((uint32_t)(entry >> 32) == h
+        && !strcmp(name, symtab_name(tab, (uint32_t)entry - 1)))
+      return (long)(uint32_t)entry - 1;
+  }
+}
+
+/**
+ * @brief Looks a name up through SHT_GNU_HASH, bloom filter first.
+ * 
+ * The bloom filter is made of ELFCLASS-sized words, W is 32 or 64 and one
+ * function is generated for each. Symbols of the same name (versions)
+ * share a chain, the one after index `prev` is returned.
+ */
+
+#define GNU_HASH_FIND(fn, W) \
+  static long fn(const symtab_t *tab, const char *name, uint32_t h, long prev) { \
+    const uint32_t *hdr = tab->hash; \
+    uint32_t nbuckets = hdr[0], symoffset = hdr[1], bloom_size = hdr[2], bloom_shift = hdr[3]; \
+    const uint##W##_t *bloom = (const uint##W##_t *)(hdr + 4); \
+    const uint32_t *buckets = (const uint32_t *)(bloom + bloom_size); \
+    const uint32_t *chain = buckets + nbuckets; \
+    size_t chain_words = tab->hash_words - (chain - hdr); \
+    \
+    uint##W##_t word = bloom[(h / W) % bloom_size]; \
+    uint##W##_t mask = ((uint##W##_t)1 << (h % W)) | ((uint##W##_t)1 << ((h >> bloom_shift) % W)); \
+    \
+    /* the bloom filter says no for most of the names that aren't there */ \
+    if ((word & mask) != mask) \
+      return -1; \
+    \
+    uint32_t i = buckets[h % nbuckets]; \
+    \
+    if (i < symoffset) \
+      return -1; \
+    \
+    for (; i < tab->count && i - symoffset < chain_words; ++i) { \
+      uint32_t h2 = chain[i - symoffset]; \
+      \
+      if ((long)i > prev && (h | 1) == (h2 | 1) && !strcmp(name, symtab_name(tab, i))) \
+        return i; \
+      if (h2 & 1) \
+        break; /* end of the chain */ \
+    } \
+    return -1; \
+  }
+
+GNU_HASH_FIND(gnu_hash_find, 64)
+GNU_HASH_FIND(gnu_hash_find32, 32)
+
+/**
+ * @brief Looks a name up through SHT_HASH.
+ * 
+ */
+
+static long sysv_hash_find(const symtab_t *tab, const char *name, long prev) {
+  uint32_t nbucket = tab->hash[0], nchain = tab->hash[1];
+  const uint32_t *bucket = tab->hash + 2;
+  const uint32_t *chain = bucket + nbucket;
+  bool after = prev < 0;
+
+  for (uint32_t i = bucket[sysv_hash(name) % nbucket], n = 0;
+       i != STN_UNDEF && i < nchain && i < tab->count && n < nchain;
+       i = chain[i], ++n) {
+    if (after && !strcmp(name, symtab_name(tab, i)))
+      return i;
+    after = after || (long)i == prev;
+  }
+  return -1;
+}
+
+/**
+ * @brief Checks that a hash section is big enough for the tables it claims to have.
+ * 
+ */
+
+static bool hash_section_valid(const Elf64_Shdr *shdr, const uint32_t *hash, size_t bloom_words) {
+  size_t words = shdr->sh_size / sizeof(uint32_t);
+
+  if (shdr->sh_type == SHT_HASH)
+    return (words >= 2 && hash[0] && words >= 2 + (size_t)hash[0] + hash[1]);
+
+  return (words >= 4 && hash[0] && hash[2]
+          && words >= 4 + (size_t)hash[2] * bloom_words + hash[0]);
+}
+
+/**
+ * @brief Prepares a symbol table for lookups by name.
+ * 
+ * SHT_GNU_HASH is preferred over SHT_HASH, and if the table has neither
+ * (always the case for .symtab) an index is built over its string table.
+ * 
+ * @param elf A pointer to the struct.
+ * @param shndx The index of the SHT_SYMTAB/SHT_DYNSYM section.
+ * @param tab The table to fill in.
+ * @return bool false if the section is not a symbol table or we ran out of memory.
+ */
+
+bool symtab_open(elf_t *elf, int shndx, symtab_t *tab) {
+  const Elf64_Shdr *shdr = &elf->elf_section_header[shndx];
+
+  memset(tab, 0, sizeof(symtab_t));
+
+  if ((shdr->sh_type != SHT_SYMTAB && shdr->sh_type != SHT_DYNSYM) || !shdr->sh_entsize)
+    return false;
+
+  tab->syms = (const Elf64_Sym *)elf_section_table(elf, shndx);
+  tab->count = shdr->sh_size / shdr->sh_entsize;
+  tab->strtab = elf_section_data(elf, shdr->sh_link);
+
+  if (!tab->syms || !tab->strtab)
+    return false;
+
+  tab->strsize = elf->elf_section_header[shdr->sh_link].sh_size;
+  tab->name = elf_section_name(elf, shdr);
+  tab->method = SYMTAB_INDEX;
+
+  bool elf32 = elf->elf_header->e_ident[EI_CLASS] == ELFCLASS32;
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    const Elf64_Shdr *hash = &elf->elf_section_header[i];
+
+    if ((hash->sh_type != SHT_GNU_HASH && hash->sh_type != SHT_HASH)
+        || hash->sh_link != (Elf64_Word)shndx)
+      continue;
+
+    const uint32_t *words = (const uint32_t *)elf_section_table(elf, i);
+
+    if (!words || !hash_section_valid(hash, words, elf32 ? 1 : 2))
+      continue;
+
+    /* keep looking if all we've got so far is the old style table */
+    if (hash->sh_type == SHT_GNU_HASH || tab->method == SYMTAB_INDEX) {
+      tab->method = (hash->sh_type != SHT_GNU_HASH) ? SYMTAB_SYSV_HASH
+                    : elf32 ? SYMTAB_GNU_HASH32 : SYMTAB_GNU_HASH;
+      tab->hash = words;
+      tab->hash_words = hash->sh_size / sizeof(uint32_t);
+    }
+  }
+
+  if (tab->method == SYMTAB_INDEX)
+    return symhash_build(tab);
+  return true;
+}
+
+/**
+ * @brief Finds a symbol by name.
+ * 
+ * @param tab The symbol table.
+ * @param name The name.
+ * @return long The symbol index, -1 if it is not there.
+ */
+
+long symtab_find(const symtab_t *tab, const char *name) {
+  return symtab_find_next(tab, name, gnu_hash(name), -1);
+}
+
+/**
+ * @brief Finds the next symbol of a name, with its gnu_hash() computed once by the caller.
+ * 
+ * What a loader does when it looks one name up in many tables: the hash
+ * is reused, and the bloom filter turns most of the tables away.
+ * 
+ * @param tab The symbol table.
+ * @param name The name.
+ * @param hash gnu_hash(name).
+ * @param prev The index returned last time, -1 to start.
+ * @return long The symbol index, -1 if there are no more.
+ */
+
+long symtab_find_next(const symtab_t *tab, const char *name, uint32_t hash, long prev) {
+  switch (tab->method) {
+    case SYMTAB_GNU_HASH:  return gnu_hash_find(tab, name, hash, prev); break;
+    case SYMTAB_GNU_HASH32: return gnu_hash_find32(tab, name, hash, prev); break;
+    case SYMTAB_SYSV_HASH: return sysv_hash_find(tab, name, prev); break;
+    default:               return symhash_find(tab, name, hash, prev); break;
+  }
+}
+
+/**
+ * @brief Frees whatever symtab_open() allocated.
+ * 
+ */
+
+void symtab_close(symtab_t *tab) {
+  free(tab->index.slots);
+  tab->index.slots = NULL;
+}
+
+/**
+ * @brief Get the name of the lookup method.
+ * 
+ */
+
+static const char *get_symtab_method(symtab_method_t method) {
+  switch (method) {
+    case SYMTAB_GNU_HASH:
+    case SYMTAB_GNU_HASH32: return ("SHT_GNU_HASH"); break;
+    case SYMTAB_SYSV_HASH: return ("SHT_HASH"); break;
+    default:               return ("index built from the string table"); break;
+  }
+}
+
+/**
+ * @brief Looks up the comma separated names in file->arg in every symbol table.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void lookup_symbols(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  char *names = strdup(file->arg);
+
+  if (!names)
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the names!");
+
+  size_t count = 1;
+
+  /* split in place, every name becomes its own string */
+  for (char *p = names; *p; ++p) {
+    if (*p == ',') {
+      *p = '\0';
+      ++count;
+    }
+  }
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    symtab_t tab;
+
+    if (!symtab_open(elf, i, &tab))
+      continue;
+
+    out_str(out, "Symbol lookup in ");
+    out_str(out, tab.name);
+    out_str(out, " via ");
+    out_str(out, get_symtab_method(tab.method));
+    out_str(out, ":\n"
+                 "Num:  Value  Size  Type         Bind           Vis          Ndx        Name\n");
+
+    bool missing = false;
+    const char *name = names;
+
+    for (size_t n = 0; n < count; ++n, name += strlen(name) + 1) {
+      long index = *name ? symtab_find(&tab, name) : -1;
+
+      if (index >= 0)
+        dump_symbol_row(out, index, &tab.syms[index], symtab_name(&tab, index));
+      else
+        missing = true;
+    }
+
+    if (missing) {
+      out_str(out, "Not found:");
+      name = names;
+      for (size_t n = 0; n < count; ++n, name += strlen(name) + 1) {
+        if (*name && symtab_find(&tab, name) < 0) {
+          out_char(out, ' ');
+          out_str(out, name);
+        }
+      }
+      out_char(out, '\n');
+    }
+    out_char(out, '\n');
+    symtab_close(&tab);
+  }
+  free(names);
+}
@@ -0,0 +1,40 @@
+#ifndef _LOOKUP_H
+#define _LOOKUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum symtab_method {
+  SYMTAB_GNU_HASH,
+  SYMTAB_GNU_HASH32, /* ELFCLASS32, the bloom filter has 32-bit words */
+  SYMTAB_SYSV_HASH,
+  SYMTAB_INDEX
+} symtab_method_t;
+
+typedef struct symhash {
+  uint64_t *slots; /* (name hash << 32) | (symbol index + 1), 0 is empty */
+  size_t mask;
+} symhash_t;
+
+typedef struct symtab {
+  const Elf64_Sym *syms;
+  const char *strtab;
+  uint64_t strsize;
+  size_t count;
+  const char *name;
+  symtab_method_t method;
+  const uint32_t *hash;
+  size_t hash_words;
+  symhash_t index;
+} symtab_t;
+
+uint32_t gnu_hash(const char *name);
+uint32_t sysv_hash(const char *name);
+const char *symtab_name(const symtab_t *tab, size_t index);
+bool symtab_open(elf_t *elf, int shndx, symtab_t *tab);
+long symtab_find(const symtab_t *tab, const char *name);
+long symtab_find_next(const symtab_t *tab, const char *name, uint32_t hash, long prev);
+void symtab_close(symtab_t *tab);
+void lookup_symbols(batch_file_t *file);
+
+#endif
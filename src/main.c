@@ -1,51 +1,249 @@
 #include "all.h"
 
 arg_t args[] = {
-  {"-h", dump_elf_header},
-  {"-p", dump_program_headers},
-  {"-S", dump_section_headers},
-  {"-st", dump_symbol_table}
+  {"-h", dump_elf_header, false, true, true, true},
+  {"-p", dump_program_headers, false, true, true, true},
+  {"-S", dump_section_headers, false, true, true, true},
+  {"-st", dump_symbol_table, false, true, true, true},
+  {"-l", lookup_symbols, true, true, false, true},
+  {"-a", resolve_addresses, true, true, false, false},
+  {"-L", resolve_lines, true, false, false, false},
+  {"-q", query_symbols, true, true, false, true},
+  {"-d", diff_files, true, false, false, false},
+  {"-H", hash_sections, false, false, false, true},
+  {"-b", bloat_report, false, false, false, true},
+  {"-z", dump_compressed_sections, false, false, false, true},
+  {"-x", extract_section, true, false, false, true},
+  {"-R", summarize_relocations, false, true, false, true},
+  {"-Rd", dump_relocations, false, true, false, true},
+  {"-N", dump_core, false, false, false, true},
+  {"-D", resolve_dependencies, true, false, false, false},
+  {"-B", bind_symbols, true, false, false, false}
 };
 
 /**
- * @brief Based on the options specified, it will call a certain function.
+ * @brief Based on the options specified, it will return the matching entry.
  * 
  * @param arg The option.
- * @param elf A pointer to the struct.
+ * @return const arg_t* The entry, NULL if the option is unknown.
  */
 
-static bool handler(const char *arg, elf_t *elf) {
+static const arg_t *handler(const char *arg) {
   for (unsigned int i = 0; i < sizeof(args)/sizeof(args[0]); ++i) {
-    if (strstr(arg, args[i].name)) {
-      (args[i].func)(elf);
-      return true;
-    }
+    if (!strcmp(arg, args[i].name))
+      return &args[i];
   }
-  return false;
+  return NULL;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "Usage: %s <option> [argument] [-j <threads>] [-T <threads>] [-c <dir>] [-m <backend>] [-f <format>] [--stats[=json]] <file|@listfile|-> ...\n", name);
+  fprintf(stderr, "       %s -r [-m pread] <dir> ...\n", name);
+  fprintf(stderr, "       %s -s <socket> [-j <threads>] [-n <files>]\n", name);
+  fprintf(stderr, "       %s -C <socket> stats\n", name);
+  fprintf(stderr, 
+          "-h - Dump ELF header.\n"
+          "-p - Dump program headers.\n"
+          "-S - Dump section header.\n"
+          "-st - Dump symbol table.\n"
+          "-l <names> - Look up comma separated symbol names through the hash tables.\n"
+          "-q <query> - Filter, sort and rank symbols, e.g. type=FUNC,bind=GLOBAL,name=*alloc*,sort=-size,limit=100.\n"
+          "-d <old> - Compare sections and symbols with an older build, biggest size changes first.\n"
+          "-H [-e <sections>] - XXH3-64 and SHA-256 of every section, and a combined SHA-256 leaving out the comma separated globs of -e.\n"
+          "-b - Where the size goes: sections, symbols in them, and symbols rolled up by namespace or name prefix.\n"
+          "-a <file|-> - Resolve hex addresses read from file (or stdin) to symbol+offset.\n"
+          "-L <file|-> - Resolve hex addresses to file:line through .debug_line, the table is kept in the -c directory.\n"
+          "-z - List SHF_COMPRESSED sections, decompressing them in parallel to check them.\n"
+          "-x <section> - Write the contents of a section, decompressed, to stdout.\n"
+          "-R - Sum relocations up by type and target section, with the pages they dirty at load (RELR included).\n"
+          "-Rd - List every relocation.\n"
+          "-D <sysroot> - Resolve DT_NEEDED like ld.so would, inside sysroot (/ for this system): load order and graph.\n"
+          "-B <sysroot> - Bind every undefined and GOT/PLT symbol to the library -D loads it from, with versions: unresolved and interposed symbols.\n"
+          "-N - Decode a core dump from its notes alone: threads and registers, signal, mapped files, auxv.\n"
+          "-f - Output format of -h, -p, -S and -st: text (default), json (a document per file) or ndjson (an object per row).\n"
+          "--stats - Time open, init, the handler and teardown of each file, count faults, touched bytes and output, on stderr.\n"
+          "-r - Walk directories recursively and list the ELF files in them, with their type and machine.\n"
+          "-j - Number of worker threads for multiple files (default: one per CPU).\n"
+          "-T - Number of threads rendering each symbol table of -st in chunks, written in order (default: 1).\n"
+          "-c - Cache directory, repeat runs are served from it without reading the files.\n"
+          "-m - How the files are read: auto (default), mmap or pread (only the parts needed).\n"
+          "-s - Serve queries on a Unix socket, keeping up to -n (default 256) parsed files mapped.\n"
+          "-C - Send the queries to a server started with -s instead, `-C <socket> stats` prints its latency and throughput.\n"
+          "@listfile - Read newline separated paths from listfile.\n"
+          "- - Read NUL separated paths from stdin.\n");
+  exit(EXIT_FAILURE);
 }
 
 int main(int argc, char *argv[]) {
-  if (argc != 3) {
-    fprintf(stderr, "Usage: %s <option> <file>\n", argv[0]);
-    fprintf(stderr, 
-            "-h - Dump ELF header.\n"
-            "-p - Dump program headers.\n"
-            "-S - Dump section header.\n"
-            "-st - Dump symbol table.\n");
+  if (argc < 3)
+    usage(argv[0]);
+
+  if (!strcmp(argv[1], "-r")) {
+    /* scans read the first bytes of each file themselves, only pread changes anything */
+    bool uring = !(argc > 3 && !strcmp(argv[2], "-m") && !strcmp(argv[3], "pread"));
+    int first = (argc > 3 && !strcmp(argv[2], "-m")) ? 4 : 2;
+
+    if (first == argc)
+      usage(argv[0]);
+    return (run_scan(argv + first, argc - first, uring) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  if (!strcmp(argv[1], "-s")) {
+    unsigned int threads = 0;
+    size_t files = SERVE_FILES;
+
+    for (int i = 3; i < argc; ++i) {
+      if (i + 1 == argc)
+        usage(argv[0]);
+      if (!strcmp(argv[i], "-j"))
+        threads = (unsigned int)strtoul(argv[++i], NULL, 10);
+      else if (!strcmp(argv[i], "-n"))
+        files = strtoul(argv[++i], NULL, 10);
+      else
+        usage(argv[0]);
+    }
+    return (run_server(argv[2], args, sizeof(args)/sizeof(args[0]), threads, files) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  if (!strcmp(argv[1], "-C")) {
+    if (argc != 4 || strcmp(argv[3], "stats"))
+      usage(argv[0]);
+    return (client_stats(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  const arg_t *arg = handler(argv[1]);
+
+  if (!arg) {
+    fprintf(stderr, "Invalid option.\n");
     exit(EXIT_FAILURE);
   }
 
-  int fd = open(argv[2], O_RDONLY);
+  batch_t batch = {.func = arg->func};
+  cache_t cache = {0};
+  const char *server = NULL;
+  int first = 2;
+
+  if (arg->param) {
+    if (argc < 4)
+      usage(argv[0]);
+    batch.arg = argv[first++];
+  }
+
+  for (int i = first; i < argc; ++i) {
+    if (!strcmp(argv[i], "-j")) {
+      if (++i == argc)
+        usage(argv[0]);
+      batch.jobs = (unsigned int)strtoul(argv[i], NULL, 10);
+      continue;
+    }
+
+    if (!strcmp(argv[i], "-c")) {
+      if (++i == argc)
+        usage(argv[0]);
+      cache.dir = argv[i];
+      if (mkdir(cache.dir, 0755) == -1 && errno != EEXIST) {
+        fprintf(stderr, "%s: Failed to create the cache directory.\n", cache.dir);
+        exit(EXIT_FAILURE);
+      }
+      /* handlers that read more than the metadata always go to the file */
+      batch.cache = arg->cacheable ? &cache : NULL;
+      batch.index_dir = cache.dir;
+      continue;
+    }
 
-  if (fd == -1) {
-    close(fd);
+    if (!strcmp(argv[i], "-C")) {
+      if (++i == argc)
+        usage(argv[0]);
+      if (!arg->served) {
+        fprintf(stderr, "%s: The server doesn't run this option.\n", argv[1]);
+        exit(EXIT_FAILURE);
+      }
+      server = argv[i];
+      continue;
+    }
+
+    if (!strcmp(argv[i], "-m")) {
+      if (++i == argc)
+        usage(argv[0]);
+      if (!strcmp(argv[i], "mmap"))
+        batch.backend = ELF_BACKEND_MMAP;
+      else if (!strcmp(argv[i], "pread"))
+        batch.backend = ELF_BACKEND_PREAD;
+      else if (strcmp(argv[i], "auto"))
+        usage(argv[0]);
+      continue;
+    }
+
+    if (!strcmp(argv[i], "--stats") || !strcmp(argv[i], "--stats=text")) {
+      batch.stats = STATS_TEXT;
+      continue;
+    }
+
+    if (!strcmp(argv[i], "--stats=json")) {
+      batch.stats = STATS_JSON;
+      continue;
+    }
+
+    if (!strcmp(argv[i], "-T")) {
+      if (++i == argc)
+        usage(argv[0]);
+      if (arg->func != dump_symbol_table) {
+        fprintf(stderr, "%s: Only -st renders in chunks.\n", argv[1]);
+        exit(EXIT_FAILURE);
+      }
+      batch.render_threads = (unsigned int)strtoul(argv[i], NULL, 10);
+      continue;
+    }
+
+    if (!strcmp(argv[i], "-e")) {
+      if (++i == argc)
+        usage(argv[0]);
+      if (arg->func != hash_sections) {
+        fprintf(stderr, "%s: Only -H leaves sections out.\n", argv[1]);
+        exit(EXIT_FAILURE);
+      }
+      batch.arg = argv[i];
+      continue;
+    }
+
+    if (!strcmp(argv[i], "-f")) {
+      if (++i == argc)
+        usage(argv[0]);
+      if (!strcmp(argv[i], "json"))
+        batch.format = OUT_JSON;
+      else if (!strcmp(argv[i], "ndjson"))
+        batch.format = OUT_NDJSON;
+      else if (strcmp(argv[i], "text"))
+        usage(argv[0]);
+      if (batch.format != OUT_TEXT && !arg->structured) {
+        fprintf(stderr, "%s: Only -h, -p, -S and -st have structured output.\n", argv[1]);
+        exit(EXIT_FAILURE);
+      }
+      continue;
+    }
+
+    if (!batch_add_arg(&batch, argv[i])) {
+      fprintf(stderr, "%s: Failed to read the list of files.\n", argv[i]);
+      destroy_batch(&batch);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  /* -T and -f can come in either order, the chunked renderer is text only */
+  if (batch.render_threads && batch.format != OUT_TEXT) {
+    fprintf(stderr, "%s: Only the text output of -st renders in chunks.\n", argv[1]);
+    destroy_batch(&batch);
     exit(EXIT_FAILURE);
   }
 
-  elf_t *elf = init_elf(fd);
+  bool ok = batch.count ? (server ? run_client(server, arg, &batch) : run_batch(&batch)) : false;
 
-  if (!handler(argv[1], elf))
-    error_handling(fd, elf, elf->file, "Invalid option.");
+  if (!batch.count)
+    fprintf(stderr, "No files given.\n");
 
-  destroy_parser(fd, elf->file, elf);
-}
\ No newline at end of file
+  if (batch.cache)
+    cache_report(batch.cache);
+
+  destroy_batch(&batch);
+  return (ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -7,7 +7,11 @@
 
 typedef struct arg {
   const char *name;
-  void (*func)(elf_t *);
+  void (*func)(batch_file_t *);
+  bool param;
+  bool cacheable; /* only reads what a cache entry holds */
+  bool structured; /* honours -f json|ndjson */
+  bool served; /* only reads the file, so the server (-s) can run it */
 } arg_t;
 
 #endif
\ No newline at end of file
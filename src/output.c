@@ -0,0 +1,518 @@
+/**
+ * @file output.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Buffered output, so we don't pay for printf on every single row.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+static const char digit_pairs[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+static const char hex_digits[] = "0123456789abcdef";
+
+/**
+ * @brief Sets up an output buffer.
+ * 
+ * @param out A pointer to the buffer.
+ * @param fd Where flushes go, -1 keeps everything in memory instead.
+ */
+
+bool out_init(out_t *out, int fd) {
+  out->len = out->bytes = 0;
+  out->fd = fd;
+  out->count_lines = false;
+  out->lines = out->counted = 0;
+  out->cap = OUT_BUFFER_SIZE;
+  return ((out->buf = malloc(out->cap)) ? true : false);
+}
+
+/**
+ * @brief write(2) until everything is out, or the other end is gone.
+ * 
+ */
+
+static void write_all(int fd, const char *data, size_t len) {
+  for (size_t done = 0; done < len;) {
+    ssize_t n = write(fd, data + done, len - done);
+
+    if (n <= 0 && errno != EINTR)
+      break; /* nobody is listening anymore, drop it */
+    if (n > 0)
+      done += n;
+  }
+}
+
+/**
+ * @brief Counts the newlines in a block.
+ * 
+ */
+
+static uint64_t count_newlines(const char *data, size_t len) {
+  uint64_t lines = 0;
+
+  for (const char *end = data + len; (data = memchr(data, '\n', end - data)); ++data)
+    lines++;
+  return lines;
+}
+
+/**
+ * @brief Returns how many lines went through the buffer since count_lines was set.
+ * 
+ * Lines are counted a block at a time, when the buffer is flushed or when
+ * this is called, so nothing is counted unless someone asked for it.
+ */
+
+uint64_t out_lines(out_t *out) {
+  if (out->count_lines) {
+    out->lines += count_newlines(out->buf + out->counted, out->len - out->counted);
+    out->counted = out->len;
+  }
+  return out->lines;
+}
+
+/**
+ * @brief Writes out whatever is buffered with a single write(2).
+ * 
+ * Memory buffers (fd == -1) are left alone.
+ * 
+ * @param out A pointer to the buffer.
+ */
+
+void out_flush(out_t *out) {
+  if (out->fd == -1)
+    return;
+
+  out_lines(out);
+  write_all(out->fd, out->buf, out->len);
+  out->len = out->counted = 0;
+}
+
+/**
+ * @brief Flushes the buffer and frees it.
+ * 
+ * @param out A pointer to the buffer.
+ */
+
+void out_destroy(out_t *out) {
+  out_flush(out);
+  free(out->buf);
+  out->buf = NULL;
+}
+
+/**
+ * @brief Makes sure there's room for `need` more bytes, flushing or growing.
+ * 
+ * @param out A pointer to the buffer.
+ * @param need The number of bytes about to be written.
+ * @return char* Where to write them, NULL if we ran out of memory.
+ */
+
+static inline __attribute__((always_inline)) char *out_reserve(out_t *out, size_t need) {
+  if (out->len + need <= out->cap)
+    return out->buf + out->len;
+
+  if (out->fd != -1) {
+    out_flush(out);
+    if (need <= out->cap)
+      return out->buf;
+  }
+
+  size_t cap = out->cap;
+
+  while (cap < out->len + need)
+    cap *= 2;
+
+  char *tmp = realloc(out->buf, cap);
+
+  if (!tmp)
+    return NULL;
+  out->buf = tmp;
+  out->cap = cap;
+  return out->buf + out->len;
+}
+
+/**
+ * @brief Appends raw bytes.
+ * 
+ */
+
+void out_write(out_t *out, const char *data, size_t len) {
+  /* blocks bigger than the whole buffer skip it */
+  if (out->fd != -1 && len > out->cap) {
+    out_flush(out);
+    if (out->count_lines)
+      out->lines += count_newlines(data, len);
+    write_all(out->fd, data, len);
+    out->bytes += len;
+    return;
+  }
+
+  char *dst = out_reserve(out, len);
+
+  if (!dst)
+    return;
+  memcpy(dst, data, len);
+  out->len += len;
+  out->bytes += len;
+}
+
+/**
+ * @brief Appends a NUL terminated string.
+ * 
+ */
+
+void out_str(out_t *out, const char *str) {
+  out_write(out, str, strlen(str));
+}
+
+/**
+ * @brief Appends a single character.
+ * 
+ */
+
+void out_char(out_t *out, char c) {
+  char *dst = out_reserve(out, 1);
+
+  if (!dst)
+    return;
+  *dst = c;
+  out->len++;
+  out->bytes++;
+}
+
+/**
+ * @brief Appends `str` padded with spaces to `width`, like '%-*s' or '%*s'.
+ * 
+ * @param out A pointer to the buffer.
+ * @param str The string.
+ * @param width The field width.
+ * @param flags OUT_LEFT and/or OUT_TRUNC.
+ */
+
+void out_pad(out_t *out, const char *str, unsigned int width, int flags) {
+  size_t len = (flags & OUT_TRUNC) ? strnlen(str, width) : strlen(str);
+  size_t pad = (len < width) ? width - len : 0;
+  char *dst = out_reserve(out, len + pad);
+
+  if (!dst)
+    return;
+
+  if (!(flags & OUT_LEFT)) {
+    memset(dst, ' ', pad);
+    dst += pad;
+  }
+  memcpy(dst, str, len);
+  if (flags & OUT_LEFT)
+    memset(dst + len, ' ', pad);
+
+  out->len += len + pad;
+  out->bytes += len + pad;
+}
+
+/**
+ * @brief Appends a number, the same way printf's integer conversions do.
+ * 
+ * @param out A pointer to the buffer.
+ * @param value The magnitude.
+ * @param negative Whether a '-' goes in front.
+ * @param base 10 or 16.
+ * @param prec Minimum number of digits, zero padded ('%.N').
+ * @param width The field width, space padded.
+ * @param flags OUT_LEFT.
+ */
+
+void out_num(out_t *out, uint64_t value, bool negative, unsigned int base,
+             unsigned int prec, unsigned int width, int flags) {
+  char tmp[24];
+  char *end = tmp + sizeof(tmp), *p = end;
+
+  if (base == 16) {
+    do {
+      *--p = hex_digits[value & 0xf];
+      value >>= 4;
+    } while (value);
+  } else {
+    while (value >= 100) {
+      unsigned int pair = (unsigned int)(value % 100) * 2;
+
+      value /= 100;
+      *--p = digit_pairs[pair + 1];
+      *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+      *--p = digit_pairs[value * 2 + 1];
+      *--p = digit_pairs[value * 2];
+    } else {
+      *--p = '0' + (char)value;
+    }
+  }
+
+  size_t digits = end - p;
+  size_t zeros = (prec > digits) ? prec - digits : 0;
+  size_t len = digits + zeros + negative;
+  size_t pad = (width > len) ? width - len : 0;
+  char *dst = out_reserve(out, len + pad);
+
+  if (!dst)
+    return;
+
+  if (!(flags & OUT_LEFT)) {
+    memset(dst, ' ', pad);
+    dst += pad;
+  }
+  if (negative)
+    *dst++ = '-';
+  memset(dst, '0', zeros);
+  memcpy(dst + zeros, p, digits);
+  if (flags & OUT_LEFT)
+    memset(dst + zeros + digits, ' ', pad);
+
+  out->len += len + pad;
+  out->bytes += len + pad;
+}
+
+/**
+ * @brief '%*lu' / '%-*lu'.
+ * 
+ */
+
+void out_udec(out_t *out, uint64_t value, unsigned int width, int flags) {
+  out_num(out, value, false, 10, 0, width, flags);
+}
+
+/**
+ * @brief '%*ld' / '%-*ld'.
+ * 
+ */
+
+void out_sdec(out_t *out, int64_t value, unsigned int width, int flags) {
+  if (value < 0)
+    out_num(out, -(uint64_t)value, true, 10, 0, width, flags);
+  else
+    out_num(out, (uint64_t)value, false, 10, 0, width, flags);
+}
+
+/**
+ * @brief '%*.*lx' / '%-*.*lx'.
+ * 
+ */
+
+void out_hex(out_t *out, uint64_t value, unsigned int prec, unsigned int width, int flags) {
+  out_num(out, value, false, 16, prec, width, flags);
+}
+
+/**
+ * @brief Starts a JSON writer, it lives on the stack and never allocates.
+ * 
+ */
+
+void json_init(json_t *json, out_t *out) {
+  memset(json, 0, sizeof(json_t));
+  json->out = out;
+}
+
+/**
+ * @brief Writes the comma and the key that go before a value.
+ * 
+ * Values at the top level are separate documents and get no comma.
+ */
+
+static inline __attribute__((always_inline)) void json_key(json_t *json, const char *key) {
+  bool comma = json->depth && json->more[json->depth];
+  size_t len = key ? strlen(key) : 0;
+  size_t need = comma + (key ? len + 3 : 0);
+  char *dst = out_reserve(json->out, need);
+
+  json->more[json->depth] = true;
+  if (!dst)
+    return;
+
+  if (comma)
+    *dst++ = ',';
+  if (key) {
+    *dst++ = '"';
+    memcpy(dst, key, len);
+    dst[len] = '"';
+    dst[len + 1] = ':';
+  }
+  json->out->len += need;
+  json->out->bytes += need;
+}
+
+/**
+ * @brief Opens an object ('{') or an array ('[').
+ * 
+ * @param json The writer.
+ * @param key The member name, NULL inside arrays and at the top level.
+ * @param bracket '{' or '['.
+ */
+
+void json_open(json_t *json, const char *key, char bracket) {
+  json_key(json, key);
+  out_char(json->out, bracket);
+  if (json->depth + 1 < JSON_DEPTH)
+    json->more[++json->depth] = false;
+}
+
+/**
+ * @brief Closes what json_open() opened, bracket is '}' or ']'.
+ * 
+ */
+
+void json_close(json_t *json, char bracket) {
+  out_char(json->out, bracket);
+  if (json->depth)
+    json->depth--;
+}
+
+/**
+ * @brief Returns the length of the UTF-8 sequence at p, 0 if it isn't a valid one.
+ * 
+ * Overlong forms, surrogates and code points above U+10FFFF are invalid,
+ * as in RFC 3629. The string is NUL terminated, a truncated sequence
+ * stops at the NUL.
+ */
+
+static size_t utf8_len(const unsigned char *p) {
+  size_t len;
+  unsigned char lo = 0x80, hi = 0xbf;
+
+  if (p[0] >= 0xc2 && p[0] <= 0xdf)
+    len = 2;
+  else if (p[0] >= 0xe0 && p[0] <= 0xef)
+    len = 3;
+  else if (p[0] >= 0xf0 && p[0] <= 0xf4)
+    len = 4;
+  else
+    return 0;
+
+  /* the second byte carries the range checks */
+  if (p[0] == 0xe0)
+    lo = 0xa0;
+  else if (p[0] == 0xed)
+    hi = 0x9f;
+  else if (p[0] == 0xf0)
+    lo = 0x90;
+  else if (p[0] == 0xf4)
+    hi = 0x8f;
+
+  if (p[1] < lo || p[1] > hi)
+    return 0;
+  for (size_t i = 2; i < len; ++i) {
+    if ((p[i] & 0xc0) != 0x80)
+      return 0;
+  }
+  return len;
+}
+
+/**
+ * @brief Writes a string member, escaped.
+ * 
+ * Strings that need no escaping (nearly all of them) are copied straight
+ * into the buffer, the rest is copied a run at a time. Valid UTF-8 is
+ * copied as it is, bytes that aren't part of a valid sequence are written
+ * as \u00XX so the output stays valid JSON.
+ */
+
+void json_str(json_t *json, const char *key, const char *value) {
+  static const char hex[] = "0123456789abcdef";
+  out_t *out = json->out;
+  size_t len = strlen(value), i = 0;
+
+  json_key(json, key);
+
+  char *dst = out_reserve(out, len + 2);
+
+  if (!dst)
+    return;
+
+  *dst++ = '"';
+  for (; i < len; ++i) {
+    unsigned char c = value[i];
+
+    if (c < 0x20 || c == '"' || c == '\\' || c > 0x7f)
+      break;
+    dst[i] = c;
+  }
+
+  if (i == len) {
+    dst[len] = '"';
+    out->len += len + 2;
+    out->bytes += len + 2;
+    return;
+  }
+
+  out->len += i + 1;
+  out->bytes += i + 1;
+
+  const char *run = value + i;
+
+  for (const char *p = run; *p; ++p) {
+    unsigned char c = *p;
+    size_t seq;
+
+    if (c >= 0x20 && c != '"' && c != '\\' && c <= 0x7f)
+      continue;
+    if (c > 0x7f && (seq = utf8_len((const unsigned char *)p))) {
+      p += seq - 1;
+      continue;
+    }
+
+    out_write(out, run, p - run);
+    run = p + 1;
+
+    switch (c) {
+      case '"':  out_write(out, "\\\"", 2); break;
+      case '\\': out_write(out, "\\\\", 2); break;
+      case '\n': out_write(out, "\\n", 2); break;
+      case '\t': out_write(out, "\\t", 2); break;
+      default: {
+        char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+
+        out_write(out, esc, sizeof(esc));
+        break;
+      }
+    }
+  }
+  out_str(out, run);
+  out_char(out, '"');
+}
+
+/**
+ * @brief Writes an unsigned number member.
+ * 
+ */
+
+void json_uint(json_t *json, const char *key, uint64_t value) {
+  json_key(json, key);
+  out_udec(json->out, value, 0, 0);
+}
+
+/**
+ * @brief Writes a signed number member.
+ * 
+ */
+
+void json_int(json_t *json, const char *key, int64_t value) {
+  json_key(json, key);
+  out_sdec(json->out, value, 0, 0);
+}
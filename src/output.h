@@ -0,0 +1,62 @@
+#ifndef _OUTPUT_H
+#define _OUTPUT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#define OUT_BUFFER_SIZE (1 << 18)
+
+/* flags for out_num() and out_pad() */
+#define OUT_LEFT  (1 << 0) /* left-align inside the field, '%-' */
+#define OUT_TRUNC (1 << 1) /* cut strings longer than the field, '%.N' */
+
+#define JSON_DEPTH 8
+
+typedef enum out_format {
+  OUT_TEXT,
+  OUT_JSON,    /* one document per file */
+  OUT_NDJSON   /* one object per row */
+} out_format_t;
+
+typedef struct out {
+  char *buf;
+  size_t len;
+  size_t cap;
+  size_t bytes;
+  int fd;
+  bool count_lines;  /* keep `lines` up to date, for --stats */
+  uint64_t lines;
+  size_t counted;    /* buf[0..counted) is already in `lines` */
+} out_t;
+
+typedef struct json {
+  out_t *out;
+  unsigned int depth;
+  bool more[JSON_DEPTH]; /* something was already written at this level */
+} json_t;
+
+bool out_init(out_t *out, int fd);
+void out_flush(out_t *out);
+void out_destroy(out_t *out);
+uint64_t out_lines(out_t *out);
+void out_write(out_t *out, const char *data, size_t len);
+void out_str(out_t *out, const char *str);
+void out_char(out_t *out, char c);
+void out_pad(out_t *out, const char *str, unsigned int width, int flags);
+void out_num(out_t *out, uint64_t value, bool negative, unsigned int base,
+             unsigned int prec, unsigned int width, int flags);
+void out_udec(out_t *out, uint64_t value, unsigned int width, int flags);
+void out_sdec(out_t *out, int64_t value, unsigned int width, int flags);
+void out_hex(out_t *out, uint64_t value, unsigned int prec, unsigned int width, int flags);
+void json_init(json_t *json, out_t *out);
+void json_open(json_t *json, const char *key, char bracket);
+void json_close(json_t *json, char bracket);
+void json_str(json_t *json, const char *key, const char *value);
+void json_uint(json_t *json, const char *key, uint64_t value);
+void json_int(json_t *json, const char *key, int64_t value);
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file pool.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief A tiny worker pool that runs indexed jobs across threads.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+typedef struct pool {
+  pool_job_t job;
+  void *ctx;
+  size_t jobs;
+  size_t next;
+  pthread_mutex_t lock;
+  stats_mark_t used; /* CPU time and faults of the spawned threads, for --stats */
+} pool_t;
+
+/* set on the threads of a pool while they run jobs, a pool_run() from a job runs inline */
+static __thread bool pool_inside;
+
+/**
+ * @brief Returns the number of online CPUs, never less than one.
+ * 
+ */
+
+unsigned int pool_default_threads(void) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return ((cpus < 1) ? 1 : (unsigned int)cpus);
+}
+
+/**
+ * @brief Worker loop, it keeps grabbing the next job index until none are left.
+ * 
+ * @param arg A pointer to the pool.
+ */
+
+static void *pool_worker(void *arg) {
+  pool_t *pool = arg;
+
+  for (;;) {
+    pthread_mutex_lock(&pool->lock);
+    size_t index = pool->next++;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (index >= pool->jobs)
+      break;
+
+    pool->job(index, pool->ctx);
+  }
+  return NULL;
+}
+
+/**
+ * @brief A spawned thread: the worker loop, then what it used goes to the pool.
+ * 
+ * @param arg A pointer to the pool.
+ */
+
+static void *pool_thread(void *arg) {
+  pool_t *pool = arg;
+  stats_mark_t start, end;
+
+  stats_mark(&start);
+  pool_inside = true;
+  pool_worker(pool);
+  stats_mark(&end);
+
+  pthread_mutex_lock(&pool->lock);
+  pool->used.cpu_ns += end.cpu_ns - start.cpu_ns;
+  pool->used.minflt += end.minflt - start.minflt;
+  pool->used.majflt += end.majflt - start.majflt;
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+/**
+ * @brief Runs job(0..jobs-1) on up to `threads` threads and waits for all of them.
+ * 
+ * The calling thread takes part in the work, so a single thread (or a single
+ * job) never spawns anything. What the other threads used is credited to
+ * the calling thread's --stats. A pool_run() from a job of a pool that
+ * has threads runs inline on the job's thread: -j with -T (or -H, -z,
+ * archive members) stays at -j threads instead of multiplying.
+ * 
+ * @param jobs The number of jobs.
+ * @param threads The number of threads, 0 means one per online CPU.
+ * @param job The job function.
+ * @param ctx Passed untouched to every job.
+ */
+
+void pool_run(size_t jobs, unsigned int threads, pool_job_t job, void *ctx) {
+  pool_t pool = {.job = job, .ctx = ctx, .jobs = jobs, .next = 0};
+
+  if (!threads)
+    threads = pool_default_threads();
+  if (threads > jobs)
+    threads = (unsigned int)jobs;
+
+  if (threads <= 1 || pool_inside) {
+    for (size_t i = 0; i < jobs; ++i)
+      job(i, ctx);
+    return;
+  }
+
+  pthread_t *tids = calloc(threads - 1, sizeof(pthread_t));
+  unsigned int spawned = 0;
+
+  pthread_mutex_init(&pool.lock, NULL);
+
+  /* if we can't get all the threads we asked for, we just run with fewer */
+  for (; tids && spawned < threads - 1; ++spawned)
+    if (pthread_create(&tids[spawned], NULL, pool_thread, &pool))
+      break;
+
+  pool_inside = true;
+  pool_worker(&pool);
+  pool_inside = false;
+
+  for (unsigned int i = 0; i < spawned; ++i)
+    pthread_join(tids[i], NULL);
+  stats_credit(&pool.used);
+
+  pthread_mutex_destroy(&pool.lock);
+  free(tids);
+}
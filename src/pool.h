@@ -0,0 +1,12 @@
+#ifndef _POOL_H
+#define _POOL_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+typedef void (*pool_job_t)(size_t index, void *ctx);
+
+unsigned int pool_default_threads(void);
+void pool_run(size_t jobs, unsigned int threads, pool_job_t job, void *ctx);
+
+#endif
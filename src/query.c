@@ -0,0 +1,523 @@
+/**
+ * @file query.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Filters, sorts and ranks symbols without formatting the ones that lose.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+typedef struct query_hit {
+  uint64_t key;
+  const Elf64_Sym *sym;
+  const char *name;
+  uint32_t table;
+  uint32_t index;
+} query_hit_t;
+
+typedef struct query_name {
+  const char *name;
+  unsigned int value;
+} query_name_t;
+
+static const query_name_t query_types[] = {
+  {"NOTYPE", STT_NOTYPE}, {"OBJECT", STT_OBJECT}, {"FUNC", STT_FUNC}, {"SECTION", STT_SECTION},
+  {"FILE", STT_FILE}, {"COMMON", STT_COMMON}, {"TLS", STT_TLS}, {"IFUNC", STT_GNU_IFUNC}, {NULL, 0}
+};
+
+static const query_name_t query_binds[] = {
+  {"LOCAL", STB_LOCAL}, {"GLOBAL", STB_GLOBAL}, {"WEAK", STB_WEAK}, {"UNIQUE", STB_GNU_UNIQUE}, {NULL, 0}
+};
+
+static const query_name_t query_vis[] = {
+  {"DEFAULT", STV_DEFAULT}, {"INTERNAL", STV_INTERNAL}, {"HIDDEN", STV_HIDDEN},
+  {"PROTECTED", STV_PROTECTED}, {NULL, 0}
+};
+
+/**
+ * @brief Turns "FUNC|OBJECT" into a bit mask.
+ * 
+ * @return bool false on unknown names.
+ */
+
+static bool query_mask(const query_name_t *names, char *value, uint32_t *mask) {
+  char *save = NULL;
+
+  *mask = 0;
+  for (char *tok = strtok_r(value, "|", &save); tok; tok = strtok_r(NULL, "|", &save)) {
+    const query_name_t *n = names;
+
+    while (n->name && strcasecmp(n->name, tok))
+      n++;
+    if (!n->name)
+      return false;
+    *mask |= 1u << n->value;
+  }
+  return *mask != 0;
+}
+
+/**
+ * @brief Parses "<op><number>" into an inclusive range.
+ * 
+ */
+
+static bool query_range(const char *op, uint64_t *min, uint64_t *max) {
+  char *end;
+  size_t skip = (op[1] == '=' && op[0] != '=') ? 2 : 1;
+  uint64_t n = strtoull(op + skip, &end, 0);
+
+  if (end == op + skip || *end)
+    return false;
+
+  if (op[0] == '=')
+    *min = *max = n;
+  else if (op[0] == '>')
+    *min = (skip == 2) ? n : n + 1;
+  else if (op[0] == '<' && (skip == 2 || n))
+    *max = (skip == 2) ? n : n - 1;
+  else
+    return false;
+  return true;
+}
+
+/**
+ * @brief Splits a glob into the literal pieces between its '*'s, in place.
+ * 
+ */
+
+static bool query_glob(query_t *query, char *pattern) {
+  size_t len = strlen(pattern);
+  char *save = NULL;
+
+  query->glob = pattern;
+  query->glob_slow = strpbrk(pattern, "?[\\") != NULL;
+  if (query->glob_slow)
+    return true;
+
+  query->anchored_start = (!len || pattern[0] != '*');
+  query->anchored_end = (!len || pattern[len - 1] != '*');
+
+  for (char *tok = strtok_r(pattern, "*", &save); tok; tok = strtok_r(NULL, "*", &save)) {
+    if (query->segments == QUERY_SEGMENTS)
+      return false;
+    query->segment[query->segments] = tok;
+    query->segment_len[query->segments++] = strlen(tok);
+  }
+  return true;
+}
+
+/**
+ * @brief Parses a query such as "type=FUNC,bind=GLOBAL,size>=64,name=*alloc*,sort=-size,limit=100".
+ * 
+ * Terms are separated by commas. Filters: type, bind, vis (values joined
+ * with '|'), section (a name or an index), table, size and value (with =,
+ * <, <=, > or >=), name (a glob). sort takes size, value or name, with a
+ * leading '-' for descending order, and limit keeps the first N.
+ * 
+ * @param query The query to fill in.
+ * @param text The text.
+ * @param err Where a malformed term is reported.
+ * @return bool false, with a message on `err`, if the query is malformed.
+ */
+
+bool query_parse(query_t *query, const char *text, FILE *err) {
+  char *copy = strdup(text), *save = NULL;
+  bool ok = (copy != NULL);
+
+  memset(query, 0, sizeof(query_t));
+  query->text = copy;
+  query->types = query->binds = query->vis = ~0u;
+  query->shndx = -1;
+  query->size_max = query->value_max = UINT64_MAX;
+
+  for (char *term = ok ? strtok_r(copy, ",", &save) : NULL; ok && term; term = strtok_r(NULL, ",", &save)) {
+    size_t klen = strcspn(term, "=<>");
+    char *op = term + klen, *value = op + (*op == '=' ? 1 : 0);
+
+    if (!*op) {
+      ok = false;
+    } else if (!strncmp(term, "type", klen) && klen == 4 && *op == '=') {
+      ok = query_mask(query_types, value, &query->types);
+    } else if (!strncmp(term, "bind", klen) && klen == 4 && *op == '=') {
+      ok = query_mask(query_binds, value, &query->binds);
+    } else if (!strncmp(term, "vis", klen) && klen == 3 && *op == '=') {
+      ok = query_mask(query_vis, value, &query->vis);
+    } else if (!strncmp(term, "section", klen) && klen == 7 && *op == '=') {
+      char *end;
+      long n = strtol(value, &end, 0);
+
+      if (!strcasecmp(value, "UND"))
+        query->shndx = SHN_UNDEF;
+      else if (!strcasecmp(value, "ABS"))
+        query->shndx = SHN_ABS;
+      else if (*value && !*end && n >= 0)
+        query->shndx = n;
+      else
+        query->section = value;
+    } else if (!strncmp(term, "table", klen) && klen == 5 && *op == '=') {
+      query->table = value;
+    } else if (!strncmp(term, "size", klen) && klen == 4) {
+      ok = query_range(op, &query->size_min, &query->size_max);
+    } else if (!strncmp(term, "value", klen) && klen == 5) {
+      ok = query_range(op, &query->value_min, &query->value_max);
+    } else if (!strncmp(term, "name", klen) && klen == 4 && *op == '=') {
+      ok = !query->glob && query_glob(query, value);
+    } else if (!strncmp(term, "sort", klen) && klen == 4 && *op == '=') {
+      query->descending = (*value == '-');
+      value += query->descending;
+      query->key = !strcmp(value, "size") ? QUERY_SIZE : !strcmp(value, "value") ? QUERY_VALUE
+                 : !strcmp(value, "name") ? QUERY_NAME : QUERY_NONE;
+      ok = query->key != QUERY_NONE;
+    } else if (!strncmp(term, "limit", klen) && klen == 5 && *op == '=') {
+      char *end;
+
+      query->limit = strtoul(value, &end, 10);
+      ok = *value && !*end && query->limit;
+    } else {
+      ok = false;
+    }
+
+    if (!ok)
+      fprintf(err, "%s: Invalid query term.\n", term);
+  }
+
+  if (!ok)
+    query_free(query);
+  return ok;
+}
+
+/**
+ * @brief Frees what query_parse() allocated.
+ * 
+ */
+
+void query_free(query_t *query) {
+  free(query->text);
+  query->text = NULL;
+}
+
+/**
+ * @brief Finds `needle` in s[0..len), 16 positions at a time with SSE2.
+ * 
+ * A position is a candidate when both the first and the last byte of the
+ * needle match there; only candidates are compared in full. No load goes
+ * past s + len, so this is safe at the very end of a string table.
+ */
+
+static const char *query_find(const char *s, size_t len, const char *needle, size_t n) {
+  size_t i = 0;
+
+  if (n > len)
+    return NULL;
+
+#ifdef __SSE2__
+  const __m128i first = _mm_set1_epi8(needle[0]), last = _mm_set1_epi8(needle[n - 1]);
+
+  for (; i + 16 <= len - n + 1; i += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(s + i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(s + i + n - 1));
+    unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+
+    for (; mask; mask &= mask - 1) {
+      const char *at = s + i + __builtin_ctz(mask);
+
+      if (!memcmp(at, needle, n))
+        return at;
+    }
+  }
+#endif
+
+  for (; i + n <= len; ++i) {
+    if (s[i] == needle[0] && !memcmp(s + i, needle, n))
+      return s + i;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Matches a name against the query's glob.
+ * 
+ * Globs made only of literals and '*' are matched piece by piece: the
+ * first piece as a prefix, the last one as a suffix, the ones in between
+ * with query_find(), leftmost first. Anything fancier goes to fnmatch(3).
+ * 
+ * @param query The query.
+ * @param name The name.
+ * @param len Its length.
+ */
+
+bool query_match_name(const query_t *query, const char *name, size_t len) {
+  size_t first = 0, last = query->segments;
+  const char *p = name, *end = name + len;
+
+  if (!query->glob)
+    return true;
+  if (query->glob_slow)
+    return !fnmatch(query->glob, name, 0);
+
+  if (!last)
+    return (!query->anchored_start || !len);
+
+  if (last == 1 && query->anchored_start && query->anchored_end)
+    return (len == query->segment_len[0] && !memcmp(name, query->segment[0], len));
+
+  if (query->anchored_start) {
+    if (len < query->segment_len[0] || memcmp(name, query->segment[0], query->segment_len[0]))
+      return false;
+    p += query->segment_len[first++];
+  }
+
+  if (query->anchored_end) {
+    size_t n = query->segment_len[--last];
+
+    if ((size_t)(end - p) < n || memcmp(end - n, query->segment[last], n))
+      return false;
+    end -= n;
+  }
+
+  for (size_t i = first; i < last; ++i) {
+    const char *at = query_find(p, end - p, query->segment[i], query->segment_len[i]);
+
+    if (!at)
+      return false;
+    p = at + query->segment_len[i];
+  }
+  return true;
+}
+
+/**
+ * @brief Whether hit `a` is listed before hit `b`.
+ * 
+ * Equal keys keep the table order, so results are deterministic.
+ */
+
+static int query_cmp(const void *x, const void *y, void *ctx) {
+  const query_hit_t *a = x, *b = y;
+  const query_t *query = ctx;
+  int c = 0;
+
+  if (query->key == QUERY_NAME)
+    c = strcmp(a->name, b->name);
+  else if (query->key != QUERY_NONE)
+    c = (a->key > b->key) - (a->key < b->key);
+
+  if (query->descending)
+    c = -c;
+  if (!c)
+    c = (a->table != b->table) ? (a->table > b->table) - (a->table < b->table)
+                               : (a->index > b->index) - (a->index < b->index);
+  return c;
+}
+
+/**
+ * @brief Restores the heap below `i`; the root is the hit that would be listed last.
+ * 
+ */
+
+static void query_sift(query_hit_t *heap, size_t count, size_t i, const query_t *query) {
+  for (;;) {
+    size_t l = 2 * i + 1, r = l + 1, worst = i;
+
+    if (l < count && query_cmp(&heap[l], &heap[worst], (void *)query) > 0)
+      worst = l;
+    if (r < count && query_cmp(&heap[r], &heap[worst], (void *)query) > 0)
+      worst = r;
+    if (worst == i)
+      return;
+
+    query_hit_t tmp = heap[i];
+
+    heap[i] = heap[worst];
+    heap[worst] = tmp;
+    i = worst;
+  }
+}
+
+/**
+ * @brief Keeps the `limit` best hits in a bounded heap, or every hit when there is no limit.
+ * 
+ * @return bool false if we ran out of memory.
+ */
+
+static bool query_keep(const query_t *query, query_hit_t **hits, size_t *count, size_t *cap,
+                       const query_hit_t *hit) {
+  if (query->limit && *count == query->limit) {
+    /* full: replace the current last one if this one beats it */
+    if (query_cmp(hit, &(*hits)[0], (void *)query) < 0) {
+      (*hits)[0] = *hit;
+      query_sift(*hits, *count, 0, query);
+    }
+    return true;
+  }
+
+  if (*count == *cap) {
+    size_t n = *cap ? *cap * 2 : 1024;
+    query_hit_t *tmp = realloc(*hits, n * sizeof(query_hit_t));
+
+    if (!tmp)
+      return false;
+    *hits = tmp;
+    *cap = n;
+  }
+
+  (*hits)[(*count)++] = *hit;
+
+  if (query->limit) {
+    /* sift up */
+    for (size_t i = *count - 1; i && query_cmp(&(*hits)[i], &(*hits)[(i - 1) / 2], (void *)query) > 0;
+         i = (i - 1) / 2) {
+      query_hit_t tmp = (*hits)[i];
+
+      (*hits)[i] = (*hits)[(i - 1) / 2];
+      (*hits)[(i - 1) / 2] = tmp;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Outputs one hit as a symbol table row, prefixed with its table.
+ * 
+ */
+
+static void query_row(out_t *out, const char *table, const query_hit_t *hit) {
+  out_pad(out, table, 10, OUT_LEFT);
+  out_char(out, ' ');
+  dump_symbol_row(out, hit->index, hit->sym, hit->name);
+}
+
+/**
+ * @brief Runs the query in file->arg over every symbol table.
+ * 
+ * Predicates are tested on the raw Elf64_Sym first, cheapest first, and
+ * the name last; only hits are ever formatted. Without a sort key hits
+ * are written as they are found (and the scan stops at the limit), with
+ * one and a limit they go through a heap of `limit` entries, so memory
+ * doesn't grow with the table.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void query_symbols(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  const char *tables[QUERY_TABLES];
+  query_hit_t *hits = NULL;
+  size_t count = 0, cap = 0, matched = 0, scanned = 0, ntables = 0;
+  bool stopped = false;
+  query_t query;
+
+  if (!query_parse(&query, file->arg, file->err))
+    return;
+
+  for (int i = 0; query.section && i < elf->elf_header->e_shnum; ++i) {
+    if (!strcmp(elf_section_name(elf, &elf->elf_section_header[i]), query.section))
+      query.shndx = i;
+  }
+  if (query.section && query.shndx < 0) {
+    fprintf(file->err, "%s: No such section.\n", query.section);
+    query_free(&query);
+    return;
+  }
+
+  out_str(out, "Table      Num:  Value  Size  Type         Bind           Vis          Ndx        Name\n");
+
+  for (int i = 0; i < elf->elf_header->e_shnum && !stopped && ntables < QUERY_TABLES; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+    const char *table = elf_section_name(elf, shdr);
+
+    if ((shdr->sh_type != SHT_SYMTAB && shdr->sh_type != SHT_DYNSYM) || !shdr->sh_entsize
+        || (query.table && strcmp(query.table, table)))
+      continue;
+
+    const Elf64_Sym *syms = (const Elf64_Sym *)elf_section_table(elf, i);
+    const char *strtab = elf_section_data(elf, shdr->sh_link);
+    uint64_t strsize = elf->elf_section_header[shdr->sh_link].sh_size;
+    size_t sym_num = shdr->sh_size / shdr->sh_entsize;
+
+    if (!syms || !strtab)
+      continue;
+
+    tables[ntables] = table;
+    scanned += sym_num;
+
+    for (size_t j = 0; j < sym_num; ++j) {
+      const Elf64_Sym *sym = &syms[j];
+
+      if (!((query.types >> ELF64_ST_TYPE(sym->st_info)) & 1)
+          || !((query.binds >> ELF64_ST_BIND(sym->st_info)) & 1)
+          || !((query.vis >> ELF64_ST_VISIBILITY(sym->st_other)) & 1)
+          || (query.shndx >= 0 && sym->st_shndx != query.shndx)
+          || sym->st_size < query.size_min || sym->st_size > query.size_max
+          || sym->st_value < query.value_min || sym->st_value > query.value_max)
+        continue;
+
+      const char *name = elf_string(strtab, strsize, sym->st_name);
+
+      if (query.glob && !query_match_name(&query, name, strlen(name)))
+        continue;
+
+      query_hit_t hit = {
+        .key = (query.key == QUERY_SIZE) ? sym->st_size : sym->st_value,
+        .sym = sym,
+        .name = name,
+        .table = ntables,
+        .index = j
+      };
+
+      matched++;
+
+      if (query.key == QUERY_NONE) {
+        query_row(out, table, &hit);
+        if (matched == query.limit) {
+          stopped = true;
+          break;
+        }
+      } else if (!query_keep(&query, &hits, &count, &cap, &hit)) {
+        fprintf(file->err, "Failed to allocate memory for the query!\n");
+        stopped = true;
+        break;
+      }
+    }
+    ntables++;
+  }
+
+  qsort_r(hits, count, sizeof(query_hit_t), query_cmp, &query);
+  for (size_t i = 0; i < count; ++i)
+    query_row(out, tables[hits[i].table], &hits[i]);
+
+  out_char(out, '\n');
+  if (stopped && query.key == QUERY_NONE) {
+    out_str(out, "Stopped at the first ");
+    out_udec(out, matched, 0, 0);
+    out_str(out, " matches.\n");
+  } else {
+    out_udec(out, matched, 0, 0);
+    out_str(out, " of ");
+    out_udec(out, scanned, 0, 0);
+    out_str(out, " symbols matched");
+    if (count < matched && query.key != QUERY_NONE) {
+      out_str(out, ", showing ");
+      out_udec(out, count, 0, 0);
+    }
+    out_str(out, ".\n");
+  }
+
+  free(hits);
+  query_free(&query);
+}
@@ -0,0 +1,49 @@
+#ifndef _QUERY_H
+#define _QUERY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fnmatch.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define QUERY_SEGMENTS 8
+#define QUERY_TABLES 8
+
+typedef enum query_key {
+  QUERY_NONE,   /* table order */
+  QUERY_SIZE,
+  QUERY_VALUE,
+  QUERY_NAME
+} query_key_t;
+
+typedef struct query {
+  char *text;             /* a copy of the query, everything below points into it */
+  uint32_t types;         /* bit per STT_*, all set when not filtered */
+  uint32_t binds;         /* bit per STB_* */
+  uint32_t vis;           /* bit per STV_* */
+  long shndx;             /* -1: any section */
+  const char *section;    /* section name, resolved per file */
+  const char *table;      /* only this symbol table */
+  uint64_t size_min, size_max;
+  uint64_t value_min, value_max;
+  const char *glob;       /* the name pattern */
+  bool glob_slow;         /* has ?, [ or \, goes through fnmatch(3) */
+  bool anchored_start;
+  bool anchored_end;
+  size_t segments;
+  const char *segment[QUERY_SEGMENTS];
+  size_t segment_len[QUERY_SEGMENTS];
+  query_key_t key;
+  bool descending;
+  size_t limit;           /* 0: no limit */
+} query_t;
+
+bool query_parse(query_t *query, const char *text, FILE *err);
+bool query_match_name(const query_t *query, const char *name, size_t len);
+void query_free(query_t *query);
+void query_symbols(batch_file_t *file);
+
+#endif
@@ -0,0 +1,813 @@
+/**
+ * @file reloc.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Relocation tables (SHT_REL, SHT_RELA, SHT_RELR): dumped, and summed up by type, target section and the pages they dirty.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+/**
+ * @brief Get the name of an x86-64 relocation type.
+ * 
+ */
+
+static const char *get_reloc_type_x86_64(uint32_t type) {
+  switch (type) {
+    case R_X86_64_NONE:            return ("R_X86_64_NONE"); break;
+    case R_X86_64_64:              return ("R_X86_64_64"); break;
+    case R_X86_64_PC32:            return ("R_X86_64_PC32"); break;
+    case R_X86_64_GOT32:           return ("R_X86_64_GOT32"); break;
+    case R_X86_64_PLT32:           return ("R_X86_64_PLT32"); break;
+    case R_X86_64_COPY:            return ("R_X86_64_COPY"); break;
+    case R_X86_64_GLOB_DAT:        return ("R_X86_64_GLOB_DAT"); break;
+    case R_X86_64_JUMP_SLOT:       return ("R_X86_64_JUMP_SLOT"); break;
+    case R_X86_64_RELATIVE:        return ("R_X86_64_RELATIVE"); break;
+    case R_X86_64_GOTPCREL:        return ("R_X86_64_GOTPCREL"); break;
+    case R_X86_64_32:              return ("R_X86_64_32"); break;
+    case R_X86_64_32S:             return ("R_X86_64_32S"); break;
+    case R_X86_64_16:              return ("R_X86_64_16"); break;
+    case R_X86_64_PC16:            return ("R_X86_64_PC16"); break;
+    case R_X86_64_8:               return ("R_X86_64_8"); break;
+    case R_X86_64_PC8:             return ("R_X86_64_PC8"); break;
+    case R_X86_64_DTPMOD64:        return ("R_X86_64_DTPMOD64"); break;
+    case R_X86_64_DTPOFF64:        return ("R_X86_64_DTPOFF64"); break;
+    case R_X86_64_TPOFF64:         return ("R_X86_64_TPOFF64"); break;
+    case R_X86_64_TLSGD:           return ("R_X86_64_TLSGD"); break;
+    case R_X86_64_TLSLD:           return ("R_X86_64_TLSLD"); break;
+    case R_X86_64_DTPOFF32:        return ("R_X86_64_DTPOFF32"); break;
+    case R_X86_64_GOTTPOFF:        return ("R_X86_64_GOTTPOFF"); break;
+    case R_X86_64_TPOFF32:         return ("R_X86_64_TPOFF32"); break;
+    case R_X86_64_PC64:            return ("R_X86_64_PC64"); break;
+    case R_X86_64_GOTOFF64:        return ("R_X86_64_GOTOFF64"); break;
+    case R_X86_64_GOTPC32:         return ("R_X86_64_GOTPC32"); break;
+    case R_X86_64_GOT64:           return ("R_X86_64_GOT64"); break;
+    case R_X86_64_GOTPCREL64:      return ("R_X86_64_GOTPCREL64"); break;
+    case R_X86_64_GOTPC64:         return ("R_X86_64_GOTPC64"); break;
+    case R_X86_64_GOTPLT64:        return ("R_X86_64_GOTPLT64"); break;
+    case R_X86_64_PLTOFF64:        return ("R_X86_64_PLTOFF64"); break;
+    case R_X86_64_SIZE32:          return ("R_X86_64_SIZE32"); break;
+    case R_X86_64_SIZE64:          return ("R_X86_64_SIZE64"); break;
+    case R_X86_64_GOTPC32_TLSDESC: return ("R_X86_64_GOTPC32_TLSDESC"); break;
+    case R_X86_64_TLSDESC_CALL:    return ("R_X86_64_TLSDESC_CALL"); break;
+    case R_X86_64_TLSDESC:         return ("R_X86_64_TLSDESC"); break;
+    case R_X86_64_IRELATIVE:       return ("R_X86_64_IRELATIVE"); break;
+    case R_X86_64_RELATIVE64:      return ("R_X86_64_RELATIVE64"); break;
+    case R_X86_64_GOTPCRELX:       return ("R_X86_64_GOTPCRELX"); break;
+    case R_X86_64_REX_GOTPCRELX:   return ("R_X86_64_REX_GOTPCRELX"); break;
+    default:                  return (NULL); break;
+  }
+}
+
+/**
+ * @brief Get the name of an i386 relocation type.
+ * 
+ */
+
+static const char *get_reloc_type_i386(uint32_t type) {
+  switch (type) {
+    case R_386_NONE:          return ("R_386_NONE"); break;
+    case R_386_32:            return ("R_386_32"); break;
+    case R_386_PC32:          return ("R_386_PC32"); break;
+    case R_386_GOT32:         return ("R_386_GOT32"); break;
+    case R_386_PLT32:         return ("R_386_PLT32"); break;
+    case R_386_COPY:          return ("R_386_COPY"); break;
+    case R_386_GLOB_DAT:      return ("R_386_GLOB_DAT"); break;
+    case R_386_JMP_SLOT:      return ("R_386_JMP_SLOT"); break;
+    case R_386_RELATIVE:      return ("R_386_RELATIVE"); break;
+    case R_386_GOTOFF:        return ("R_386_GOTOFF"); break;
+    case R_386_GOTPC:         return ("R_386_GOTPC"); break;
+    case R_386_32PLT:         return ("R_386_32PLT"); break;
+    case R_386_TLS_TPOFF:     return ("R_386_TLS_TPOFF"); break;
+    case R_386_TLS_IE:        return ("R_386_TLS_IE"); break;
+    case R_386_TLS_GOTIE:     return ("R_386_TLS_GOTIE"); break;
+    case R_386_TLS_LE:        return ("R_386_TLS_LE"); break;
+    case R_386_TLS_GD:        return ("R_386_TLS_GD"); break;
+    case R_386_TLS_LDM:       return ("R_386_TLS_LDM"); break;
+    case R_386_16:            return ("R_386_16"); break;
+    case R_386_PC16:          return ("R_386_PC16"); break;
+    case R_386_8:             return ("R_386_8"); break;
+    case R_386_PC8:           return ("R_386_PC8"); break;
+    case R_386_TLS_GD_32:     return ("R_386_TLS_GD_32"); break;
+    case R_386_TLS_GD_PUSH:   return ("R_386_TLS_GD_PUSH"); break;
+    case R_386_TLS_GD_CALL:   return ("R_386_TLS_GD_CALL"); break;
+    case R_386_TLS_GD_POP:    return ("R_386_TLS_GD_POP"); break;
+    case R_386_TLS_LDM_32:    return ("R_386_TLS_LDM_32"); break;
+    case R_386_TLS_LDM_PUSH:  return ("R_386_TLS_LDM_PUSH"); break;
+    case R_386_TLS_LDM_CALL:  return ("R_386_TLS_LDM_CALL"); break;
+    case R_386_TLS_LDM_POP:   return ("R_386_TLS_LDM_POP"); break;
+    case R_386_TLS_LDO_32:    return ("R_386_TLS_LDO_32"); break;
+    case R_386_TLS_IE_32:     return ("R_386_TLS_IE_32"); break;
+    case R_386_TLS_LE_32:     return ("R_386_TLS_LE_32"); break;
+    case R_386_TLS_DTPMOD32:  return ("R_386_TLS_DTPMOD32"); break;
+    case R_386_TLS_DTPOFF32:  return ("R_386_TLS_DTPOFF32"); break;
+    case R_386_TLS_TPOFF32:   return ("R_386_TLS_TPOFF32"); break;
+    case R_386_SIZE32:        return ("R_386_SIZE32"); break;
+    case R_386_TLS_GOTDESC:   return ("R_386_TLS_GOTDESC"); break;
+    case R_386_TLS_DESC_CALL: return ("R_386_TLS_DESC_CALL"); break;
+    case R_386_TLS_DESC:      return ("R_386_TLS_DESC"); break;
+    case R_386_IRELATIVE:     return ("R_386_IRELATIVE"); break;
+    case R_386_GOT32X:        return ("R_386_GOT32X"); break;
+    default:             return (NULL); break;
+  }
+}
+
+/**
+ * @brief Get the name of an AArch64 relocation type.
+ * 
+ */
+
+static const char *get_reloc_type_aarch64(uint32_t type) {
+  switch (type) {
+    case R_AARCH64_NONE:                         return ("R_AARCH64_NONE"); break;
+    case R_AARCH64_ABS64:                        return ("R_AARCH64_ABS64"); break;
+    case R_AARCH64_ABS32:                        return ("R_AARCH64_ABS32"); break;
+    case R_AARCH64_ABS16:                        return ("R_AARCH64_ABS16"); break;
+    case R_AARCH64_PREL64:                       return ("R_AARCH64_PREL64"); break;
+    case R_AARCH64_PREL32:                       return ("R_AARCH64_PREL32"); break;
+    case R_AARCH64_PREL16:                       return ("R_AARCH64_PREL16"); break;
+    case R_AARCH64_MOVW_UABS_G0:                 return ("R_AARCH64_MOVW_UABS_G0"); break;
+    case R_AARCH64_MOVW_UABS_G0_NC:              return ("R_AARCH64_MOVW_UABS_G0_NC"); break;
+    case R_AARCH64_MOVW_UABS_G1:                 return ("R_AARCH64_MOVW_UABS_G1"); break;
+    case R_AARCH64_MOVW_UABS_G1_NC:              return ("R_AARCH64_MOVW_UABS_G1_NC"); break;
+    case R_AARCH64_MOVW_UABS_G2:                 return ("R_AARCH64_MOVW_UABS_G2"); break;
+    case R_AARCH64_MOVW_UABS_G2_NC:              return ("R_AARCH64_MOVW_UABS_G2_NC"); break;
+    case R_AARCH64_MOVW_UABS_G3:                 return ("R_AARCH64_MOVW_UABS_G3"); break;
+    case R_AARCH64_MOVW_SABS_G0:                 return ("R_AARCH64_MOVW_SABS_G0"); break;
+    case R_AARCH64_MOVW_SABS_G1:                 return ("R_AARCH64_MOVW_SABS_G1"); break;
+    case R_AARCH64_MOVW_SABS_G2:                 return ("R_AARCH64_MOVW_SABS_G2"); break;
+    case R_AARCH64_LD_PREL_LO19:                 return ("R_AARCH64_LD_PREL_LO19"); break;
+    case R_AARCH64_ADR_PREL_LO21:                return ("R_AARCH64_ADR_PREL_LO21"); break;
+    case R_AARCH64_ADR_PREL_PG_HI21:             return ("R_AARCH64_ADR_PREL_PG_HI21"); break;
+    case R_AARCH64_ADR_PREL_PG_HI21_NC:          return ("R_AARCH64_ADR_PREL_PG_HI21_NC"); break;
+    case R_AARCH64_ADD_ABS_LO12_NC:              return ("R_AARCH64_ADD_ABS_LO12_NC"); break;
+    case R_AARCH64_LDST8_ABS_LO12_NC:            return ("R_AARCH64_LDST8_ABS_LO12_NC"); break;
+    case R_AARCH64_TSTBR14:                      return ("R_AARCH64_TSTBR14"); break;
+    case R_AARCH64_CONDBR19:                     return ("R_AARCH64_CONDBR19"); break;
+    case R_AARCH64_JUMP26:                       return ("R_AARCH64_JUMP26"); break;
+    case R_AARCH64_CALL26:                       return ("R_AARCH64_CALL26"); break;
+    case R_AARCH64_LDST16_ABS_LO12_NC:           return ("R_AARCH64_LDST16_ABS_LO12_NC"); break;
+    case R_AARCH64_LDST32_ABS_LO12_NC:           return ("R_AARCH64_LDST32_ABS_LO12_NC"); break;
+    case R_AARCH64_LDST64_ABS_LO12_NC:           return ("R_AARCH64_LDST64_ABS_LO12_NC"); break;
+    case R_AARCH64_MOVW_PREL_G0:                 return ("R_AARCH64_MOVW_PREL_G0"); break;
+    case R_AARCH64_MOVW_PREL_G0_NC:              return ("R_AARCH64_MOVW_PREL_G0_NC"); break;
+    case R_AARCH64_MOVW_PREL_G1:                 return ("R_AARCH64_MOVW_PREL_G1"); break;
+    case R_AARCH64_MOVW_PREL_G1_NC:              return ("R_AARCH64_MOVW_PREL_G1_NC"); break;
+    case R_AARCH64_MOVW_PREL_G2:                 return ("R_AARCH64_MOVW_PREL_G2"); break;
+    case R_AARCH64_MOVW_PREL_G2_NC:              return ("R_AARCH64_MOVW_PREL_G2_NC"); break;
+    case R_AARCH64_MOVW_PREL_G3:                 return ("R_AARCH64_MOVW_PREL_G3"); break;
+    case R_AARCH64_LDST128_ABS_LO12_NC:          return ("R_AARCH64_LDST128_ABS_LO12_NC"); break;
+    case R_AARCH64_MOVW_GOTOFF_G0:               return ("R_AARCH64_MOVW_GOTOFF_G0"); break;
+    case R_AARCH64_MOVW_GOTOFF_G0_NC:            return ("R_AARCH64_MOVW_GOTOFF_G0_NC"); break;
+    case R_AARCH64_MOVW_GOTOFF_G1:               return ("R_AARCH64_MOVW_GOTOFF_G1"); break;
+    case R_AARCH64_MOVW_GOTOFF_G1_NC:            return ("R_AARCH64_MOVW_GOTOFF_G1_NC"); break;
+    case R_AARCH64_MOVW_GOTOFF_G2:               return ("R_AARCH64_MOVW_GOTOFF_G2"); break;
+    case R_AARCH64_MOVW_GOTOFF_G2_NC:            return ("R_AARCH64_MOVW_GOTOFF_G2_NC"); break;
+    case R_AARCH64_MOVW_GOTOFF_G3:               return ("R_AARCH64_MOVW_GOTOFF_G3"); break;
+    case R_AARCH64_GOTREL64:                     return ("R_AARCH64_GOTREL64"); break;
+    case R_AARCH64_GOTREL32:                     return ("R_AARCH64_GOTREL32"); break;
+    case R_AARCH64_GOT_LD_PREL19:                return ("R_AARCH64_GOT_LD_PREL19"); break;
+    case R_AARCH64_LD64_GOTOFF_LO15:             return ("R_AARCH64_LD64_GOTOFF_LO15"); break;
+    case R_AARCH64_ADR_GOT_PAGE:                 return ("R_AARCH64_ADR_GOT_PAGE"); break;
+    case R_AARCH64_LD64_GOT_LO12_NC:             return ("R_AARCH64_LD64_GOT_LO12_NC"); break;
+    case R_AARCH64_LD64_GOTPAGE_LO15:            return ("R_AARCH64_LD64_GOTPAGE_LO15"); break;
+    case R_AARCH64_TLSGD_ADR_PREL21:             return ("R_AARCH64_TLSGD_ADR_PREL21"); break;
+    case R_AARCH64_TLSGD_ADR_PAGE21:             return ("R_AARCH64_TLSGD_ADR_PAGE21"); break;
+    case R_AARCH64_TLSGD_ADD_LO12_NC:            return ("R_AARCH64_TLSGD_ADD_LO12_NC"); break;
+    case R_AARCH64_TLSGD_MOVW_G1:                return ("R_AARCH64_TLSGD_MOVW_G1"); break;
+    case R_AARCH64_TLSGD_MOVW_G0_NC:             return ("R_AARCH64_TLSGD_MOVW_G0_NC"); break;
+    case R_AARCH64_TLSLD_ADR_PREL21:             return ("R_AARCH64_TLSLD_ADR_PREL21"); break;
+    case R_AARCH64_TLSLD_ADR_PAGE21:             return ("R_AARCH64_TLSLD_ADR_PAGE21"); break;
+    case R_AARCH64_TLSLD_ADD_LO12_NC:            return ("R_AARCH64_TLSLD_ADD_LO12_NC"); break;
+    case R_AARCH64_TLSLD_MOVW_G1:                return ("R_AARCH64_TLSLD_MOVW_G1"); break;
+    case R_AARCH64_TLSLD_MOVW_G0_NC:             return ("R_AARCH64_TLSLD_MOVW_G0_NC"); break;
+    case R_AARCH64_TLSLD_LD_PREL19:              return ("R_AARCH64_TLSLD_LD_PREL19"); break;
+    case R_AARCH64_TLSLD_MOVW_DTPREL_G2:         return ("R_AARCH64_TLSLD_MOVW_DTPREL_G2"); break;
+    case R_AARCH64_TLSLD_MOVW_DTPREL_G1:         return ("R_AARCH64_TLSLD_MOVW_DTPREL_G1"); break;
+    case R_AARCH64_TLSLD_MOVW_DTPREL_G1_NC:      return ("R_AARCH64_TLSLD_MOVW_DTPREL_G1_NC"); break;
+    case R_AARCH64_TLSLD_MOVW_DTPREL_G0:         return ("R_AARCH64_TLSLD_MOVW_DTPREL_G0"); break;
+    case R_AARCH64_TLSLD_MOVW_DTPREL_G0_NC:      return ("R_AARCH64_TLSLD_MOVW_DTPREL_G0_NC"); break;
+    case R_AARCH64_TLSLD_ADD_DTPREL_HI12:        return ("R_AARCH64_TLSLD_ADD_DTPREL_HI12"); break;
+    case R_AARCH64_TLSLD_ADD_DTPREL_LO12:        return ("R_AARCH64_TLSLD_ADD_DTPREL_LO12"); break;
+    case R_AARCH64_TLSLD_ADD_DTPREL_LO12_NC:     return ("R_AARCH64_TLSLD_ADD_DTPREL_LO12_NC"); break;
+    case R_AARCH64_TLSLD_LDST8_DTPREL_LO12:      return ("R_AARCH64_TLSLD_LDST8_DTPREL_LO12"); break;
+    case R_AARCH64_TLSLD_LDST8_DTPREL_LO12_NC:   return ("R_AARCH64_TLSLD_LDST8_DTPREL_LO12_NC"); break;
+    case R_AARCH64_TLSLD_LDST16_DTPREL_LO12:     return ("R_AARCH64_TLSLD_LDST16_DTPREL_LO12"); break;
+    case R_AARCH64_TLSLD_LDST16_DTPREL_LO12_NC:  return ("R_AARCH64_TLSLD_LDST16_DTPREL_LO12_NC"); break;
+    case R_AARCH64_TLSLD_LDST32_DTPREL_LO12:     return ("R_AARCH64_TLSLD_LDST32_DTPREL_LO12"); break;
+    case R_AARCH64_TLSLD_LDST32_DTPREL_LO12_NC:  return ("R_AARCH64_TLSLD_LDST32_DTPREL_LO12_NC"); break;
+    case R_AARCH64_TLSLD_LDST64_DTPREL_LO12:     return ("R_AARCH64_TLSLD_LDST64_DTPREL_LO12"); break;
+    case R_AARCH64_TLSLD_LDST64_DTPREL_LO12_NC:  return ("R_AARCH64_TLSLD_LDST64_DTPREL_LO12_NC"); break;
+    case R_AARCH64_TLSIE_MOVW_GOTTPREL_G1:       return ("R_AARCH64_TLSIE_MOVW_GOTTPREL_G1"); break;
+    case R_AARCH64_TLSIE_MOVW_GOTTPREL_G0_NC:    return ("R_AARCH64_TLSIE_MOVW_GOTTPREL_G0_NC"); break;
+    case R_AARCH64_TLSIE_ADR_GOTTPREL_PAGE21:    return ("R_AARCH64_TLSIE_ADR_GOTTPREL_PAGE21"); break;
+    case R_AARCH64_TLSIE_LD64_GOTTPREL_LO12_NC:  return ("R_AARCH64_TLSIE_LD64_GOTTPREL_LO12_NC"); break;
+    case R_AARCH64_TLSIE_LD_GOTTPREL_PREL19:     return ("R_AARCH64_TLSIE_LD_GOTTPREL_PREL19"); break;
+    case R_AARCH64_TLSLE_MOVW_TPREL_G2:          return ("R_AARCH64_TLSLE_MOVW_TPREL_G2"); break;
+    case R_AARCH64_TLSLE_MOVW_TPREL_G1:          return ("R_AARCH64_TLSLE_MOVW_TPREL_G1"); break;
+    case R_AARCH64_TLSLE_MOVW_TPREL_G1_NC:       return ("R_AARCH64_TLSLE_MOVW_TPREL_G1_NC"); break;
+    case R_AARCH64_TLSLE_MOVW_TPREL_G0:          return ("R_AARCH64_TLSLE_MOVW_TPREL_G0"); break;
+    case R_AARCH64_TLSLE_MOVW_TPREL_G0_NC:       return ("R_AARCH64_TLSLE_MOVW_TPREL_G0_NC"); break;
+    case R_AARCH64_TLSLE_ADD_TPREL_HI12:         return ("R_AARCH64_TLSLE_ADD_TPREL_HI12"); break;
+    case R_AARCH64_TLSLE_ADD_TPREL_LO12:         return ("R_AARCH64_TLSLE_ADD_TPREL_LO12"); break;
+    case R_AARCH64_TLSLE_ADD_TPREL_LO12_NC:      return ("R_AARCH64_TLSLE_ADD_TPREL_LO12_NC"); break;
+    case R_AARCH64_TLSLE_LDST8_TPREL_LO12:       return ("R_AARCH64_TLSLE_LDST8_TPREL_LO12"); break;
+    case R_AARCH64_TLSLE_LDST8_TPREL_LO12_NC:    return ("R_AARCH64_TLSLE_LDST8_TPREL_LO12_NC"); break;
+    case R_AARCH64_TLSLE_LDST16_TPREL_LO12:      return ("R_AARCH64_TLSLE_LDST16_TPREL_LO12"); break;
+    case R_AARCH64_TLSLE_LDST16_TPREL_LO12_NC:   return ("R_AARCH64_TLSLE_LDST16_TPREL_LO12_NC"); break;
+    case R_AARCH64_TLSLE_LDST32_TPREL_LO12:      return ("R_AARCH64_TLSLE_LDST32_TPREL_LO12"); break;
+    case R_AARCH64_TLSLE_LDST32_TPREL_LO12_NC:   return ("R_AARCH64_TLSLE_LDST32_TPREL_LO12_NC"); break;
+    case R_AARCH64_TLSLE_LDST64_TPREL_LO12:      return ("R_AARCH64_TLSLE_LDST64_TPREL_LO12"); break;
+    case R_AARCH64_TLSLE_LDST64_TPREL_LO12_NC:   return ("R_AARCH64_TLSLE_LDST64_TPREL_LO12_NC"); break;
+    case R_AARCH64_TLSDESC_LD_PREL19:            return ("R_AARCH64_TLSDESC_LD_PREL19"); break;
+    case R_AARCH64_TLSDESC_ADR_PREL21:           return ("R_AARCH64_TLSDESC_ADR_PREL21"); break;
+    case R_AARCH64_TLSDESC_ADR_PAGE21:           return ("R_AARCH64_TLSDESC_ADR_PAGE21"); break;
+    case R_AARCH64_TLSDESC_LD64_LO12:            return ("R_AARCH64_TLSDESC_LD64_LO12"); break;
+    case R_AARCH64_TLSDESC_ADD_LO12:             return ("R_AARCH64_TLSDESC_ADD_LO12"); break;
+    case R_AARCH64_TLSDESC_OFF_G1:               return ("R_AARCH64_TLSDESC_OFF_G1"); break;
+    case R_AARCH64_TLSDESC_OFF_G0_NC:            return ("R_AARCH64_TLSDESC_OFF_G0_NC"); break;
+    case R_AARCH64_TLSDESC_LDR:                  return ("R_AARCH64_TLSDESC_LDR"); break;
+    case R_AARCH64_TLSDESC_ADD:                  return ("R_AARCH64_TLSDESC_ADD"); break;
+    case R_AARCH64_TLSDESC_CALL:                 return ("R_AARCH64_TLSDESC_CALL"); break;
+    case R_AARCH64_TLSLE_LDST128_TPREL_LO12:     return ("R_AARCH64_TLSLE_LDST128_TPREL_LO12"); break;
+    case R_AARCH64_TLSLE_LDST128_TPREL_LO12_NC:  return ("R_AARCH64_TLSLE_LDST128_TPREL_LO12_NC"); break;
+    case R_AARCH64_TLSLD_LDST128_DTPREL_LO12:    return ("R_AARCH64_TLSLD_LDST128_DTPREL_LO12"); break;
+    case R_AARCH64_TLSLD_LDST128_DTPREL_LO12_NC: return ("R_AARCH64_TLSLD_LDST128_DTPREL_LO12_NC"); break;
+    case R_AARCH64_COPY:                         return ("R_AARCH64_COPY"); break;
+    case R_AARCH64_GLOB_DAT:                     return ("R_AARCH64_GLOB_DAT"); break;
+    case R_AARCH64_JUMP_SLOT:                    return ("R_AARCH64_JUMP_SLOT"); break;
+    case R_AARCH64_RELATIVE:                     return ("R_AARCH64_RELATIVE"); break;
+    case R_AARCH64_TLS_DTPMOD:                   return ("R_AARCH64_TLS_DTPMOD"); break;
+    case R_AARCH64_TLS_DTPREL:                   return ("R_AARCH64_TLS_DTPREL"); break;
+    case R_AARCH64_TLS_TPREL:                    return ("R_AARCH64_TLS_TPREL"); break;
+    case R_AARCH64_TLSDESC:                      return ("R_AARCH64_TLSDESC"); break;
+    case R_AARCH64_IRELATIVE:                    return ("R_AARCH64_IRELATIVE"); break;
+    default:                                return (NULL); break;
+  }
+}
+
+/**
+ * @brief Get the name of a relocation type, NULL for the machines and types we have no name for.
+ * 
+ */
+
+static const char *get_reloc_type(uint16_t machine, uint32_t type) {
+  switch (machine) {
+    case EM_X86_64:  return get_reloc_type_x86_64(type); break;
+    case EM_386:     return get_reloc_type_i386(type); break;
+    case EM_AARCH64: return get_reloc_type_aarch64(type); break;
+    default:         return (NULL); break;
+  }
+}
+
+/**
+ * @brief The type every RELR entry stands for, R_<machine>_RELATIVE.
+ * 
+ */
+
+static uint32_t get_relative_type(uint16_t machine) {
+  switch (machine) {
+    case EM_X86_64:  return R_X86_64_RELATIVE; break;
+    case EM_386:     return R_386_RELATIVE; break;
+    case EM_AARCH64: return R_AARCH64_RELATIVE; break;
+    case EM_ARM:     return R_ARM_RELATIVE; break;
+    case EM_PPC:     return R_PPC_RELATIVE; break;
+    case EM_PPC64:   return R_PPC64_RELATIVE; break;
+    case EM_S390:    return R_390_RELATIVE; break;
+    case EM_RISCV:   return R_RISCV_RELATIVE; break;
+    default:         return 0; break;
+  }
+}
+
+/**
+ * @brief Writes a relocation type, by name or by number.
+ * 
+ */
+
+static void reloc_type_name(out_t *out, uint16_t machine, uint32_t type, unsigned int width) {
+  const char *name = get_reloc_type(machine, type);
+
+  if (name) {
+    out_pad(out, name, width, OUT_LEFT);
+    return;
+  }
+  out_str(out, "type ");
+  out_udec(out, type, width > 5 ? width - 5 : 0, OUT_LEFT);
+}
+
+/**
+ * @brief Tells the relocation sections, and how big their entries are in the file.
+ * 
+ * @return size_t The entry size, 0 if the section is not a relocation table.
+ */
+
+static size_t reloc_entry_size(const elf_t *elf, const Elf64_Shdr *shdr) {
+  bool elf32 = elf->elf_header->e_ident[EI_CLASS] == ELFCLASS32;
+
+  switch (shdr->sh_type) {
+    case SHT_RELA: return elf32 ? sizeof(Elf32_Rela) : sizeof(Elf64_Rela); break;
+    case SHT_REL:  return elf32 ? sizeof(Elf32_Rel) : sizeof(Elf64_Rel); break;
+    case SHT_RELR: return elf32 ? sizeof(Elf32_Addr) : sizeof(Elf64_Addr); break;
+    default:       return 0; break;
+  }
+}
+
+/**
+ * @brief Orders the section ranges by address.
+ * 
+ */
+
+static int reloc_range_cmp(const void *a, const void *b) {
+  const reloc_range_t *x = a, *y = b;
+
+  return (x->start > y->start) - (x->start < y->start);
+}
+
+/**
+ * @brief Sets up the counters: the allocated sections by address, and a bit per page of the image.
+ * 
+ */
+
+static void reloc_stats_init(elf_t *elf, reloc_stats_t *st) {
+  uint16_t shnum = elf->elf_header->e_shnum;
+  uint64_t lo = UINT64_MAX, hi = 0;
+
+  memset(st, 0, sizeof(reloc_stats_t));
+  st->relocatable = elf->elf_header->e_type == ET_REL;
+  st->by_section = calloc(shnum + 1, sizeof(uint64_t));
+  st->ranges = calloc(shnum ? shnum : 1, sizeof(reloc_range_t));
+  if (!st->by_section || !st->ranges)
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the relocations!");
+
+  for (uint16_t i = 1; i < shnum && !st->relocatable; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    /* .tbss takes no room in the image, it would shadow what follows it */
+    if (!(shdr->sh_flags & SHF_ALLOC) || !shdr->sh_size
+        || (shdr->sh_type == SHT_NOBITS && (shdr->sh_flags & SHF_TLS)))
+      continue;
+    st->ranges[st->nranges++] = (reloc_range_t){shdr->sh_addr, shdr->sh_addr + shdr->sh_size, i};
+  }
+  qsort(st->ranges, st->nranges, sizeof(reloc_range_t), reloc_range_cmp);
+
+  for (int i = 0; i < elf->elf_header->e_phnum && !st->relocatable; ++i) {
+    const Elf64_Phdr *phdr = &elf->elf_program_header[i];
+
+    if (phdr->p_type != PT_LOAD || !phdr->p_memsz)
+      continue;
+    lo = phdr->p_vaddr < lo ? phdr->p_vaddr : lo;
+    hi = phdr->p_vaddr + phdr->p_memsz > hi ? phdr->p_vaddr + phdr->p_memsz : hi;
+  }
+
+  /* broken files can claim any range, don't allocate more than the file could describe */
+  if (lo < hi && (hi - lo) / RELOC_PAGE_SIZE <= elf->size * 8 + 1) {
+    st->page_lo = lo / RELOC_PAGE_SIZE;
+    st->npages = (hi - 1) / RELOC_PAGE_SIZE - st->page_lo + 1;
+    if (!(st->pages = calloc(st->npages / 8 + 1, 1)))
+      error_handling(-1, NULL, NULL, "Failed to allocate memory for the relocations!");
+  }
+}
+
+/**
+ * @brief Frees what reloc_stats_init() allocated.
+ * 
+ */
+
+static void reloc_stats_free(reloc_stats_t *st) {
+  free(st->by_section);
+  free(st->ranges);
+  free(st->pages);
+}
+
+/**
+ * @brief Finds the section an address is in, e_shnum if none.
+ * 
+ * Relocations come sorted by address more often than not, the last
+ * section found is tried first.
+ */
+
+static inline __attribute__((always_inline)) size_t reloc_section(reloc_stats_t *st, uint64_t addr, size_t none) {
+  const reloc_range_t *last = &st->ranges[st->last];
+
+  if (st->nranges && addr >= last->start && addr < last->end)
+    return last->shndx;
+
+  size_t lo = 0, hi = st->nranges;
+
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+
+    if (st->ranges[mid].start <= addr)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (!lo || addr >= st->ranges[lo - 1].end)
+    return none;
+  st->last = lo - 1;
+  return st->ranges[lo - 1].shndx;
+}
+
+/**
+ * @brief Counts a block of relocated addresses: target sections and pages.
+ * 
+ * @param base The first address.
+ * @param stride Bytes from one address to the next, r_offset leads Elf64_Rel/Rela.
+ */
+
+static void reloc_count_offsets(reloc_stats_t *st, const char *base, size_t stride, size_t count, size_t none) {
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t addr = *(const uint64_t *)(base + i * stride);
+    uint64_t page = addr / RELOC_PAGE_SIZE - st->page_lo;
+
+    st->by_section[reloc_section(st, addr, none)]++;
+    if (page < st->npages)
+      st->pages[page / 8] |= (uint8_t)(1 << (page % 8));
+  }
+}
+
+/**
+ * @brief Counts the types of a block of Elf64_Rel/Elf64_Rela.
+ * 
+ * One load and one increment per entry, straight over the array.
+ */
+
+static void reloc_count_types(reloc_stats_t *st, const char *base, size_t stride, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t type = ELF64_R_TYPE(((const Elf64_Rel *)(base + i * stride))->r_info);
+
+    st->types[type < RELOC_TYPES ? type : RELOC_TYPES]++;
+  }
+}
+
+/**
+ * @brief Expands SHT_RELR entries into addresses, a block at a time.
+ * 
+ * An even entry is an address, and the next word is the one after it;
+ * an odd one is a bitmap of the (word bits - 1) words that follow.
+ * 
+ * @param word The size of an address in the file, 4 or 8.
+ * @param block Called with each block of addresses.
+ * @param ctx Passed to block.
+ * @return uint64_t The number of relocations.
+ */
+
+static uint64_t reloc_relr(const uint64_t *relr, size_t count, unsigned int word,
+                           void (*block)(const uint64_t *addrs, size_t count, void *ctx), void *ctx) {
+  uint64_t addrs[RELOC_RELR_BLOCK], where = 0, total = 0;
+  unsigned int bits = word * 8 - 1;
+  size_t n = 0;
+
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t entry = relr[i];
+
+    if (!(entry & 1)) {
+      addrs[n++] = entry;
+      where = entry + word;
+    } else {
+      for (unsigned int bit = 1; bit <= bits; ++bit) {
+        if ((entry >> bit) & 1)
+          addrs[n++] = where + (uint64_t)(bit - 1) * word;
+      }
+      where += (uint64_t)bits * word;
+    }
+    if (n > RELOC_RELR_BLOCK - 64) {
+      block(addrs, n, ctx);
+      total += n;
+      n = 0;
+    }
+  }
+  block(addrs, n, ctx);
+  return total + n;
+}
+
+/**
+ * @brief reloc_relr() callback of the summary.
+ * 
+ */
+
+static void reloc_relr_count(const uint64_t *addrs, size_t count, void *ctx) {
+  reloc_stats_t *st = ctx;
+
+  reloc_count_offsets(st, (const char *)addrs, sizeof(uint64_t), count, st->none);
+}
+
+/**
+ * @brief Counts one relocation section.
+ * 
+ * @return uint64_t The relocations in it.
+ */
+
+static uint64_t reloc_count_section(elf_t *elf, reloc_stats_t *st, int shndx) {
+  const Elf64_Shdr *shdr = &elf->elf_section_header[shndx];
+  size_t entry = reloc_entry_size(elf, shdr);
+  const char *table = elf_section_table(elf, shndx);
+  uint64_t count = entry ? shdr->sh_size / entry : 0;
+
+  if (!table || !count)
+    return 0;
+
+  if (shdr->sh_type == SHT_RELR) {
+    uint32_t relative = get_relative_type(elf->elf_header->e_machine);
+    uint64_t relocs = reloc_relr((const uint64_t *)table, count, entry, reloc_relr_count, st);
+
+    st->types[relative < RELOC_TYPES ? relative : RELOC_TYPES] += relocs;
+    st->relr_words += count;
+    st->relr_relocs += relocs;
+    return relocs;
+  }
+
+  size_t stride = shdr->sh_type == SHT_RELA ? sizeof(Elf64_Rela) : sizeof(Elf64_Rel);
+
+  reloc_count_types(st, table, stride, count);
+
+  /* in objects, r_offset is relative to the section sh_info names */
+  if (st->relocatable)
+    st->by_section[shdr->sh_info < elf->elf_header->e_shnum ? shdr->sh_info : st->none] += count;
+  else
+    reloc_count_offsets(st, table, stride, count, st->none);
+  return count;
+}
+
+/**
+ * @brief Counts the pages of [start, end) that relocations write to.
+ * 
+ */
+
+static uint64_t reloc_dirty(const reloc_stats_t *st, uint64_t start, uint64_t end) {
+  uint64_t dirty = 0;
+
+  if (start >= end)
+    return 0;
+  for (uint64_t page = start / RELOC_PAGE_SIZE; page <= (end - 1) / RELOC_PAGE_SIZE; ++page) {
+    uint64_t bit = page - st->page_lo;
+
+    if (bit < st->npages && (st->pages[bit / 8] >> (bit % 8) & 1))
+      dirty++;
+  }
+  return dirty;
+}
+
+/**
+ * @brief Prints what the load segments will have to copy on write.
+ * 
+ */
+
+static void reloc_dump_pages(batch_file_t *file, const reloc_stats_t *st) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  uint64_t dirty = 0;
+
+  for (uint64_t i = 0; i < st->npages; ++i)
+    dirty += st->pages[i / 8] >> (i % 8) & 1;
+
+  out_str(out, "\nDirty pages at load (" RELOC_PAGE_NAME " pages): ");
+  out_udec(out, dirty, 0, 0);
+  out_str(out, ", ");
+  out_udec(out, dirty * RELOC_PAGE_SIZE / 1024, 0, 0);
+  out_str(out, " KiB\n"
+               "Segment      VirtAddr           Pages     Dirty  Flags\n");
+
+  for (int i = 0; i < elf->elf_header->e_phnum; ++i) {
+    const Elf64_Phdr *phdr = &elf->elf_program_header[i];
+
+    if ((phdr->p_type != PT_LOAD && phdr->p_type != PT_GNU_RELRO) || !phdr->p_memsz)
+      continue;
+
+    uint64_t pages = (phdr->p_vaddr + phdr->p_memsz - 1) / RELOC_PAGE_SIZE - phdr->p_vaddr / RELOC_PAGE_SIZE + 1;
+    uint64_t touched = reloc_dirty(st, phdr->p_vaddr, phdr->p_vaddr + phdr->p_memsz);
+
+    out_pad(out, phdr->p_type == PT_LOAD ? "LOAD" : "GNU_RELRO", 13, OUT_LEFT);
+    out_str(out, "0x");
+    out_hex(out, phdr->p_vaddr, 16, 0, 0);
+    out_udec(out, pages, 8, 0);
+    out_udec(out, touched, 10, 0);
+    out_str(out, "  ");
+    out_char(out, (phdr->p_flags & PF_R) ? 'R' : ' ');
+    out_char(out, (phdr->p_flags & PF_W) ? 'W' : ' ');
+    out_char(out, (phdr->p_flags & PF_X) ? 'E' : ' ');
+    if (touched && phdr->p_type == PT_LOAD && !(phdr->p_flags & PF_W))
+      out_str(out, "  text relocations");
+    out_char(out, '\n');
+  }
+}
+
+/**
+ * @brief Sums the relocations up: per table, per type, per target section, and the pages they dirty.
+ * 
+ * The tables are counted in bulk, a pass over each mapped (or converted)
+ * array for the types and one for the addresses, RELR bitmaps expanded a
+ * block at a time.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void summarize_relocations(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  uint16_t shnum = elf->elf_header->e_shnum;
+  reloc_stats_t st;
+  uint64_t total = 0;
+  bool any = false;
+
+  reloc_stats_init(elf, &st);
+  st.none = shnum;
+
+  for (int i = 0; i < shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+
+    if (!reloc_entry_size(elf, shdr))
+      continue;
+    if (!any)
+      out_str(out, "Section                    Type          Entries   Relocations\n");
+    any = true;
+
+    uint64_t relocs = reloc_count_section(elf, &st, i);
+
+    total += relocs;
+    out_pad(out, elf_section_name(elf, shdr), 25, OUT_LEFT | OUT_TRUNC);
+    out_str(out, "  ");
+    out_pad(out, shdr->sh_type == SHT_RELA ? "SHT_RELA" : shdr->sh_type == SHT_REL ? "SHT_REL" : "SHT_RELR",
+            10, OUT_LEFT);
+    out_udec(out, shdr->sh_size / reloc_entry_size(elf, shdr), 10, 0);
+    out_udec(out, relocs, 14, 0);
+    out_char(out, '\n');
+  }
+
+  if (!any) {
+    out_str(out, "No relocation sections.\n");
+    reloc_stats_free(&st);
+    return;
+  }
+
+  out_str(out, "\nRelocations: ");
+  out_udec(out, total, 0, 0);
+  if (st.relr_words) {
+    out_str(out, ", ");
+    out_udec(out, st.relr_relocs, 0, 0);
+    out_str(out, " of them packed in ");
+    out_udec(out, st.relr_words, 0, 0);
+    out_str(out, " RELR words");
+  }
+
+  out_str(out, "\n\nBy type:\n");
+  for (uint32_t type = 0; type <= RELOC_TYPES; ++type) {
+    if (!st.types[type])
+      continue;
+    out_udec(out, st.types[type], 12, 0);
+    out_str(out, "  ");
+    if (type == RELOC_TYPES)
+      out_str(out, "others");
+    else
+      reloc_type_name(out, elf->elf_header->e_machine, type, 0);
+    out_char(out, '\n');
+  }
+
+  out_str(out, "\nBy target section:\n");
+  for (uint16_t i = 0; i <= shnum; ++i) {
+    if (!st.by_section[i])
+      continue;
+    out_udec(out, st.by_section[i], 12, 0);
+    out_str(out, "  ");
+    out_str(out, i < shnum ? elf_section_name(elf, &elf->elf_section_header[i]) : "(outside any section)");
+    out_char(out, '\n');
+  }
+
+  if (st.pages)
+    reloc_dump_pages(file, &st);
+  reloc_stats_free(&st);
+}
+
+/**
+ * @brief reloc_relr() callback of the dump.
+ * 
+ */
+
+static void reloc_relr_dump(const uint64_t *addrs, size_t count, void *ctx) {
+  const batch_file_t *file = ctx;
+  Elf64_Half machine = file->elf->elf_header->e_machine;
+  uint32_t relative = get_relative_type(machine);
+
+  for (size_t i = 0; i < count; ++i) {
+    out_hex(file->out, addrs[i], 16, 0, 0);
+    out_str(file->out, "  ");
+    reloc_type_name(file->out, machine, relative, 0);
+    out_char(file->out, '\n');
+  }
+}
+
+/**
+ * @brief Writes the symbol of a relocation, a section symbol by its section's name.
+ * 
+ */
+
+static void reloc_dump_symbol(batch_file_t *file, const Elf64_Sym *syms, uint64_t nsyms, const char *strtab,
+                              uint64_t strsize, uint64_t index) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+
+  if (!index)
+    return;
+  if (!syms || index >= nsyms) {
+    out_str(out, "<bad symbol index ");
+    out_udec(out, index, 0, 0);
+    out_str(out, ">");
+    return;
+  }
+
+  const Elf64_Sym *sym = &syms[index];
+
+  if (ELF64_ST_TYPE(sym->st_info) == STT_SECTION && sym->st_shndx < elf->elf_header->e_shnum)
+    out_str(out, elf_section_name(elf, &elf->elf_section_header[sym->st_shndx]));
+  else
+    out_str(out, elf_string(strtab, strsize, sym->st_name));
+}
+
+/**
+ * @brief Lists every relocation of every SHT_REL, SHT_RELA and SHT_RELR section.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void dump_relocations(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  uint16_t shnum = elf->elf_header->e_shnum;
+  uint16_t machine = elf->elf_header->e_machine;
+  bool any = false;
+
+  for (int i = 0; i < shnum; ++i) {
+    const Elf64_Shdr *shdr = &elf->elf_section_header[i];
+    size_t entry = reloc_entry_size(elf, shdr);
+    const char *table = entry ? elf_section_table(elf, i) : NULL;
+    uint64_t count = entry ? shdr->sh_size / entry : 0;
+
+    if (!entry)
+      continue;
+    out_str(out, any ? "\nRelocation section '" : "Relocation section '");
+    out_str(out, elf_section_name(elf, shdr));
+    out_str(out, "' at offset 0x");
+    out_hex(out, shdr->sh_offset, 0, 0, 0);
+    out_str(out, ", ");
+    out_udec(out, count, 0, 0);
+    out_str(out, " entries:\n");
+    any = true;
+    if (!table)
+      continue;
+
+    if (shdr->sh_type == SHT_RELR) {
+      out_str(out, "Offset            Type\n");
+      reloc_relr((const uint64_t *)table, count, entry, reloc_relr_dump, file);
+      continue;
+    }
+
+    const Elf64_Shdr *symtab = shdr->sh_link && shdr->sh_link < shnum ? &elf->elf_section_header[shdr->sh_link] : NULL;
+    const Elf64_Sym *syms = NULL;
+    const char *strtab = NULL;
+    uint64_t nsyms = 0, strsize = 0;
+
+    if (symtab && (symtab->sh_type == SHT_SYMTAB || symtab->sh_type == SHT_DYNSYM) && symtab->sh_entsize
+        && (syms = elf_section_table(elf, shdr->sh_link))) {
+      nsyms = symtab->sh_size / symtab->sh_entsize;
+      if (symtab->sh_link < shnum && (strtab = elf_section_data(elf, symtab->sh_link)))
+        strsize = elf->elf_section_header[symtab->sh_link].sh_size;
+    }
+
+    bool rela = shdr->sh_type == SHT_RELA;
+
+    out_str(out, rela ? "Offset            Type                          Symbol + Addend\n"
+                      : "Offset            Type                          Symbol\n");
+    for (uint64_t r = 0; r < count; ++r) {
+      const Elf64_Rela *rel = (const Elf64_Rela *)(table + r * (rela ? sizeof(Elf64_Rela) : sizeof(Elf64_Rel)));
+      uint64_t sym = ELF64_R_SYM(rel->r_info);
+
+      out_hex(out, rel->r_offset, 16, 0, 0);
+      out_str(out, "  ");
+      reloc_type_name(out, machine, ELF64_R_TYPE(rel->r_info), 30);
+      reloc_dump_symbol(file, syms, nsyms, strtab, strsize, sym);
+      if (rela) {
+        out_str(out, rel->r_addend < 0 ? (sym ? " - 0x" : "-0x") : (sym ? " + 0x" : "0x"));
+        out_hex(out, rel->r_addend < 0 ? -(uint64_t)rel->r_addend : (uint64_t)rel->r_addend, 0, 0, 0);
+      }
+      out_char(out, '\n');
+    }
+  }
+
+  if (!any)
+    out_str(out, "No relocation sections.\n");
+}
@@ -0,0 +1,36 @@
+#ifndef _RELOC_H
+#define _RELOC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RELOC_TYPES 1040       /* counted by type number, past the AArch64 dynamic ones (1024-1032) */
+#define RELOC_PAGE_SIZE 4096
+#define RELOC_PAGE_NAME "4 KiB"
+#define RELOC_RELR_BLOCK 4096  /* RELR addresses expanded at a time */
+
+typedef struct reloc_range {
+  uint64_t start;
+  uint64_t end;
+  int shndx;
+} reloc_range_t;
+
+typedef struct reloc_stats {
+  uint64_t types[RELOC_TYPES + 1];  /* the last one counts the types past the table */
+  uint64_t *by_section;             /* per section index, [none] for addresses in no section */
+  size_t none;
+  reloc_range_t *ranges;            /* the allocated sections, by address */
+  size_t nranges;
+  size_t last;                      /* the range the last address was in */
+  uint8_t *pages;                   /* a bit per page of the image a relocation writes to */
+  uint64_t page_lo;
+  uint64_t npages;
+  uint64_t relr_words;
+  uint64_t relr_relocs;
+  bool relocatable;                 /* ET_REL, offsets are within the target section */
+} reloc_stats_t;
+
+void summarize_relocations(batch_file_t *file);
+void dump_relocations(batch_file_t *file);
+
+#endif
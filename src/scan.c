@@ -0,0 +1,354 @@
+/**
+ * @file scan.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Walks directory trees and triages ELF files by their first bytes.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+/**
+ * @brief Sets up an io_uring with raw syscalls, liburing is not needed.
+ * 
+ * @return bool false if the kernel doesn't have (or doesn't allow) io_uring.
+ */
+
+static bool ring_init(scan_ring_t *ring) {
+  struct io_uring_params params = {0};
+
+  memset(ring, 0, sizeof(scan_ring_t));
+  ring->fd = syscall(__NR_io_uring_setup, SCAN_BATCH, &params);
+  if (ring->fd < 0)
+    return false;
+
+  ring->sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+  ring->cq_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  ring->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+
+  ring->sq_ring = mmap(NULL, ring->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring->fd, IORING_OFF_SQ_RING);
+  ring->cq_ring = mmap(NULL, ring->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring->fd, IORING_OFF_CQ_RING);
+  ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring->fd, IORING_OFF_SQES);
+
+  if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+    close(ring->fd);
+    return false;
+  }
+
+  char *sq = ring->sq_ring, *cq = ring->cq_ring;
+
+  ring->sq_head = (unsigned int *)(sq + params.sq_off.head);
+  ring->sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+  ring->sq_mask = (unsigned int *)(sq + params.sq_off.ring_mask);
+  ring->sq_array = (unsigned int *)(sq + params.sq_off.array);
+  ring->cq_head = (unsigned int *)(cq + params.cq_off.head);
+  ring->cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+  ring->cq_mask = (unsigned int *)(cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+  return true;
+}
+
+/**
+ * @brief Tears the ring down.
+ * 
+ */
+
+static void ring_destroy(scan_ring_t *ring) {
+  munmap(ring->sqes, ring->sqes_len);
+  munmap(ring->cq_ring, ring->cq_len);
+  munmap(ring->sq_ring, ring->sq_len);
+  close(ring->fd);
+}
+
+/**
+ * @brief Reads the first bytes of every open file in the batch with one io_uring_enter(2).
+ * 
+ * @return bool false if the ring failed as a whole, the caller falls back to pread.
+ */
+
+static bool ring_read_heads(scan_t *scan) {
+  scan_ring_t *ring = &scan->ring;
+  unsigned int tail = *ring->sq_tail, submitted = 0;
+
+  for (size_t i = 0; i < scan->count; ++i) {
+    if (scan->fds[i] < 0)
+      continue;
+
+    unsigned int index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = scan->fds[i];
+    sqe->addr = (uint64_t)(uintptr_t)scan->heads[i];
+    sqe->len = sizeof(scan->heads[i]);
+    sqe->user_data = i;
+    ring->sq_array[index] = index;
+    ++tail;
+    ++submitted;
+  }
+  __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+  for (unsigned int done = 0; done < submitted;) {
+    unsigned int head = *ring->cq_head;
+
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+      /* the first call submits everything, later ones only wait */
+      long ret = syscall(__NR_io_uring_enter, ring->fd, done ? 0 : submitted,
+                         submitted - done, IORING_ENTER_GETEVENTS, NULL, 0);
+
+      if (ret < 0 && errno != EINTR)
+        return false;
+      continue;
+    }
+
+    struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+
+    scan->res[cqe->user_data] = cqe->res;
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    ++done;
+  }
+  return true;
+}
+
+/**
+ * @brief Reports one file whose first bytes look like ELF, the only ones that get parsed.
+ * 
+ * @param scan The scanner.
+ * @param index The file's slot in the batch, its descriptor is consumed.
+ */
+
+static void scan_report(scan_t *scan, size_t index) {
+  const unsigned char *ident = scan->heads[index];
+  int fd = scan->fds[index];
+
+  scan->fds[index] = -1;
+  out_str(scan->out, scan->dir);
+  out_char(scan->out, '/');
+  out_str(scan->out, scan->names[index]);
+  out_write(scan->out, ": ", 2);
+
+  elf_t *elf;
+  elf_status_t status = elf_open_fd(fd, ELF_BACKEND_MMAP, NULL, &elf);
+
+  close(fd);
+  if (status == ELF_ECORRUPT) {
+    scan->unsupported++;
+    out_str(scan->out, ident[EI_CLASS] == ELFCLASS32 ? "ELF32" : "ELF64");
+    out_str(scan->out, ident[EI_DATA] == ELFDATA2MSB ? " big-endian" : "");
+    out_str(scan->out, ", truncated or corrupt headers\n");
+    return;
+  }
+  if (status != ELF_OK) {
+    scan->unsupported++;
+    out_str(scan->out, elf_strerror(status));
+    out_char(scan->out, '\n');
+    return;
+  }
+
+  scan->elves++;
+  batch_file_t file = {.elf = elf, .out = scan->out, .err = stderr};
+
+  dump_elf_summary(&file);
+  elf_close(elf);
+}
+
+/**
+ * @brief Opens every file of the batch, reads their heads and triages them.
+ * 
+ */
+
+static void scan_flush(scan_t *scan) {
+  if (!scan->count)
+    return;
+
+  for (size_t i = 0; i < scan->count; ++i) {
+    scan->fds[i] = openat(scan->dirfd, scan->names[i], O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_CLOEXEC);
+    scan->res[i] = (scan->fds[i] < 0) ? -errno : 0;
+  }
+
+  if (scan->uring && !ring_read_heads(scan)) {
+    fprintf(stderr, "io_uring failed, falling back to pread.\n");
+    ring_destroy(&scan->ring);
+    scan->uring = false;
+  }
+
+  for (size_t i = 0; i < scan->count; ++i) {
+    if (!scan->uring && scan->fds[i] >= 0) {
+      ssize_t n = pread(scan->fds[i], scan->heads[i], sizeof(scan->heads[i]), 0);
+
+      scan->res[i] = (n < 0) ? -errno : n;
+    }
+
+    if (scan->res[i] >= EI_NIDENT && !memcmp(scan->heads[i], ELFMAG, SELFMAG))
+      scan_report(scan, i);
+    else if (scan->fds[i] >= 0)
+      close(scan->fds[i]);
+  }
+  scan->files += scan->count;
+  scan->count = 0;
+}
+
+/**
+ * @brief Queues a directory to be walked later.
+ * 
+ */
+
+static bool scan_push(scan_t *scan, const char *dir, const char *name) {
+  if (scan->dirs_count == scan->dirs_cap) {
+    size_t cap = scan->dirs_cap ? scan->dirs_cap * 2 : 64;
+    char **tmp = realloc(scan->dirs, cap * sizeof(char *));
+
+    if (!tmp)
+      return false;
+    scan->dirs = tmp;
+    scan->dirs_cap = cap;
+  }
+
+  size_t len = strlen(dir), nlen = name ? strlen(name) : 0;
+  char *path = malloc(len + nlen + 2);
+
+  if (!path)
+    return false;
+
+  memcpy(path, dir, len);
+  if (name) {
+    /* "/" + "usr" shouldn't become "//usr" */
+    if (!len || path[len - 1] != '/')
+      path[len++] = '/';
+    memcpy(path + len, name, nlen);
+    len += nlen;
+  }
+  path[len] = '\0';
+  scan->dirs[scan->dirs_count++] = path;
+  return true;
+}
+
+/**
+ * @brief Reads one directory with getdents64(2), queueing subdirectories and batching regular files.
+ * 
+ * Symbolic links are never followed, and nothing but d_type is looked at
+ * unless the filesystem leaves it DT_UNKNOWN.
+ */
+
+static void scan_dir(scan_t *scan, const char *path) {
+  int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  long n;
+
+  if (fd == -1) {
+    fprintf(stderr, "%s: Failed to open the directory.\n", path);
+    scan->failed = true;
+    return;
+  }
+
+  scan->dir = (!strcmp(path, "/")) ? "" : path;
+  scan->dirfd = fd;
+
+  while ((n = syscall(SYS_getdents64, fd, scan->dents, sizeof(scan->dents))) > 0) {
+    for (long off = 0; off < n;) {
+      struct dirent64 *ent = (struct dirent64 *)(scan->dents + off);
+      unsigned char type = ent->d_type;
+      struct stat st;
+
+      off += ent->d_reclen;
+      if (ent->d_name[0] == '.' && (!ent->d_name[1] || (ent->d_name[1] == '.' && !ent->d_name[2])))
+        continue;
+
+      if (type == DT_UNKNOWN && !fstatat(fd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW))
+        type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+
+      if (type == DT_DIR && !scan_push(scan, path, ent->d_name))
+        fprintf(stderr, "%s/%s: Failed to allocate memory for the path.\n", path, ent->d_name);
+
+      if (type != DT_REG)
+        continue;
+
+      memcpy(scan->names[scan->count], ent->d_name, strlen(ent->d_name) + 1);
+      if (++scan->count == SCAN_BATCH)
+        scan_flush(scan);
+    }
+  }
+
+  if (n < 0) {
+    fprintf(stderr, "%s: Failed to read the directory.\n", path);
+    scan->failed = true;
+  }
+
+  scan_flush(scan);
+  close(fd);
+}
+
+/**
+ * @brief Walks the given directories and lists every ELF file in them.
+ * 
+ * Files are read SCAN_BATCH at a time: all of them are opened, then their
+ * first sizeof(Elf64_Ehdr) bytes are read, through one io_uring submission
+ * when the kernel allows it and one pread(2) each otherwise. Only files
+ * with the ELF magic are ever mapped and parsed. The number of files per
+ * second is reported on stderr.
+ * 
+ * @param paths The directories.
+ * @param count How many there are.
+ * @param uring Whether to try io_uring at all.
+ * @return bool false if a directory could not be read.
+ */
+
+bool run_scan(char **paths, int count, bool uring) {
+  scan_t *scan = calloc(1, sizeof(scan_t));
+  out_t out;
+  struct timespec start, end;
+
+  if (!scan)
+    return false;
+
+  out_init(&out, STDOUT_FILENO);
+  scan->out = &out;
+  scan->uring = uring && ring_init(&scan->ring);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int i = count - 1; i >= 0; --i) {
+    if (!scan_push(scan, paths[i], NULL))
+      break;
+  }
+
+  while (scan->dirs_count) {
+    char *path = scan->dirs[--scan->dirs_count];
+
+    scan_dir(scan, path);
+    free(path);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  out_destroy(&out);
+
+  double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+  fprintf(stderr, "%lu files, %lu ELF, %lu not parsed, %.3f s, %.0f files/sec (%s)\n",
+          (unsigned long)scan->files, (unsigned long)scan->elves, (unsigned long)scan->unsupported,
+          secs, secs > 0 ? scan->files / secs : 0.0, scan->uring ? "io_uring" : "pread");
+
+  bool ok = !scan->failed;
+
+  if (scan->uring)
+    ring_destroy(&scan->ring);
+  free(scan->dirs);
+  free(scan);
+  return ok;
+}
@@ -0,0 +1,48 @@
+#ifndef _SCAN_H
+#define _SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define SCAN_BATCH 256
+#define SCAN_DENTS (1 << 16)
+#define SCAN_NAME 256
+
+typedef struct scan_ring {
+  int fd;
+  unsigned int *sq_head, *sq_tail, *sq_mask, *sq_array;
+  unsigned int *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sq_ring, *cq_ring;
+  size_t sq_len, cq_len, sqes_len;
+} scan_ring_t;
+
+typedef struct scan {
+  out_t *out;
+  scan_ring_t ring;
+  bool uring;             /* false: one pread(2) per file */
+  const char *dir;        /* the directory the batch was read from */
+  int dirfd;
+  size_t count;           /* files in the batch */
+  int fds[SCAN_BATCH];
+  int res[SCAN_BATCH];    /* bytes read, or -errno */
+  unsigned char heads[SCAN_BATCH][sizeof(Elf64_Ehdr)];
+  char names[SCAN_BATCH][SCAN_NAME];
+  char dents[SCAN_DENTS];
+  char **dirs;            /* directories left to walk */
+  size_t dirs_count;
+  size_t dirs_cap;
+  uint64_t files;
+  uint64_t elves;
+  uint64_t unsupported;
+  bool failed;            /* a directory could not be read */
+} scan_t;
+
+bool run_scan(char **paths, int count, bool uring);
+
+#endif
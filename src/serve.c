@@ -0,0 +1,1012 @@
+/**
+ * @file serve.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief A query server on a Unix socket that keeps parsed files mapped, and its client.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+/**
+ * @brief Returns CLOCK_MONOTONIC in nanoseconds.
+ * 
+ */
+
+static uint64_t serve_now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Returns the latency bucket of a duration: exact below 16 ns, then 16 per power of two.
+ * 
+ */
+
+static inline __attribute__((always_inline)) unsigned int serve_bucket(uint64_t ns) {
+  if (ns < 16)
+    return (unsigned int)ns;
+
+  unsigned int e = 63 - __builtin_clzll(ns);
+
+  return (e - 3) * 16 + (unsigned int)((ns >> (e - 4)) & 15);
+}
+
+/**
+ * @brief Returns the smallest duration that falls in a bucket.
+ * 
+ */
+
+static uint64_t serve_bucket_ns(unsigned int bucket) {
+  if (bucket < 16)
+    return bucket;
+  return (uint64_t)(16 + bucket % 16) << (bucket / 16 - 1);
+}
+
+/**
+ * @brief Returns the duration under which `percent` of the queries were answered.
+ * 
+ * Good to 1/16th, the width of a bucket.
+ */
+
+static uint64_t serve_percentile(const uint64_t *hist, uint64_t total, unsigned int percent) {
+  uint64_t want = (total * percent + 99) / 100;
+  uint64_t seen = 0;
+
+  for (unsigned int i = 0; i < SERVE_HIST; ++i) {
+    seen += hist[i];
+    if (seen && seen >= want)
+      return serve_bucket_ns(i);
+  }
+  return 0;
+}
+
+/**
+ * @brief FNV-1a of a path.
+ * 
+ */
+
+static inline __attribute__((always_inline)) uint64_t serve_hash(const char *path) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+
+  while (*path)
+    hash = (hash ^ (unsigned char)*path++) * 0x100000001b3ull;
+  return hash;
+}
+
+/**
+ * @brief Checks that a cached file is still the one at its path.
+ * 
+ */
+
+static inline __attribute__((always_inline)) bool serve_same(const serve_entry_t *entry, const struct stat *st) {
+  return entry->dev == st->st_dev && entry->ino == st->st_ino && entry->size == st->st_size
+         && entry->mtime.tv_sec == st->st_mtim.tv_sec && entry->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+/**
+ * @brief Unmaps a parsed file and frees its entry.
+ * 
+ */
+
+static void serve_free_entry(serve_entry_t *entry) {
+  elf_close(entry->elf);
+  free(entry->path);
+  free(entry);
+}
+
+/**
+ * @brief Takes an entry out of the LRU list, must be called with files_lock held.
+ * 
+ */
+
+static void serve_lru_unlink(server_t *srv, serve_entry_t *entry) {
+  if (entry->prev)
+    entry->prev->next = entry->next;
+  else
+    srv->head = entry->next;
+  if (entry->next)
+    entry->next->prev = entry->prev;
+  else
+    srv->tail = entry->prev;
+}
+
+/**
+ * @brief Puts an entry at the front of the LRU list, must be called with files_lock held.
+ * 
+ */
+
+static void serve_lru_push(server_t *srv, serve_entry_t *entry) {
+  entry->prev = NULL;
+  entry->next = srv->head;
+  if (srv->head)
+    srv->head->prev = entry;
+  else
+    srv->tail = entry;
+  srv->head = entry;
+}
+
+/**
+ * @brief Takes an entry out of the table and the LRU list, must be called with files_lock held.
+ * 
+ */
+
+static void serve_unlink(server_t *srv, serve_entry_t *entry) {
+  serve_entry_t **link = &srv->buckets[entry->hash & srv->mask];
+
+  while (*link != entry)
+    link = &(*link)->chain;
+  *link = entry->chain;
+  serve_lru_unlink(srv, entry);
+  srv->count--;
+}
+
+/**
+ * @brief Looks a path up in the table, must be called with files_lock held.
+ * 
+ */
+
+static serve_entry_t *serve_find(server_t *srv, const char *path, uint64_t hash) {
+  serve_entry_t *entry = srv->buckets[hash & srv->mask];
+
+  while (entry && (entry->hash != hash || strcmp(entry->path, path)))
+    entry = entry->chain;
+  return entry;
+}
+
+/**
+ * @brief Returns the parsed file at `path`, from the LRU if it hasn't changed since.
+ * 
+ * Files are opened and parsed outside of the lock, a changed file replaces
+ * its old entry, which lives on until the requests running on it are done.
+ * Past the capacity, the least recently used entries nobody is using go.
+ * 
+ * @param status Why the file could not be parsed, when NULL is returned.
+ * @return serve_entry_t* The entry, to give back with serve_release().
+ */
+
+static serve_entry_t *serve_acquire(server_t *srv, const char *path, elf_status_t *status) {
+  uint64_t hash = serve_hash(path);
+  serve_entry_t *entry;
+  struct stat st;
+
+  if (stat(path, &st) == 0) {
+    pthread_mutex_lock(&srv->files_lock);
+    if ((entry = serve_find(srv, path, hash)) && serve_same(entry, &st)) {
+      entry->refs++;
+      srv->hits++;
+      if (entry != srv->head) {
+        serve_lru_unlink(srv, entry);
+        serve_lru_push(srv, entry);
+      }
+      pthread_mutex_unlock(&srv->files_lock);
+      return entry;
+    }
+    pthread_mutex_unlock(&srv->files_lock);
+  }
+
+  /* the descriptor's stat is the one of the bytes we map, whatever happens to the path */
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  elf_t *elf = NULL;
+
+  if (fd == -1 || fstat(fd, &st) == -1)
+    *status = ELF_EOPEN;
+  else
+    *status = elf_open_fd(fd, ELF_BACKEND_MMAP, NULL, &elf);
+  if (fd != -1)
+    close(fd);
+
+  if (*status == ELF_OK && (!(entry = calloc(1, sizeof(serve_entry_t))) || !(entry->path = strdup(path)))) {
+    free(entry);
+    elf_close(elf);
+    *status = ELF_ENOMEM;
+  }
+  if (*status != ELF_OK)
+    return NULL;
+
+  entry->hash = hash;
+  entry->dev = st.st_dev;
+  entry->ino = st.st_ino;
+  entry->size = st.st_size;
+  entry->mtime = st.st_mtim;
+  entry->elf = elf;
+  entry->refs = 1;
+
+  pthread_mutex_lock(&srv->files_lock);
+  serve_entry_t *old = serve_find(srv, path, hash);
+
+  if (old) {
+    serve_unlink(srv, old);
+    srv->reloads += !serve_same(old, &st);
+    if (old->refs)
+      old->stale = true;
+    else
+      serve_free_entry(old);
+  }
+
+  entry->chain = srv->buckets[hash & srv->mask];
+  srv->buckets[hash & srv->mask] = entry;
+  serve_lru_push(srv, entry);
+  srv->count++;
+  srv->misses++;
+
+  for (serve_entry_t *victim = srv->tail, *prev; victim && srv->count > srv->capacity; victim = prev) {
+    prev = victim->prev;
+    if (!victim->refs) {
+      serve_unlink(srv, victim);
+      serve_free_entry(victim);
+      srv->evictions++;
+    }
+  }
+  pthread_mutex_unlock(&srv->files_lock);
+  return entry;
+}
+
+/**
+ * @brief Gives back an entry from serve_acquire(), the last request on a stale one frees it.
+ * 
+ */
+
+static void serve_release(server_t *srv, serve_entry_t *entry) {
+  pthread_mutex_lock(&srv->files_lock);
+  if (!--entry->refs && entry->stale)
+    serve_free_entry(entry);
+  pthread_mutex_unlock(&srv->files_lock);
+}
+
+/**
+ * @brief Splits the next space separated word off a request.
+ * 
+ * @return char* The word, NULL at the end of the line.
+ */
+
+static char *serve_word(char **line) {
+  char *word = *line;
+
+  while (*word == ' ')
+    word++;
+  if (!*word)
+    return NULL;
+
+  char *end = strchr(word, ' ');
+
+  *line = end ? end + 1 : word + strlen(word);
+  if (end)
+    *end = '\0';
+  return word;
+}
+
+/**
+ * @brief Writes the counters, as the body of a `stats` request.
+ * 
+ */
+
+static void serve_stats(server_t *srv, out_t *out) {
+  uint64_t hist[SERVE_HIST];
+  uint64_t total = 0;
+  char line[256];
+
+  for (unsigned int i = 0; i < SERVE_HIST; ++i)
+    total += hist[i] = __atomic_load_n(&srv->hist[i], __ATOMIC_RELAXED);
+
+  double secs = (serve_now() - srv->started_ns) / 1e9;
+  uint64_t queries = __atomic_load_n(&srv->queries, __ATOMIC_RELAXED);
+
+  pthread_mutex_lock(&srv->files_lock);
+  snprintf(line, sizeof(line),
+           "uptime %.1f s\n"
+           "queries %lu, %lu failed, %.1f queries/sec\n"
+           "latency p50 %.1f us, p99 %.1f us\n"
+           "files %lu mapped of %lu, %lu hits, %lu misses, %lu reloaded, %lu evicted\n",
+           secs, (unsigned long)queries, (unsigned long)__atomic_load_n(&srv->errors, __ATOMIC_RELAXED),
+           secs > 0 ? queries / secs : 0.0,
+           serve_percentile(hist, total, 50) / 1e3, serve_percentile(hist, total, 99) / 1e3,
+           (unsigned long)srv->count, (unsigned long)srv->capacity, (unsigned long)srv->hits,
+           (unsigned long)srv->misses, (unsigned long)srv->reloads, (unsigned long)srv->evictions);
+  pthread_mutex_unlock(&srv->files_lock);
+  out_str(out, line);
+}
+
+/**
+ * @brief Answers one request line into `out`.
+ * 
+ * A request is `[-f <format>] [-e <sections>] <option> [argument] <path>`,
+ * with the path running to the end of the line, or `stats`. The path must
+ * be absolute, the LRU is keyed on it and the server's directory isn't
+ * the client's. What the handler reports on stderr in a local run becomes
+ * the error message, whole lines as they would have been printed.
+ * 
+ * @return bool false if `out` holds an error message instead.
+ */
+
+static bool serve_request(server_t *srv, char *line, out_t *out) {
+  out_format_t format = OUT_TEXT;
+  const char *extra = NULL;
+  const arg_t *arg = NULL;
+  char *word = serve_word(&line);
+
+  while (word && (!strcmp(word, "-f") || !strcmp(word, "-e"))) {
+    const char *value = serve_word(&line);
+
+    if (value && word[1] == 'e')
+      extra = value;
+    else if (value && !strcmp(value, "json"))
+      format = OUT_JSON;
+    else if (value && !strcmp(value, "ndjson"))
+      format = OUT_NDJSON;
+    else if (!value || strcmp(value, "text"))
+      break;
+    word = serve_word(&line);
+  }
+
+  if (word && !strcmp(word, "stats") && !*line) {
+    serve_stats(srv, out);
+    return true;
+  }
+
+  for (size_t i = 0; word && i < srv->nargs; ++i)
+    if (!strcmp(word, srv->args[i].name))
+      arg = &srv->args[i];
+
+  if (!arg || !arg->served) {
+    out_str(out, "Invalid option.");
+    return false;
+  }
+  if (extra && !arg->param && arg->func != hash_sections) {
+    out_str(out, "Only -H leaves sections out.");
+    return false;
+  }
+  if (arg->param && !(extra = serve_word(&line))) {
+    out_str(out, "Missing argument.");
+    return false;
+  }
+  if (format != OUT_TEXT && !arg->structured) {
+    out_str(out, "Only -h, -p, -S and -st have structured output.");
+    return false;
+  }
+  if (!*line) {
+    out_str(out, "No files given.");
+    return false;
+  }
+  if (*line != '/') {
+    out_str(out, "The path must be absolute.");
+    return false;
+  }
+
+  elf_status_t status;
+  serve_entry_t *entry = serve_acquire(srv, line, &status);
+
+  if (!entry) {
+    out_str(out, elf_strerror(status));
+    return false;
+  }
+
+  char *diag = NULL;
+  size_t diag_len = 0;
+  FILE *err = open_memstream(&diag, &diag_len);
+
+  if (!err) {
+    serve_release(srv, entry);
+    out_str(out, "Failed to allocate memory for the diagnostics.");
+    return false;
+  }
+
+  /* the entry is shared by every request on the file, each gets its own output */
+  batch_file_t file = {.elf = entry->elf, .out = out, .format = format, .path = entry->path, .arg = extra,
+                       .err = err};
+
+  arg->func(&file);
+
+  serve_release(srv, entry);
+  fclose(err);
+
+  if (diag_len) {
+    out->len = out->bytes = 0;
+    out_write(out, diag, diag_len);
+  }
+  free(diag);
+  return !diag_len;
+}
+
+/**
+ * @brief send(2)s everything, waiting a while for a client that reads slowly.
+ * 
+ */
+
+static bool serve_send(int fd, const char *data, size_t len) {
+  for (size_t done = 0; done < len;) {
+    ssize_t n = send(fd, data + done, len - done, MSG_NOSIGNAL);
+
+    if (n > 0) {
+      done += n;
+      continue;
+    }
+
+    struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK) || poll(&pfd, 1, SERVE_SEND_MS) <= 0)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Closes a connection, must be called by the thread that owns it.
+ * 
+ */
+
+static void serve_close(server_t *srv, serve_conn_t *conn) {
+  pthread_mutex_lock(&srv->queue_lock);
+  if (conn->prev)
+    conn->prev->next = conn->next;
+  else
+    srv->conns = conn->next;
+  if (conn->next)
+    conn->next->prev = conn->prev;
+  pthread_mutex_unlock(&srv->queue_lock);
+
+  close(conn->fd);
+  free(conn);
+}
+
+/**
+ * @brief Gives a connection back to the event loop, or closes it.
+ * 
+ */
+
+static void serve_rearm(server_t *srv, serve_conn_t *conn) {
+  struct epoll_event ev = {.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT, .data.ptr = conn};
+  bool armed = false;
+
+  /* under the lock the event loop takes before reading, so race detectors see the handoff too */
+  if (!conn->eof) {
+    pthread_mutex_lock(&srv->queue_lock);
+    armed = epoll_ctl(srv->epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev) == 0;
+    pthread_mutex_unlock(&srv->queue_lock);
+  }
+  if (!armed)
+    serve_close(srv, conn);
+}
+
+/**
+ * @brief Answers every complete request a connection has sent, in order.
+ * 
+ * The connection is out of the event loop (EPOLLONESHOT) until this is
+ * done, so it belongs to this thread alone.
+ * 
+ * @param out The worker's buffer, reused from request to request.
+ */
+
+static void serve_conn(server_t *srv, serve_conn_t *conn, out_t *out) {
+  char *start = conn->in;
+  char *nl;
+  char header[32];
+
+  while ((nl = memchr(start, '\n', conn->len - (start - conn->in)))) {
+    uint64_t begin = serve_now();
+
+    *nl = '\0';
+    if (nl > start && nl[-1] == '\r')
+      nl[-1] = '\0';
+
+    out->len = out->bytes = 0;
+
+    bool is_stats = !strcmp(start, "stats");
+    bool ok = serve_request(srv, start, out);
+    int hlen = snprintf(header, sizeof(header), "%s %lu\n", ok ? "ok" : "error", (unsigned long)out->len);
+
+    if (!serve_send(conn->fd, header, hlen) || !serve_send(conn->fd, out->buf, out->len))
+      conn->eof = true;
+    start = nl + 1;
+
+    if (!is_stats) {
+      __atomic_fetch_add(&srv->queries, 1, __ATOMIC_RELAXED);
+      __atomic_fetch_add(&srv->hist[serve_bucket(serve_now() - begin)], 1, __ATOMIC_RELAXED);
+      if (!ok)
+        __atomic_fetch_add(&srv->errors, 1, __ATOMIC_RELAXED);
+    }
+    if (conn->eof)
+      break;
+  }
+
+  conn->len -= start - conn->in;
+  memmove(conn->in, start, conn->len);
+
+  if (conn->len == sizeof(conn->in)) {
+    static const char too_long[] = "error 17\nRequest too long.";
+
+    serve_send(conn->fd, too_long, sizeof(too_long) - 1);
+    conn->eof = true;
+  }
+  serve_rearm(srv, conn);
+}
+
+/**
+ * @brief Worker loop, it takes connections with requests off the queue until the server stops.
+ * 
+ */
+
+static void *serve_worker(void *arg) {
+  server_t *srv = arg;
+  out_t out = {0};
+
+  if (!out_init(&out, -1))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the output buffer!");
+
+  for (;;) {
+    pthread_mutex_lock(&srv->queue_lock);
+    while (!srv->stopping && !srv->queue_head)
+      pthread_cond_wait(&srv->queue_cond, &srv->queue_lock);
+
+    serve_conn_t *conn = srv->stopping ? NULL : srv->queue_head;
+
+    if (conn && !(srv->queue_head = conn->queued))
+      srv->queue_tail = NULL;
+    pthread_mutex_unlock(&srv->queue_lock);
+
+    if (!conn)
+      break;
+    serve_conn(srv, conn, &out);
+  }
+
+  out_destroy(&out);
+  return NULL;
+}
+
+/**
+ * @brief Reads what a connection sent and queues it once a request is complete.
+ * 
+ */
+
+static void serve_readable(server_t *srv, serve_conn_t *conn) {
+  /* the worker that rearmed the connection unlocked it last, see serve_rearm() */
+  pthread_mutex_lock(&srv->queue_lock);
+  pthread_mutex_unlock(&srv->queue_lock);
+
+  while (conn->len < sizeof(conn->in)) {
+    ssize_t n = recv(conn->fd, conn->in + conn->len, sizeof(conn->in) - conn->len, 0);
+
+    if (n > 0) {
+      conn->len += n;
+    } else if (n == 0 || (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)) {
+      conn->eof = true;
+      break;
+    } else if (errno != EINTR) {
+      break;
+    }
+  }
+
+  if (!memchr(conn->in, '\n', conn->len) && conn->len < sizeof(conn->in)) {
+    serve_rearm(srv, conn);
+    return;
+  }
+
+  pthread_mutex_lock(&srv->queue_lock);
+  conn->queued = NULL;
+  if (srv->queue_tail)
+    srv->queue_tail->queued = conn;
+  else
+    srv->queue_head = conn;
+  srv->queue_tail = conn;
+  pthread_cond_signal(&srv->queue_cond);
+  pthread_mutex_unlock(&srv->queue_lock);
+}
+
+/**
+ * @brief Accepts every pending connection into the event loop.
+ * 
+ */
+
+static void serve_accept(server_t *srv) {
+  int fd;
+
+  while ((fd = accept4(srv->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+    serve_conn_t *conn = malloc(sizeof(serve_conn_t));
+    struct epoll_event ev = {.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT, .data.ptr = conn};
+
+    if (!conn) {
+      close(fd);
+      continue;
+    }
+    conn->fd = fd;
+    conn->eof = false;
+    conn->len = 0;
+    conn->prev = NULL;
+
+    pthread_mutex_lock(&srv->queue_lock);
+    if ((conn->next = srv->conns))
+      conn->next->prev = conn;
+    srv->conns = conn;
+    pthread_mutex_unlock(&srv->queue_lock);
+
+    if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1)
+      serve_close(srv, conn);
+  }
+}
+
+/**
+ * @brief Fills in a socket address, false if the path doesn't fit in one.
+ * 
+ */
+
+static bool serve_address(struct sockaddr_un *addr, const char *path) {
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(addr->sun_path))
+    return false;
+  strcpy(addr->sun_path, path);
+  return true;
+}
+
+/**
+ * @brief Binds the listening socket, replacing a stale one but not a live server.
+ * 
+ */
+
+static int serve_listen(const char *path) {
+  struct sockaddr_un addr;
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+  if (fd == -1 || !serve_address(&addr, path)) {
+    fprintf(stderr, "%s: Failed to create the socket.\n", path);
+    if (fd != -1)
+      close(fd);
+    return -1;
+  }
+
+  int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  bool live = probe != -1 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+
+  if (probe != -1)
+    close(probe);
+  if (live) {
+    fprintf(stderr, "%s: A server is already listening there.\n", path);
+    close(fd);
+    return -1;
+  }
+
+  unlink(path);
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, SOMAXCONN) == -1) {
+    fprintf(stderr, "%s: Failed to listen on the socket.\n", path);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * @brief Serves queries on a Unix socket until SIGINT or SIGTERM.
+ * 
+ * The main thread runs the event loop: it accepts connections and reads
+ * them, and hands those with a complete request to the workers. A
+ * connection is with one thread at a time, so its answers go out in
+ * order. Parsed files are kept in an LRU of `capacity` entries, checked
+ * against the inode, size and mtime of their path on every request. The
+ * counters are printed on stderr on the way out.
+ * 
+ * @param path Where the socket goes.
+ * @param args The options, the ones marked served can be asked for.
+ * @param threads The number of workers, 0 means one per online CPU.
+ * @param capacity How many parsed files are kept.
+ * @return bool false if the server could not start.
+ */
+
+bool run_server(const char *path, const arg_t *args, size_t nargs, unsigned int threads, size_t capacity) {
+  server_t srv = {.args = args, .nargs = nargs, .capacity = capacity ? capacity : 1, .epoll_fd = -1, .signal_fd = -1};
+  sigset_t mask;
+  size_t buckets = 16;
+
+  while (buckets < 2 * srv.capacity)
+    buckets *= 2;
+  srv.mask = buckets - 1;
+  if (!(srv.buckets = calloc(buckets, sizeof(serve_entry_t *))))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the server!");
+
+  /* the workers inherit the mask, the signals are only read from signal_fd */
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+  struct epoll_event ev = {.events = EPOLLIN};
+
+  if ((srv.listen_fd = serve_listen(path)) == -1
+      || (srv.signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC)) == -1
+      || (srv.epoll_fd = epoll_create1(EPOLL_CLOEXEC)) == -1
+      || (ev.data.ptr = &srv.listen_fd, epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.listen_fd, &ev)) == -1
+      || (ev.data.ptr = &srv.signal_fd, epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.signal_fd, &ev)) == -1) {
+    if (srv.listen_fd != -1) {
+      fprintf(stderr, "%s: Failed to start the event loop.\n", path);
+      close(srv.listen_fd);
+      unlink(path);
+    }
+    if (srv.signal_fd != -1)
+      close(srv.signal_fd);
+    if (srv.epoll_fd != -1)
+      close(srv.epoll_fd);
+    free(srv.buckets);
+    return false;
+  }
+
+  if (!threads)
+    threads = pool_default_threads();
+
+  pthread_t *tids = calloc(threads, sizeof(pthread_t));
+  unsigned int spawned = 0;
+
+  pthread_mutex_init(&srv.files_lock, NULL);
+  pthread_mutex_init(&srv.queue_lock, NULL);
+  pthread_cond_init(&srv.queue_cond, NULL);
+  srv.started_ns = serve_now();
+
+  for (; tids && spawned < threads; ++spawned)
+    if (pthread_create(&tids[spawned], NULL, serve_worker, &srv))
+      break;
+
+  bool running = spawned != 0;
+
+  if (!running) {
+    fprintf(stderr, "Failed to start the workers!\n");
+  } else {
+    fprintf(stderr, "%s: Serving with %u workers, up to %lu files mapped.\n", path, spawned,
+            (unsigned long)srv.capacity);
+  }
+
+  struct epoll_event events[SERVE_EVENTS];
+
+  while (running) {
+    int n = epoll_wait(srv.epoll_fd, events, SERVE_EVENTS, -1);
+
+    if (n == -1 && errno != EINTR)
+      break;
+
+    for (int i = 0; running && i < n; ++i) {
+      if (events[i].data.ptr == &srv.listen_fd)
+        serve_accept(&srv);
+      else if (events[i].data.ptr == &srv.signal_fd)
+        running = false;
+      else
+        serve_readable(&srv, events[i].data.ptr);
+    }
+  }
+
+  pthread_mutex_lock(&srv.queue_lock);
+  srv.stopping = true;
+  pthread_cond_broadcast(&srv.queue_cond);
+  pthread_mutex_unlock(&srv.queue_lock);
+
+  for (unsigned int i = 0; i < spawned; ++i)
+    pthread_join(tids[i], NULL);
+  free(tids);
+
+  out_t out = {0};
+
+  if (out_init(&out, STDERR_FILENO)) {
+    serve_stats(&srv, &out);
+    out_destroy(&out);
+  }
+
+  while (srv.conns)
+    serve_close(&srv, srv.conns);
+  while (srv.head) {
+    serve_entry_t *entry = srv.head;
+
+    serve_unlink(&srv, entry);
+    serve_free_entry(entry);
+  }
+
+  close(srv.epoll_fd);
+  close(srv.signal_fd);
+  close(srv.listen_fd);
+  unlink(path);
+  pthread_cond_destroy(&srv.queue_cond);
+  pthread_mutex_destroy(&srv.queue_lock);
+  pthread_mutex_destroy(&srv.files_lock);
+  free(srv.buckets);
+  return spawned != 0;
+}
+
+/**
+ * @brief Connects to a server, -1 (with a message) if nobody is listening.
+ * 
+ */
+
+static int client_connect(const char *path) {
+  struct sockaddr_un addr;
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+  if (fd == -1 || !serve_address(&addr, path) || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+    fprintf(stderr, "%s: Failed to connect to the server.\n", path);
+    if (fd != -1)
+      close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * @brief recv(2)s exactly `len` bytes.
+ * 
+ */
+
+static bool client_recv(int fd, char *buf, size_t len) {
+  for (size_t done = 0; done < len;) {
+    ssize_t n = recv(fd, buf + done, len - done, 0);
+
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    done += n;
+  }
+  return true;
+}
+
+/**
+ * @brief Sends one request and reads its answer.
+ * 
+ * @param body Where the answer goes, malloc()ed, NUL terminated.
+ * @param ok Whether the server answered `ok` or `error`.
+ * @return bool false if the connection broke.
+ */
+
+static bool client_query(int fd, const char *request, size_t len, char **body, size_t *body_len, bool *ok) {
+  char header[32];
+  size_t hlen = 0;
+
+  if (!serve_send(fd, request, len))
+    return false;
+
+  /* the header is a couple of words, a byte at a time keeps the body out of it */
+  while (hlen < sizeof(header) - 1 && client_recv(fd, header + hlen, 1) && header[hlen] != '\n')
+    hlen++;
+  if (hlen == sizeof(header) - 1 || header[hlen] != '\n')
+    return false;
+  header[hlen] = '\0';
+
+  char *sp = strchr(header, ' ');
+
+  if (!sp)
+    return false;
+  *sp = '\0';
+  *ok = !strcmp(header, "ok");
+  *body_len = strtoul(sp + 1, NULL, 10);
+
+  if (!(*body = malloc(*body_len + 1)))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the answer!");
+  (*body)[*body_len] = '\0';
+  if (!client_recv(fd, *body, *body_len)) {
+    free(*body);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Asks a server for every file of the batch instead of parsing them here.
+ * 
+ * The output is the same as without the server: one block per file, in
+ * order, with a `File:` line when there are several.
+ * 
+ * @param path The server's socket.
+ * @param arg The option.
+ * @param batch The files, the option's argument and the output format.
+ * @return bool false if any file failed.
+ */
+
+bool run_client(const char *path, const arg_t *arg, const batch_t *batch) {
+  static const char *formats[] = {"text", "json", "ndjson"};
+  int fd = client_connect(path);
+  out_t out = {0};
+  bool all_ok = true;
+
+  if (fd == -1)
+    return false;
+  if (!out_init(&out, STDOUT_FILENO))
+    error_handling(fd, NULL, NULL, "Failed to allocate memory for the output buffer!");
+
+  bool blocks = batch->count > 1 && batch->format == OUT_TEXT;
+
+  for (size_t i = 0; i < batch->count; ++i) {
+    const char *file = batch->files[i];
+    /* the server runs elsewhere and keys its LRU on the path, it gets the canonical one */
+    char *real = realpath(file, NULL);
+
+    if (!real) {
+      fprintf(stderr, "%s: Failed to open the file.\n", file);
+      all_ok = false;
+      continue;
+    }
+
+    char request[SERVE_LINE];
+    int len = snprintf(request, sizeof(request), "-f %s %s%s%s%s%s%s %s\n", formats[batch->format],
+                       (!arg->param && batch->arg) ? "-e " : "", (!arg->param && batch->arg) ? batch->arg : "",
+                       (!arg->param && batch->arg) ? " " : "", arg->name,
+                       arg->param ? " " : "", arg->param ? batch->arg : "", real);
+    char *body = NULL;
+    size_t body_len = 0;
+    bool ok = false;
+
+    if (len < 0 || (size_t)len >= sizeof(request) || strchr(real, '\n')) {
+      fprintf(stderr, "%s: The path can't be sent to the server.\n", file);
+      free(real);
+      all_ok = false;
+      continue;
+    }
+    free(real);
+
+    if (blocks) {
+      out_str(&out, "File: ");
+      out_str(&out, file);
+      out_char(&out, '\n');
+    }
+
+    if (!client_query(fd, request, len, &body, &body_len, &ok)) {
+      out_destroy(&out);
+      close(fd);
+      fprintf(stderr, "%s: The server went away.\n", path);
+      return false;
+    }
+
+    if (ok) {
+      out_write(&out, body, body_len);
+    } else {
+      /* keep stdout and stderr in step, like a local run; the handler's own lines are printed as they are */
+      out_flush(&out);
+      if (body_len && body[body_len - 1] == '\n')
+        fputs(body, stderr);
+      else
+        fprintf(stderr, "%s: %s\n", file, body);
+    }
+    if (blocks)
+      out_char(&out, '\n');
+    all_ok &= ok;
+    free(body);
+  }
+
+  out_destroy(&out);
+  close(fd);
+  return all_ok;
+}
+
+/**
+ * @brief Prints the counters of a server: latency percentiles, throughput and the LRU.
+ * 
+ */
+
+bool client_stats(const char *path) {
+  int fd = client_connect(path);
+  char *body;
+  size_t len;
+  bool ok = false;
+
+  if (fd == -1)
+    return false;
+  if (!client_query(fd, "stats\n", 6, &body, &len, &ok)) {
+    fprintf(stderr, "%s: The server went away.\n", path);
+    close(fd);
+    return false;
+  }
+  fwrite(body, 1, len, stdout);
+  free(body);
+  close(fd);
+  return ok;
+}
@@ -0,0 +1,78 @@
+#ifndef _SERVE_H
+#define _SERVE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+
+#define SERVE_FILES 256     /* parsed files kept mapped, by default */
+#define SERVE_LINE 16384    /* the longest request */
+#define SERVE_EVENTS 64
+#define SERVE_HIST 1024     /* latency buckets, 16 per power of two of nanoseconds */
+#define SERVE_SEND_MS 10000 /* a client that reads nothing for this long is dropped */
+
+typedef struct serve_entry {
+  char *path;
+  uint64_t hash;
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  struct timespec mtime;
+  elf_t *elf;
+  unsigned int refs;                /* requests running on it */
+  bool stale;                       /* out of the table, the last request frees it */
+  struct serve_entry *chain;        /* next in the bucket */
+  struct serve_entry *prev, *next;  /* LRU order, most recent first */
+} serve_entry_t;
+
+typedef struct serve_conn {
+  int fd;
+  bool eof;
+  size_t len;
+  struct serve_conn *queued;        /* next in the work queue */
+  struct serve_conn *prev, *next;   /* every open connection */
+  char in[SERVE_LINE];
+} serve_conn_t;
+
+typedef struct server {
+  const arg_t *args;
+  size_t nargs;
+  int listen_fd;
+  int epoll_fd;
+  int signal_fd;
+  size_t capacity;
+  serve_entry_t **buckets;
+  size_t mask;
+  size_t count;
+  serve_entry_t *head, *tail;
+  pthread_mutex_t files_lock;
+  serve_conn_t *queue_head, *queue_tail;
+  serve_conn_t *conns;
+  bool stopping;
+  pthread_mutex_t queue_lock;       /* the queue, the connection list and stopping */
+  pthread_cond_t queue_cond;
+  uint64_t started_ns;
+  uint64_t queries;
+  uint64_t errors;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t reloads;
+  uint64_t evictions;
+  uint64_t hist[SERVE_HIST];
+} server_t;
+
+bool run_server(const char *path, const arg_t *args, size_t nargs, unsigned int threads, size_t capacity);
+bool run_client(const char *path, const arg_t *arg, const batch_t *batch);
+bool client_stats(const char *path);
+
+#endif
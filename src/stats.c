@@ -0,0 +1,178 @@
+/**
+ * @file stats.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Per-phase timing and resource counters for --stats.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+static const char *phase_names[STATS_PHASES] = {"open", "init", "handler", "destroy"};
+
+/* what the pool_run() workers this thread waited for used, see stats_credit() */
+static __thread stats_mark_t stats_workers;
+
+/**
+ * @brief Takes a snapshot of the clocks and fault counters of the calling thread.
+ * 
+ * Files are processed on worker threads, so everything is per thread
+ * (CLOCK_THREAD_CPUTIME_ID, RUSAGE_THREAD), plus what the threads a
+ * handler fanned out to (-T, -H, -z, archive members) used, credited when
+ * they were joined.
+ */
+
+void stats_mark(stats_mark_t *mark) {
+  struct timespec wall, cpu;
+  struct rusage usage;
+
+  clock_gettime(CLOCK_MONOTONIC, &wall);
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+  getrusage(RUSAGE_THREAD, &usage);
+
+  mark->wall_ns = (uint64_t)wall.tv_sec * 1000000000u + wall.tv_nsec;
+  mark->cpu_ns = (uint64_t)cpu.tv_sec * 1000000000u + cpu.tv_nsec + stats_workers.cpu_ns;
+  mark->minflt = usage.ru_minflt + stats_workers.minflt;
+  mark->majflt = usage.ru_majflt + stats_workers.majflt;
+}
+
+/**
+ * @brief Counts the CPU time and faults of joined threads as the calling thread's own.
+ * 
+ * @param used What they used, the wall clock is ignored.
+ */
+
+void stats_credit(const stats_mark_t *used) {
+  stats_workers.cpu_ns += used->cpu_ns;
+  stats_workers.minflt += used->minflt;
+  stats_workers.majflt += used->majflt;
+}
+
+/**
+ * @brief Adds what happened since `start` to a phase.
+ * 
+ */
+
+void stats_add(stats_t *stats, stats_phase_t phase, const stats_mark_t *start) {
+  stats_mark_t now;
+
+  stats_mark(&now);
+  stats->phase[phase].wall_ns += now.wall_ns - start->wall_ns;
+  stats->phase[phase].cpu_ns += now.cpu_ns - start->cpu_ns;
+  stats->phase[phase].minflt += now.minflt - start->minflt;
+  stats->phase[phase].majflt += now.majflt - start->majflt;
+}
+
+/**
+ * @brief Returns how much of [addr, addr + len) is resident, from /proc/self/smaps.
+ * 
+ * Every mapping that starts inside the range counts, a cache entry is
+ * mapped as several of them.
+ * 
+ * @return uint64_t Bytes, 0 if smaps can't be read.
+ */
+
+uint64_t stats_resident(const void *addr, uint64_t len) {
+  FILE *smaps = fopen("/proc/self/smaps", "r");
+  uintptr_t lo = (uintptr_t)addr, hi = lo + len, start, end;
+  unsigned long kb;
+  uint64_t total = 0;
+  bool inside = false;
+  char line[512];
+
+  if (!smaps)
+    return 0;
+
+  while (fgets(line, sizeof(line), smaps)) {
+    if (sscanf(line, "%lx-%lx ", &start, &end) == 2 && strchr(line, '-') < strchr(line, ' '))
+      inside = (start >= lo && start < hi);
+    else if (inside && sscanf(line, "Rss: %lu kB", &kb) == 1)
+      total += (uint64_t)kb * 1024;
+  }
+  fclose(smaps);
+  return total;
+}
+
+/**
+ * @brief Writes the report of one file to stderr, as a table or as one JSON line.
+ * 
+ * @param stats What was measured.
+ * @param path The file.
+ * @param format STATS_TEXT or STATS_JSON.
+ */
+
+void stats_report(const stats_t *stats, const char *path, stats_format_t format) {
+  out_t out;
+  json_t json;
+
+  if (format == STATS_OFF || !out_init(&out, STDERR_FILENO))
+    return;
+
+  if (format == STATS_JSON) {
+    json_init(&json, &out);
+    json_open(&json, NULL, '{');
+    json_str(&json, "file", path);
+    json_open(&json, "phases", '{');
+    for (int i = 0; i < STATS_PHASES; ++i) {
+      json_open(&json, phase_names[i], '{');
+      json_uint(&json, "wall_ns", stats->phase[i].wall_ns);
+      json_uint(&json, "cpu_ns", stats->phase[i].cpu_ns);
+      json_int(&json, "minflt", stats->phase[i].minflt);
+      json_int(&json, "majflt", stats->phase[i].majflt);
+      json_close(&json, '}');
+    }
+    json_close(&json, '}');
+    json_str(&json, "source", stats->cached ? "cache" : stats->read ? "pread" : "mmap");
+    json_uint(&json, "mapped_bytes", stats->mapped);
+    json_uint(&json, "touched_bytes", stats->touched);
+    json_uint(&json, "read_bytes", stats->read);
+    json_uint(&json, "rows", stats->rows);
+    json_uint(&json, "output_bytes", stats->out_bytes);
+    json_close(&json, '}');
+    out_char(&out, '\n');
+    out_destroy(&out);
+    return;
+  }
+
+  out_str(&out, "Stats for ");
+  out_str(&out, path);
+  out_str(&out, stats->cached ? " (from the cache):\n" : ":\n");
+  out_str(&out, "Phase       Wall us     CPU us      Minflt    Majflt\n");
+  for (int i = 0; i < STATS_PHASES; ++i) {
+    out_pad(&out, phase_names[i], 11, OUT_LEFT);
+    out_udec(&out, stats->phase[i].wall_ns / 1000, 11, OUT_LEFT);
+    out_char(&out, ' ');
+    out_udec(&out, stats->phase[i].cpu_ns / 1000, 11, OUT_LEFT);
+    out_char(&out, ' ');
+    out_sdec(&out, stats->phase[i].minflt, 9, OUT_LEFT);
+    out_char(&out, ' ');
+    out_sdec(&out, stats->phase[i].majflt, 0, 0);
+    out_char(&out, '\n');
+  }
+  out_str(&out, "Mapped: ");
+  out_udec(&out, stats->mapped, 0, 0);
+  out_str(&out, " bytes, touched: ");
+  out_udec(&out, stats->touched, 0, 0);
+  out_str(&out, " bytes, read: ");
+  out_udec(&out, stats->read, 0, 0);
+  out_str(&out, " bytes\nOutput: ");
+  out_udec(&out, stats->rows, 0, 0);
+  out_str(&out, " lines, ");
+  out_udec(&out, stats->out_bytes, 0, 0);
+  out_str(&out, " bytes\n\n");
+  out_destroy(&out);
+}
@@ -0,0 +1,46 @@
+#ifndef _STATS_H
+#define _STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/resource.h>
+
+typedef enum stats_phase {
+  STATS_OPEN,     /* open(2) + fstat(2) */
+  STATS_INIT,     /* init_elf() or the cache lookup */
+  STATS_HANDLER,  /* the handler from args[] */
+  STATS_DESTROY,  /* destroy_parser() */
+  STATS_PHASES
+} stats_phase_t;
+
+typedef enum stats_format {
+  STATS_OFF,
+  STATS_TEXT,
+  STATS_JSON
+} stats_format_t;
+
+typedef struct stats_mark {
+  uint64_t wall_ns;
+  uint64_t cpu_ns;
+  long minflt;
+  long majflt;
+} stats_mark_t;
+
+typedef struct stats {
+  stats_mark_t phase[STATS_PHASES]; /* what each phase cost */
+  uint64_t mapped;       /* bytes mapped (file or cache entry) */
+  uint64_t touched;      /* bytes of the mapping resident after the handler */
+  uint64_t read;         /* bytes read with the pread backend */
+  uint64_t rows;         /* lines of output */
+  uint64_t out_bytes;
+  bool cached;           /* served from the cache */
+} stats_t;
+
+void stats_mark(stats_mark_t *mark);
+void stats_credit(const stats_mark_t *used);
+void stats_add(stats_t *stats, stats_phase_t phase, const stats_mark_t *start);
+uint64_t stats_resident(const void *addr, uint64_t len);
+void stats_report(const stats_t *stats, const char *path, stats_format_t format);
+
+#endif
@@ -0,0 +1,359 @@
+/**
+ * @file zsec.c
+ * @author 0xff (0xff@0xff.0xff)
+ * @brief Streaming decompression of SHF_COMPRESSED sections.
+ * @version 0.1
+ * @date 2026-10-17
+ * 
+ * @copyright Copyright (c) 2022 0xff
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "all.h"
+
+typedef struct zsec_stat {
+  unsigned int index;
+  uint32_t type;
+  uint64_t size;
+  uint64_t produced;
+  uLong crc;
+  bool ok;
+} zsec_stat_t;
+
+typedef struct zsec_job {
+  elf_t *elf;
+  zsec_stat_t *stats;
+} zsec_job_t;
+
+/**
+ * @brief Makes the next stretch of compressed bytes available.
+ * 
+ * Mapped files are handed over in one go, with the pread backend the
+ * input goes through a ZSEC_CHUNK window so memory use doesn't depend
+ * on the section size.
+ * 
+ * @return size_t The number of bytes available at *data, 0 at the end or on error.
+ */
+
+static size_t zsec_input(zsec_t *zs, const char **data) {
+  uint64_t len = zs->end - zs->offset;
+
+  if (!len)
+    return 0;
+
+  if (!zs->elf->io) {
+    /* zlib counts its input in uInt */
+    len = (len > UINT32_MAX) ? UINT32_MAX : len;
+    *data = zs->elf->file + zs->offset;
+  } else {
+    len = (len > ZSEC_CHUNK) ? ZSEC_CHUNK : len;
+    if (!elf_pread(zs->elf, zs->in, len, zs->offset))
+      return 0;
+    *data = zs->in;
+  }
+  zs->offset += len;
+  return len;
+}
+
+/**
+ * @brief Starts reading a section, compressed or not.
+ * 
+ * Only the compression header is read here. The struct doesn't touch the shared
+ * elf_read() pool, so independent sections can be read from different
+ * threads at the same time.
+ * 
+ * @param elf A pointer to the struct.
+ * @param index The section index.
+ * @param zs The stream to set up.
+ * @return bool false for SHT_NOBITS, broken headers and unsupported algorithms.
+ */
+
+bool zsec_open(elf_t *elf, unsigned int index, zsec_t *zs) {
+  memset(zs, 0, sizeof(zsec_t));
+
+  if (index >= elf->elf_header->e_shnum)
+    return false;
+
+  const Elf64_Shdr *shdr = &elf->elf_section_header[index];
+
+  if (shdr->sh_type == SHT_NOBITS || shdr->sh_offset > elf->size
+      || shdr->sh_size > elf->size - shdr->sh_offset)
+    return false;
+
+  zs->elf = elf;
+  zs->offset = shdr->sh_offset;
+  zs->end = shdr->sh_offset + shdr->sh_size;
+  zs->size = shdr->sh_size;
+
+  if (shdr->sh_flags & SHF_COMPRESSED) {
+    Elf64_Chdr chdr;
+    uint64_t chdr_size;
+
+    if (!elf_chdr(elf, index, &chdr, &chdr_size))
+      return false;
+    zs->type = chdr.ch_type;
+    zs->size = chdr.ch_size;
+    zs->offset += chdr_size;
+  }
+
+  if (zs->type && elf->io && !(zs->in = malloc(ZSEC_CHUNK)))
+    return false;
+
+  switch (zs->type) {
+    case 0:
+      return true;
+    case ELFCOMPRESS_ZLIB:
+      if (inflateInit(&zs->z) == Z_OK)
+        return true;
+      break;
+#ifdef HAVE_ZSTD
+    case ELFCOMPRESS_ZSTD:
+      if ((zs->zstd = ZSTD_createDStream()) && !ZSTD_isError(ZSTD_initDStream(zs->zstd)))
+        return true;
+      break;
+#endif
+    default:
+      break;
+  }
+  zs->type = 0;
+  zsec_close(zs);
+  return false;
+}
+
+/**
+ * @brief Decompresses the next bytes of the section into the caller's buffer.
+ * 
+ * @param zs The stream.
+ * @param buf Where the bytes go.
+ * @param len How many bytes fit.
+ * @return long The number of bytes written, 0 at the end, -1 if the data is corrupt.
+ */
+
+long zsec_read(zsec_t *zs, char *buf, size_t len) {
+  const char *data;
+  size_t avail;
+
+  if (zs->done || !len)
+    return 0;
+
+  if (!zs->type) {
+    uint64_t left = zs->end - zs->offset;
+
+    len = (len > left) ? left : len;
+    if (!elf_pread(zs->elf, buf, len, zs->offset))
+      return -1;
+    zs->offset += len;
+    zs->produced += len;
+    zs->done = (zs->offset == zs->end);
+    return (long)len;
+  }
+
+  if (zs->type == ELFCOMPRESS_ZLIB) {
+    len = (len > UINT32_MAX) ? UINT32_MAX : len;
+    zs->z.next_out = (Bytef *)buf;
+    zs->z.avail_out = len;
+
+    while (zs->z.avail_out) {
+      if (!zs->z.avail_in && (avail = zsec_input(zs, &data))) {
+        zs->z.next_in = (Bytef *)data;
+        zs->z.avail_in = avail;
+      }
+
+      int ret = inflate(&zs->z, Z_NO_FLUSH);
+
+      if (ret == Z_STREAM_END) {
+        zs->done = true;
+        break;
+      }
+      /* Z_BUF_ERROR: out of input before the end of the stream */
+      if (ret != Z_OK)
+        return -1;
+    }
+    len -= zs->z.avail_out;
+  }
+
+#ifdef HAVE_ZSTD
+  if (zs->type == ELFCOMPRESS_ZSTD) {
+    ZSTD_outBuffer zout = {buf, len, 0};
+
+    while (zout.pos < zout.size) {
+      if (zs->zin.pos == zs->zin.size) {
+        if (!(avail = zsec_input(zs, &data))) {
+          /* out of input, fine only if the last frame was complete */
+          if (zs->pending)
+            return -1;
+          zs->done = true;
+          break;
+        }
+        zs->zin = (ZSTD_inBuffer){data, avail, 0};
+      }
+
+      zs->pending = ZSTD_decompressStream(zs->zstd, &zout, &zs->zin);
+
+      if (ZSTD_isError(zs->pending))
+        return -1;
+    }
+    len = zout.pos;
+  }
+#endif
+
+  zs->produced += len;
+  return (long)len;
+}
+
+/**
+ * @brief Releases the decompressor.
+ * 
+ */
+
+void zsec_close(zsec_t *zs) {
+  if (zs->type == ELFCOMPRESS_ZLIB)
+    inflateEnd(&zs->z);
+#ifdef HAVE_ZSTD
+  if (zs->zstd)
+    ZSTD_freeDStream(zs->zstd);
+#endif
+  free(zs->in);
+  memset(zs, 0, sizeof(zsec_t));
+}
+
+/**
+ * @brief Returns the name of a compression algorithm.
+ * 
+ */
+
+static const char *zsec_type(uint32_t type) {
+  switch (type) {
+    case ELFCOMPRESS_ZLIB:  return ("ZLIB"); break;
+    case ELFCOMPRESS_ZSTD:  return ("ZSTD"); break;
+    default:                return ("UNKNOWN"); break;
+  }
+}
+
+/**
+ * @brief Decompresses one section, keeping only its size and CRC32.
+ * 
+ */
+
+static void zsec_job(size_t index, void *ctx) {
+  zsec_job_t *job = ctx;
+  zsec_stat_t *stat = &job->stats[index];
+  char *buf = malloc(ZSEC_CHUNK);
+  zsec_t zs;
+  long n = 0;
+
+  stat->crc = crc32(0, Z_NULL, 0);
+
+  if (buf && zsec_open(job->elf, stat->index, &zs)) {
+    stat->type = zs.type;
+    stat->size = zs.size;
+    while ((n = zsec_read(&zs, buf, ZSEC_CHUNK)) > 0)
+      stat->crc = crc32(stat->crc, (const Bytef *)buf, n);
+    stat->produced = zs.produced;
+    stat->ok = !n && zs.produced == zs.size;
+    zsec_close(&zs);
+  }
+  free(buf);
+}
+
+/**
+ * @brief Decompresses every SHF_COMPRESSED section and lists them.
+ * 
+ * Sections are independent, so they are inflated in parallel, one job per
+ * section, each through a ZSEC_CHUNK buffer; nothing is ever held at its
+ * full uncompressed size.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void dump_compressed_sections(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  zsec_job_t job = {.elf = elf};
+  size_t count = 0;
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i)
+    count += !!(elf->elf_section_header[i].sh_flags & SHF_COMPRESSED);
+
+  if (!count) {
+    out_str(out, "There are no compressed sections in this file.\n");
+    return;
+  }
+
+  if (!(job.stats = calloc(count, sizeof(zsec_stat_t))))
+    error_handling(-1, NULL, NULL, "Failed to allocate memory for the struct!");
+
+  for (int i = 0, j = 0; i < elf->elf_header->e_shnum; ++i) {
+    if (elf->elf_section_header[i].sh_flags & SHF_COMPRESSED)
+      job.stats[j++].index = i;
+  }
+
+  pool_run(count, 0, zsec_job, &job);
+
+  out_str(out, "[Nr] Name                Type    Compressed  Size        CRC32     Status\n");
+
+  for (size_t i = 0; i < count; ++i) {
+    const zsec_stat_t *stat = &job.stats[i];
+    const Elf64_Shdr *shdr = &elf->elf_section_header[stat->index];
+
+    out_char(out, ' ');
+    out_udec(out, stat->index, 3, OUT_LEFT);
+    out_char(out, ' ');
+    out_pad(out, elf_section_name(elf, shdr), 19, OUT_LEFT);
+    out_char(out, ' ');
+    out_pad(out, zsec_type(stat->type), 7, OUT_LEFT);
+    out_write(out, " 0x", 3);
+    out_hex(out, shdr->sh_size, 8, 9, OUT_LEFT);
+    out_write(out, " 0x", 3);
+    out_hex(out, stat->produced, 8, 9, OUT_LEFT);
+    out_write(out, " ", 1);
+    out_hex(out, stat->crc, 8, 9, OUT_LEFT);
+    out_char(out, ' ');
+    out_str(out, stat->ok ? "ok" : (stat->type == ELFCOMPRESS_ZLIB
+                                    || stat->type == ELFCOMPRESS_ZSTD) ? "corrupt" : "unsupported");
+    out_char(out, '\n');
+  }
+  free(job.stats);
+}
+
+/**
+ * @brief Writes the contents of the section named file->arg, decompressed.
+ * 
+ * @param file The file, and where its output goes.
+ */
+
+void extract_section(batch_file_t *file) {
+  elf_t *elf = file->elf;
+  out_t *out = file->out;
+  zsec_t zs;
+  char buf[ZSEC_CHUNK];
+  long n = 0;
+
+  for (int i = 0; i < elf->elf_header->e_shnum; ++i) {
+    if (strcmp(elf_section_name(elf, &elf->elf_section_header[i]), file->arg))
+      continue;
+
+    if (!zsec_open(elf, i, &zs)) {
+      fprintf(file->err, "%s: The section has no contents or uses an unsupported compression.\n", file->arg);
+      return;
+    }
+    while ((n = zsec_read(&zs, buf, sizeof(buf))) > 0)
+      out_write(out, buf, n);
+    if (n < 0)
+      fprintf(file->err, "%s: The compressed data is corrupt.\n", file->arg);
+    zsec_close(&zs);
+    return;
+  }
+  fprintf(file->err, "%s: No such section.\n", file->arg);
+}
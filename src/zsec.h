@@ -0,0 +1,40 @@
+#ifndef _ZSEC_H
+#define _ZSEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifndef ELFCOMPRESS_ZSTD
+#define ELFCOMPRESS_ZSTD 2
+#endif
+
+#define ZSEC_CHUNK (1 << 16)
+
+typedef struct zsec {
+  elf_t *elf;
+  uint32_t type;       /* ELFCOMPRESS_*, 0 for a section stored as is */
+  uint64_t size;       /* uncompressed size */
+  uint64_t offset;     /* next input byte in the file */
+  uint64_t end;
+  uint64_t produced;
+  char *in;            /* input window, only with the pread backend */
+  bool done;
+  z_stream z;
+#ifdef HAVE_ZSTD
+  ZSTD_DStream *zstd;
+  ZSTD_inBuffer zin;
+  size_t pending;      /* last ZSTD_decompressStream() hint, 0 between frames */
+#endif
+} zsec_t;
+
+bool zsec_open(elf_t *elf, unsigned int index, zsec_t *zs);
+long zsec_read(zsec_t *zs, char *buf, size_t len);
+void zsec_close(zsec_t *zs);
+void dump_compressed_sections(batch_file_t *file);
+void extract_section(batch_file_t *file);
+
+#endif